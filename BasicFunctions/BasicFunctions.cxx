@@ -145,105 +145,42 @@ double rad::GetGyroradius(TVector3 velocity, TVector3 bField,
   return rg;
 }
 
+// Fills a graph with the single sided spectrum of an evenly sampled waveform
+static void FillSpectrumGraph(const TGraph &grWave, rad::SpectrumNorm norm,
+                              TGraph &grOut) {
+  const size_t length = grWave.GetN();
+  const double deltaT = grWave.GetX()[1] - grWave.GetX()[0];
+  rad::SpectrumCalculator spec(length);
+  const size_t nFreqs = spec.GetNFrequencies();
+  grOut.Set(int(nFreqs));
+  spec.GetFrequencies(deltaT, {grOut.GetX(), nFreqs});
+  spec.Compute({grWave.GetY(), length}, deltaT, norm, {grOut.GetY(), nFreqs});
+}
+
 // Very similar to the FFTtools implementation but without the scaling of the x
 // axis the MHz
 TGraph *rad::MakePowerSpectrumNorm(const TGraph *grWave) {
-  double *oldY = grWave->GetY();
-  double *oldX = grWave->GetX();
-  double deltaT = oldX[1] - oldX[0];
-  int length = grWave->GetN();
-  FFTWComplex *theFFT = doFFT(length, oldY);
-
-  int newLength = (length / 2) + 1;
-  double *newY = new double[newLength];
-  double *newX = new double[newLength];
-
-  double deltaF = 1 / (deltaT * length);
-
-  double tempF = 0;
-  for (int i = 0; i < newLength; i++) {
-    float power = pow(getAbs(theFFT[i]), 2);
-    if (i > 0 && i < newLength - 1) power *= 2;  // account for symmetry
-    power *= deltaT / (length);  // For time-integral squared amplitude
-    power /= deltaF;             // Just to normalise bin-widths
-    // Ends up the same as dt^2, need to integrate the power (multiply by df)
-    // to get a meaningful number out.
-    newX[i] = tempF;
-    newY[i] = power;
-    tempF += deltaF;
-  }
-
-  TGraph *grPower = new TGraph(newLength, newX, newY);
+  // Time-integral squared amplitude per unit frequency. Need to integrate the
+  // power (multiply by df) to get a meaningful number out.
+  TGraph *grPower = new TGraph();
+  FillSpectrumGraph(*grWave, SpectrumNorm::kEnergySpectralDensity, *grPower);
   setGraphAttr(grPower);
-  delete[] theFFT;
-  delete[] newY;
-  delete[] newX;
   return grPower;
 }
 
 TGraph *rad::MakePowerSpectrumPeriodogram(const TGraph *grWave) {
-  double *oldY = grWave->GetY();
-  double *oldX = grWave->GetX();
-  double deltaT = oldX[1] - oldX[0];
-  int length = grWave->GetN();
-  FFTWComplex *theFFT = doFFT(length, oldY);
-  double lengthDub = (double)length;
-  int newLength = (length / 2) + 1;
-  double *newY = new double[newLength];
-  double *newX = new double[newLength];
-
-  double deltaF = 1 / (deltaT * length);
-
-  double tempF = 0;
-  for (int i = 0; i < newLength; i++) {
-    float power = pow(getAbs(theFFT[i]), 2);
-    if (i > 0 && i < newLength - 1) power *= 2;  // account for symmetry
-    double scale = lengthDub * lengthDub;
-    power /= scale;
-    newX[i] = tempF;
-    newY[i] = power;
-    tempF += deltaF;
-  }
-
-  TGraph *grPower = new TGraph(newLength, newX, newY);
+  TGraph *grPower = new TGraph();
+  FillSpectrumGraph(*grWave, SpectrumNorm::kPeriodogram, *grPower);
   setGraphAttr(grPower);
   grPower->GetXaxis()->SetTitle("Frequency [Hz]");
-  delete[] theFFT;
-  delete[] newY;
-  delete[] newX;
   return grPower;
 }
 
 TGraph rad::MakePowerSpectrumPeriodogram(const TGraph &grWave) {
-  double *oldY = grWave.GetY();
-  double *oldX = grWave.GetX();
-  double deltaT = oldX[1] - oldX[0];
-  int length = grWave.GetN();
-  FFTWComplex *theFFT = doFFT(length, oldY);
-  double lengthDub = (double)length;
-  int newLength = (length / 2) + 1;
-  double *newY = new double[newLength];
-  double *newX = new double[newLength];
-
-  double deltaF = 1 / (deltaT * length);
-
-  double tempF = 0;
-  for (int i = 0; i < newLength; i++) {
-    float power = pow(getAbs(theFFT[i]), 2);
-    if (i > 0 && i < newLength - 1) power *= 2;  // account for symmetry
-    double scale = lengthDub * lengthDub;
-    power /= scale;
-    newX[i] = tempF;
-    newY[i] = power;
-    tempF += deltaF;
-  }
-
-  TGraph grPower(newLength, newX, newY);
+  TGraph grPower;
+  FillSpectrumGraph(grWave, SpectrumNorm::kPeriodogram, grPower);
   SetGraphAttr(grPower);
   grPower.GetXaxis()->SetTitle("Frequency [Hz]");
-  delete[] theFFT;
-  delete[] newY;
-  delete[] newX;
   return grPower;
 }
 
@@ -334,9 +271,14 @@ double rad::CubicInterpolation(std::vector<double> xVals,
     std::cout << "Invalid interpolation input size! Require 4 values.\n";
     return 0;
   }
+  return CubicInterpolation(xVals.data(), yVals.data(), xInterp);
+}
+
+double rad::CubicInterpolation(const double xVals[4], const double yVals[4],
+                               double xInterp) {
   // Check that we have monotonically increasing x values
-  for (unsigned int i{1}; i < xVals.size(); i++) {
-    if (xVals.at(i) - xVals.at(i - 1) <= 0) {
+  for (unsigned int i{1}; i < 4; i++) {
+    if (xVals[i] - xVals[i - 1] <= 0) {
       std::cout
           << "x values (for interpolation) do not increase monotonically!\n";
       return 0;
@@ -575,32 +517,9 @@ TGraph *rad::SignalProcessGraph(TGraph *grInput, const double downmixFreq,
 }
 
 TGraph *rad::MakeFFTMagGraph(TGraph *grInput) {
-  double *oldY = grInput->GetY();
-  double *oldX = grInput->GetX();
-  double deltaT = oldX[1] - oldX[0];
-  int length = grInput->GetN();
-  FFTWComplex *theFFT = doFFT(length, oldY);
-  double lengthDub = (double)length;
-  int newLength = (length / 2) + 1;
-  double *newY = new double[newLength];
-  double *newX = new double[newLength];
-
-  double deltaF = 1 / (deltaT * length);
-
-  double tempF = 0;
-  for (int i = 0; i < newLength; i++) {
-    float mag = getAbs(theFFT[i]);
-    newX[i] = tempF;
-    newY[i] = mag;
-    tempF += deltaF;
-  }
-
-  TGraph *grMag = new TGraph(newLength, newX, newY);
+  TGraph *grMag = new TGraph();
+  FillSpectrumGraph(*grInput, SpectrumNorm::kMagnitude, *grMag);
   setGraphAttr(grMag);
-
-  delete[] theFFT;
-  delete[] newY;
-  delete[] newX;
   return grMag;
 }
 
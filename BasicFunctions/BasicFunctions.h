@@ -7,6 +7,7 @@
 #include "BasicFunctions/Constants.h"
 #include "BasicFunctions/FFTWComplex.h"
 #include "BasicFunctions/FourierTransforms.h"
+#include "BasicFunctions/SpectrumCalculator.h"
 #include "Math/Point3D.h"
 #include "Math/Vector3D.h"
 #include "TGraph.h"
@@ -111,6 +112,14 @@ std::vector<double> BandPassFilter(std::vector<double> xVals,
 double CubicInterpolation(std::vector<double> xVals, std::vector<double> yVals,
                           double xInterp);
 
+/// Allocation free version of the above, for use in per-sample loops
+/// \param xVals Array of 4 increasing x values
+/// \param yVals Array of the corresponding y values
+/// \param xInterp The x value at which to interpolate
+/// \return The interpolated y value
+double CubicInterpolation(const double xVals[4], const double yVals[4],
+                          double xInterp);
+
 /// @brief PDF of the Rayleigh distribution
 /// @param x
 /// @param sigma Scale parameter of the distribution
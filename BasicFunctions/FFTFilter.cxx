@@ -0,0 +1,109 @@
+/*
+  FFTFilter.cxx
+*/
+
+#include "BasicFunctions/FFTFilter.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "BasicFunctions/FFTPlanCache.h"
+
+rad::FFTFilter::FFTFilter(std::vector<double> taps, unsigned int ratio,
+                          unsigned int blockSize)
+    : m(ratio), nTaps(taps.size()), blockSize(blockSize) {
+  if (ratio == 0 || taps.empty() || blockSize == 0) {
+    std::cout << "Invalid FFT filter parameters. Exiting.\n";
+    exit(1);
+  }
+
+  fftSize = 1;
+  while (fftSize < blockSize + nTaps - 1) fftSize <<= 1;
+  nFreqs = fftSize / 2 + 1;
+
+  timeBuf = (double *)fftw_malloc(sizeof(double) * fftSize);
+  freqBuf = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * nFreqs);
+  // The plans are reused for every block, so it is worth measuring them.
+  // They are shared with any other filter of the same FFT length.
+  forwardPlan = FFTPlanCache::GetR2CPlan(int(fftSize), timeBuf, freqBuf,
+                                         FFTW_MEASURE);
+  inversePlan = FFTPlanCache::GetC2RPlan(int(fftSize), freqBuf, timeBuf,
+                                         FFTW_MEASURE);
+
+  // Frequency response of the zero padded filter
+  std::fill(timeBuf, timeBuf + fftSize, 0.0);
+  std::copy(taps.begin(), taps.end(), timeBuf);
+  fftw_execute_dft_r2c(forwardPlan, timeBuf, freqBuf);
+  response.resize(nFreqs);
+  for (size_t k{0}; k < nFreqs; k++) {
+    response[k] = std::complex<double>(freqBuf[k][0], freqBuf[k][1]) /
+                  double(fftSize);
+  }
+
+  inputBuf.resize(nTaps - 1 + blockSize);
+  output.reserve(blockSize / m + 1);
+  Reset();
+}
+
+rad::FFTFilter::~FFTFilter() {
+  fftw_free(timeBuf);
+  fftw_free(freqBuf);
+}
+
+void rad::FFTFilter::Reset() {
+  std::fill(inputBuf.begin(), inputBuf.end(), 0.0);
+  nFill = 0;
+  nIn = 0;
+  output.clear();
+}
+
+bool rad::FFTFilter::Push(double x) {
+  output.clear();
+  AddSample(x);
+  return !output.empty();
+}
+
+bool rad::FFTFilter::Flush() {
+  output.clear();
+  // Run the zeros through so the last inputs reach the centre of the filter
+  for (unsigned int i{0}; i < GetDelay(); i++) AddSample(0);
+  if (nFill > 0) ProcessBlock(nFill);
+  return !output.empty();
+}
+
+void rad::FFTFilter::AddSample(double x) {
+  inputBuf[nTaps - 1 + nFill] = x;
+  nFill++;
+  nIn++;
+  if (nFill == blockSize) ProcessBlock(nFill);
+}
+
+void rad::FFTFilter::ProcessBlock(size_t nValid) {
+  const size_t nUsed{nTaps - 1 + nValid};
+  std::copy(inputBuf.begin(), inputBuf.begin() + nUsed, timeBuf);
+  std::fill(timeBuf + nUsed, timeBuf + fftSize, 0.0);
+
+  fftw_execute_dft_r2c(forwardPlan, timeBuf, freqBuf);
+  for (size_t k{0}; k < nFreqs; k++) {
+    const std::complex<double> y{
+        std::complex<double>(freqBuf[k][0], freqBuf[k][1]) * response[k]};
+    freqBuf[k][0] = y.real();
+    freqBuf[k][1] = y.imag();
+  }
+  fftw_execute_dft_c2r(inversePlan, freqBuf, timeBuf);
+
+  // The first nTaps - 1 results are wrapped around and are discarded. The
+  // rest are the full convolution for each new input sample.
+  const unsigned long firstIndex{nIn - nFill};
+  const unsigned int delay{GetDelay()};
+  for (size_t j{0}; j < nValid; j++) {
+    const unsigned long n{firstIndex + j};
+    if (n < delay || (n - delay) % m != 0) continue;
+    output.push_back(timeBuf[nTaps - 1 + j]);
+  }
+
+  // Keep the most recent inputs for the start of the next block
+  std::copy(inputBuf.begin() + nValid, inputBuf.begin() + nUsed,
+            inputBuf.begin());
+  nFill = 0;
+}
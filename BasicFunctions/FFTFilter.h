@@ -0,0 +1,97 @@
+/*
+  FFTFilter.h
+
+  Streaming FIR filter using overlap-save FFT convolution
+  Input samples are collected into blocks, and each block is filtered with
+  one forward and one inverse FFT using buffers made once at construction
+  and cached plans. The last nTaps - 1 inputs of each block are carried over
+  to the next, so the output is identical to direct convolution with no
+  discontinuities at the block edges. The output can optionally be
+  downsampled, with the kept samples aligned to the filter delay.
+*/
+
+#ifndef FFT_FILTER_H
+#define FFT_FILTER_H
+
+#include <fftw3.h>
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace rad {
+class FFTFilter {
+ public:
+  /// @brief Parametrised constructor
+  /// @param taps Filter coefficients. Assumed to be linear phase when
+  /// aligning the output
+  /// @param ratio Decimation ratio, 1 for no downsampling
+  /// @param blockSize Number of new input samples filtered with each FFT. The
+  /// FFT length is the next power of two above blockSize + nTaps - 1
+  FFTFilter(std::vector<double> taps, unsigned int ratio = 1,
+            unsigned int blockSize = 8192);
+
+  /// Destructor, frees the FFTW buffers
+  ~FFTFilter();
+
+  FFTFilter(const FFTFilter &) = delete;
+  FFTFilter &operator=(const FFTFilter &) = delete;
+
+  /// @brief Adds an input sample
+  /// @param x Input sample
+  /// @return True if a block was filtered and new output is available
+  bool Push(double x);
+
+  /// @brief Filters the remaining input, padding the end with zeros, so that
+  /// every input sample has passed through the filter
+  /// @return True if new output is available
+  bool Flush();
+
+  /// @brief Output produced by the last call to Push or Flush. Output k
+  /// corresponds to input sample k * ratio.
+  const std::vector<double> &GetOutput() const { return output; }
+
+  /// @brief Clears the stored input and output samples
+  void Reset();
+
+  /// @brief Getter function for decimation ratio
+  unsigned int GetRatio() const { return m; }
+
+  /// @brief Getter function for FFT length
+  size_t GetFFTSize() const { return fftSize; }
+
+  /// @brief Delay of the filter in input samples
+  unsigned int GetDelay() const { return (nTaps - 1) / 2; }
+
+ private:
+  unsigned int m;      // Decimation ratio
+  size_t nTaps;        // Filter length
+  size_t blockSize;    // New input samples per FFT
+  size_t fftSize;      // FFT length
+  size_t nFreqs;       // Number of frequency bins, fftSize / 2 + 1
+
+  // Filter frequency response, including the inverse FFT normalisation
+  std::vector<std::complex<double>> response;
+
+  // nTaps - 1 samples carried over from the last block followed by the new
+  // input samples
+  std::vector<double> inputBuf;
+  size_t nFill{0};           // Number of new input samples in the block
+  unsigned long nIn{0};      // Number of input samples so far
+  std::vector<double> output;
+
+  double *timeBuf = 0;
+  fftw_complex *freqBuf = 0;
+  fftw_plan forwardPlan = 0;  // Owned by FFTPlanCache
+  fftw_plan inversePlan = 0;
+
+  /// @brief Adds an input sample without clearing the output
+  void AddSample(double x);
+
+  /// @brief Filters the current block
+  /// @param nValid Number of new input samples in the block
+  void ProcessBlock(size_t nValid);
+};
+}  // namespace rad
+
+#endif
@@ -0,0 +1,127 @@
+/*
+  FFTPlanCache.cxx
+*/
+
+#include "BasicFunctions/FFTPlanCache.h"
+
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace {
+enum Direction { kR2C, kC2R };
+
+// Transform size, number of transforms, direction, whether the arrays are
+// SIMD aligned and the planner flags
+using PlanKey = std::tuple<int, int, int, bool, unsigned int>;
+
+struct PlanStore {
+  std::mutex mutex;
+  std::map<PlanKey, fftw_plan> plans;
+  unsigned int defaultFlags{FFTW_ESTIMATE};
+
+  ~PlanStore() {
+    for (auto &entry : plans) fftw_destroy_plan(entry.second);
+  }
+};
+
+PlanStore &GetStore() {
+  static PlanStore store;
+  return store;
+}
+
+bool IsAligned(const void *p) {
+  return fftw_alignment_of((double *)(p)) == 0;
+}
+
+fftw_plan GetPlan(Direction dir, int n, int howMany, bool aligned,
+                  unsigned int flags) {
+  if (n <= 0 || howMany <= 0) {
+    std::cout << "Invalid FFT length " << n << " or number of transforms "
+              << howMany << ". Exiting.\n";
+    exit(1);
+  }
+
+  PlanStore &store{GetStore()};
+  const PlanKey key{n, howMany, dir, aligned, flags};
+  std::lock_guard<std::mutex> lock(store.mutex);
+  auto it = store.plans.find(key);
+  if (it != store.plans.end()) return it->second;
+
+  // Measuring overwrites the arrays, so plan on scratch buffers. Plans for
+  // unaligned arrays must not use SIMD loads.
+  const int nFreqs{n / 2 + 1};
+  double *real{(double *)fftw_malloc(sizeof(double) * n * howMany)};
+  fftw_complex *complex{(fftw_complex *)fftw_malloc(sizeof(fftw_complex) *
+                                                    nFreqs * howMany)};
+  const unsigned int planFlags{aligned ? flags : flags | FFTW_UNALIGNED};
+  fftw_plan p{0};
+  if (howMany > 1) {
+    p = fftw_plan_many_dft_r2c(1, &n, howMany, real, 0, 1, n, complex, 0, 1,
+                               nFreqs, planFlags);
+  } else if (dir == kR2C) {
+    p = fftw_plan_dft_r2c_1d(n, real, complex, planFlags);
+  } else {
+    p = fftw_plan_dft_c2r_1d(n, complex, real, planFlags);
+  }
+  fftw_free(real);
+  fftw_free(complex);
+  if (!p) {
+    std::cout << "Unable to make FFTW plan of length " << n << ". Exiting.\n";
+    exit(1);
+  }
+
+  store.plans.emplace(key, p);
+  return p;
+}
+}  // namespace
+
+fftw_plan rad::FFTPlanCache::GetR2CPlan(int n, const double *in,
+                                        const fftw_complex *out,
+                                        unsigned int flags) {
+  return GetPlan(kR2C, n, 1, IsAligned(in) && IsAligned(out), flags);
+}
+
+fftw_plan rad::FFTPlanCache::GetR2CManyPlan(int n, int howMany,
+                                            const double *in,
+                                            const fftw_complex *out,
+                                            unsigned int flags) {
+  return GetPlan(kR2C, n, howMany, IsAligned(in) && IsAligned(out), flags);
+}
+
+fftw_plan rad::FFTPlanCache::GetC2RPlan(int n, const fftw_complex *in,
+                                        const double *out,
+                                        unsigned int flags) {
+  return GetPlan(kC2R, n, 1, IsAligned(in) && IsAligned(out), flags);
+}
+
+void rad::FFTPlanCache::SetPlannerFlags(unsigned int flags) {
+  PlanStore &store{GetStore()};
+  std::lock_guard<std::mutex> lock(store.mutex);
+  store.defaultFlags = flags;
+}
+
+unsigned int rad::FFTPlanCache::GetPlannerFlags() {
+  PlanStore &store{GetStore()};
+  std::lock_guard<std::mutex> lock(store.mutex);
+  return store.defaultFlags;
+}
+
+bool rad::FFTPlanCache::ImportWisdom(const std::string &filePath) {
+  PlanStore &store{GetStore()};
+  std::lock_guard<std::mutex> lock(store.mutex);
+  return fftw_import_wisdom_from_filename(filePath.c_str()) != 0;
+}
+
+bool rad::FFTPlanCache::ExportWisdom(const std::string &filePath) {
+  PlanStore &store{GetStore()};
+  std::lock_guard<std::mutex> lock(store.mutex);
+  return fftw_export_wisdom_to_filename(filePath.c_str()) != 0;
+}
+
+size_t rad::FFTPlanCache::GetNPlans() {
+  PlanStore &store{GetStore()};
+  std::lock_guard<std::mutex> lock(store.mutex);
+  return store.plans.size();
+}
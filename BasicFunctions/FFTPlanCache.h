@@ -0,0 +1,102 @@
+/*
+  FFTPlanCache.h
+
+  Process wide cache of FFTW plans for one dimensional real transforms
+  Plans are made the first time a transform size is asked for and then kept
+  until the program exits, so repeated transforms of the same size only pay
+  for planning once. Plans are executed on the caller's arrays through
+  FFTW's new-array interface, which is safe to call from several threads at
+  once. The FFTW planner itself is not thread safe, so planning and wisdom
+  handling are serialised by a mutex.
+*/
+
+#ifndef FFT_PLAN_CACHE_H
+#define FFT_PLAN_CACHE_H
+
+#include <fftw3.h>
+
+#include <cstddef>
+#include <string>
+
+namespace rad {
+class FFTPlanCache {
+ public:
+  /// @brief Plan for a real to complex transform. Does not modify in or out
+  /// @param n Number of real samples
+  /// @param in Example input array of n samples
+  /// @param out Example output array of n / 2 + 1 frequencies
+  /// @param flags FFTW planner rigour, e.g. FFTW_ESTIMATE or FFTW_MEASURE
+  /// @return Plan to use with fftw_execute_dft_r2c. Owned by the cache.
+  /// Arrays used with it must have the same alignment as in and out.
+  static fftw_plan GetR2CPlan(int n, const double *in, const fftw_complex *out,
+                              unsigned int flags);
+
+  /// @brief Plan for a real to complex transform with the default rigour
+  static fftw_plan GetR2CPlan(int n, const double *in,
+                              const fftw_complex *out) {
+    return GetR2CPlan(n, in, out, GetPlannerFlags());
+  }
+
+  /// @brief Plan for a batch of real to complex transforms of consecutive
+  /// blocks. Does not modify in or out
+  /// @param n Number of real samples in each block
+  /// @param howMany Number of blocks
+  /// @param in Example input array of howMany * n samples
+  /// @param out Example output array of howMany * (n / 2 + 1) frequencies
+  /// @param flags FFTW planner rigour, e.g. FFTW_ESTIMATE or FFTW_MEASURE
+  /// @return Plan to use with fftw_execute_dft_r2c. Owned by the cache.
+  /// Arrays used with it must have the same alignment as in and out.
+  static fftw_plan GetR2CManyPlan(int n, int howMany, const double *in,
+                                  const fftw_complex *out,
+                                  unsigned int flags);
+
+  /// @brief Plan for a batch of real to complex transforms with the default
+  /// rigour
+  static fftw_plan GetR2CManyPlan(int n, int howMany, const double *in,
+                                  const fftw_complex *out) {
+    return GetR2CManyPlan(n, howMany, in, out, GetPlannerFlags());
+  }
+
+  /// @brief Plan for a complex to real transform. Does not modify in or out
+  /// @param n Number of real samples
+  /// @param in Example input array of n / 2 + 1 frequencies
+  /// @param out Example output array of n samples
+  /// @param flags FFTW planner rigour, e.g. FFTW_ESTIMATE or FFTW_MEASURE
+  /// @return Plan to use with fftw_execute_dft_c2r, which overwrites its
+  /// input. Owned by the cache. Arrays used with it must have the same
+  /// alignment as in and out.
+  static fftw_plan GetC2RPlan(int n, const fftw_complex *in, const double *out,
+                              unsigned int flags);
+
+  /// @brief Plan for a complex to real transform with the default rigour
+  static fftw_plan GetC2RPlan(int n, const fftw_complex *in,
+                              const double *out) {
+    return GetC2RPlan(n, in, out, GetPlannerFlags());
+  }
+
+  /// @brief Sets the planner rigour used by default. FFTW_MEASURE or
+  /// FFTW_PATIENT make faster plans but take longer to plan each new size.
+  /// Only affects plans made afterwards.
+  /// @param flags FFTW planner rigour flag
+  static void SetPlannerFlags(unsigned int flags);
+
+  /// @brief Getter function for the default planner rigour
+  static unsigned int GetPlannerFlags();
+
+  /// @brief Loads FFTW wisdom saved by an earlier job, so that plans it
+  /// measured do not need measuring again
+  /// @param filePath Path to the wisdom file
+  /// @return True if the wisdom was read
+  static bool ImportWisdom(const std::string &filePath);
+
+  /// @brief Saves the FFTW wisdom accumulated so far
+  /// @param filePath Path to the wisdom file, which is overwritten
+  /// @return True if the wisdom was written
+  static bool ExportWisdom(const std::string &filePath);
+
+  /// @brief Number of plans held by the cache
+  static size_t GetNPlans();
+};
+}  // namespace rad
+
+#endif
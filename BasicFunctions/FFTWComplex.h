@@ -14,7 +14,7 @@ namespace rad {
 class FFTWComplex {
  public:
   FFTWComplex() : re(0), im(0){};  ///< Default constructor
-  ~FFTWComplex(){};                ///< Destructor
+  ~FFTWComplex() = default;        ///< Destructor
 
   double re;  ///< The real part
   double im;  ///< The imaginary part
@@ -0,0 +1,91 @@
+/*
+  FIRDecimator.cxx
+*/
+
+#include "BasicFunctions/FIRDecimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+rad::FIRDecimator::FIRDecimator(unsigned int ratio, double passbandEdge,
+                                double stopbandEdge, double sampleRate,
+                                double attenuation)
+    : m(ratio) {
+  if (ratio == 0 || passbandEdge < 0 || stopbandEdge <= passbandEdge ||
+      stopbandEdge > sampleRate / 2 || attenuation <= 0) {
+    std::cout << "Invalid decimating filter parameters. Exiting.\n";
+    exit(1);
+  }
+  taps = DesignLowPass(passbandEdge, stopbandEdge, sampleRate, attenuation,
+                       ratio);
+  Reset();
+}
+
+std::vector<double> rad::FIRDecimator::DesignLowPass(
+    double passbandEdge, double stopbandEdge, double sampleRate,
+    double attenuation, unsigned int delayMultiple) {
+  // Kaiser's estimates of the window shape and length needed for the
+  // attenuation and transition width
+  const double deltaOmega{2 * M_PI * (stopbandEdge - passbandEdge) /
+                          sampleRate};
+  double beta{0};
+  if (attenuation > 50) {
+    beta = 0.1102 * (attenuation - 8.7);
+  } else if (attenuation >= 21) {
+    beta = 0.5842 * pow(attenuation - 21, 0.4) + 0.07886 * (attenuation - 21);
+  }
+  const double nEstimate{(attenuation - 7.95) / (2.285 * deltaOmega)};
+
+  // Round the half length up to the requested multiple
+  const unsigned int mult{std::max(1u, delayMultiple)};
+  unsigned int halfLength{
+      (unsigned int)(std::ceil(nEstimate / 2 / double(mult))) * mult};
+  if (halfLength == 0) halfLength = mult;
+  const unsigned int nTaps{2 * halfLength + 1};
+
+  // Windowed sinc with the cut-off in the middle of the transition band
+  const double fc{0.5 * (passbandEdge + stopbandEdge) / sampleRate};
+  const double i0Beta{std::cyl_bessel_i(0.0, beta)};
+  std::vector<double> taps(nTaps);
+  double sum{0};
+  for (unsigned int i{0}; i < nTaps; i++) {
+    const double k{double(i) - double(halfLength)};
+    const double sinc{k == 0 ? 2 * fc : sin(2 * M_PI * fc * k) / (M_PI * k)};
+    const double r{k / double(halfLength)};
+    const double window{std::cyl_bessel_i(0.0, beta * sqrt(1 - r * r)) /
+                        i0Beta};
+    taps[i] = sinc * window;
+    sum += taps[i];
+  }
+  // Unit gain at DC
+  for (auto &t : taps) t /= sum;
+  return taps;
+}
+
+void rad::FIRDecimator::Reset() {
+  history.assign(2 * taps.size(), 0);
+  pos = 0;
+  nIn = 0;
+}
+
+bool rad::FIRDecimator::Push(double x, double &y) {
+  const size_t nTaps{taps.size()};
+  history[pos] = x;
+  history[pos + nTaps] = x;
+  pos = (pos + 1 == nTaps) ? 0 : pos + 1;
+  nIn++;
+
+  // Only every m-th output is needed, and only once the centre of the
+  // filter has reached the first input sample
+  const unsigned long n{nIn - 1};
+  if (n % m != 0 || n < GetDelay()) return false;
+
+  // history[pos] is now the oldest sample. The taps are symmetric, so no
+  // reversal is needed.
+  const double *xs{history.data() + pos};
+  double acc{0};
+  for (size_t k{0}; k < nTaps; k++) acc += taps[k] * xs[k];
+  y = acc;
+  return true;
+}
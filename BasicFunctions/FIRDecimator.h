@@ -0,0 +1,77 @@
+/*
+  FIRDecimator.h
+
+  Streaming polyphase FIR decimator
+  A linear phase, Kaiser windowed sinc low pass filter combined with
+  downsampling by an integer ratio. Only the outputs that survive the
+  downsampling are ever computed, so each input sample costs nTaps / ratio
+  multiply-adds.
+*/
+
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <cstddef>
+#include <vector>
+
+namespace rad {
+class FIRDecimator {
+ public:
+  /// @brief Parametrised constructor
+  /// @param ratio Decimation ratio
+  /// @param passbandEdge Highest frequency to pass unattenuated in Hertz
+  /// @param stopbandEdge Lowest frequency to fully attenuate in Hertz. To
+  /// avoid aliasing this should not exceed half the output sample rate
+  /// @param sampleRate Input sample rate in Hertz
+  /// @param attenuation Stopband attenuation in dB
+  FIRDecimator(unsigned int ratio, double passbandEdge, double stopbandEdge,
+               double sampleRate, double attenuation = 60);
+
+  /// @brief Adds an input sample
+  /// @param x Input sample
+  /// @param y Set to the next output sample, if there is one
+  /// @return True if an output sample was produced
+  bool Push(double x, double &y);
+
+  /// @brief Clears the stored input samples
+  void Reset();
+
+  /// @brief Getter function for decimation ratio
+  unsigned int GetRatio() const { return m; }
+
+  /// @brief Getter function for filter coefficients
+  /// @return Vector of filter taps, normalised to unit gain at DC
+  std::vector<double> GetTaps() const { return taps; }
+
+  /// @brief Designs a linear phase, Kaiser windowed sinc low pass filter
+  /// @param passbandEdge Highest frequency to pass unattenuated in Hertz
+  /// @param stopbandEdge Lowest frequency to fully attenuate in Hertz
+  /// @param sampleRate Sample rate in Hertz
+  /// @param attenuation Stopband attenuation in dB
+  /// @param delayMultiple The filter delay, (nTaps - 1) / 2, is rounded up to
+  /// a multiple of this many samples
+  /// @return Vector of filter taps, normalised to unit gain at DC
+  static std::vector<double> DesignLowPass(double passbandEdge,
+                                           double stopbandEdge,
+                                           double sampleRate,
+                                           double attenuation = 60,
+                                           unsigned int delayMultiple = 1);
+
+  /// @brief Delay of the filter in input samples. This is always a multiple
+  /// of the ratio, so output k corresponds to input sample k * ratio.
+  unsigned int GetDelay() const { return (taps.size() - 1) / 2; }
+
+ private:
+  unsigned int m;  // Decimation ratio
+
+  std::vector<double> taps;  // Filter coefficients, symmetric
+
+  // Delay line holding each sample twice, so the most recent nTaps samples
+  // are always contiguous
+  std::vector<double> history;
+  size_t pos{0};         // Position of the oldest sample in the delay line
+  unsigned long nIn{0};  // Number of input samples so far
+};
+}  // namespace rad
+
+#endif
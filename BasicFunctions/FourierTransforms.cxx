@@ -4,36 +4,37 @@
 
 #include "BasicFunctions/FourierTransforms.h"
 
+#include <complex>
+#include <vector>
+
+#include "BasicFunctions/FFTPlanCache.h"
+
+// The transforms write straight into the returned arrays
+static_assert(sizeof(rad::FFTWComplex) == sizeof(fftw_complex),
+              "FFTWComplex must have the same layout as fftw_complex");
+
 namespace rad {
 FFTWComplex *doFFT(int length, double *theInput) {
   const int numFreqs = (length / 2) + 1;
-  fftw_complex *out;
-  out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * numFreqs);
-  fftw_plan p = fftw_plan_dft_r2c_1d(length, theInput, out, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
-
   rad::FFTWComplex *result = new rad::FFTWComplex[numFreqs];
-  for (int i = 0; i < numFreqs; i++) {
-    result[i] = rad::FFTWComplex(out[i][0], out[i][1]);
-  }
-  fftw_free(out);
+  fftw_complex *out = reinterpret_cast<fftw_complex *>(result);
+  fftw_plan p = FFTPlanCache::GetR2CPlan(length, theInput, out);
+  fftw_execute_dft_r2c(p, theInput, out);
   return result;
 }
 
 double *doInverseFFT(int length, const rad::FFTWComplex *theInput) {
   const int numFreqs = (length / 2) + 1;
-  fftw_complex *in;
-  in = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * numFreqs);
+  // The transform overwrites its input, so work on a copy kept between calls
+  thread_local std::vector<std::complex<double>> inBuf;
+  inBuf.resize(numFreqs);
   for (int i = 0; i < numFreqs; i++) {
-    in[i][0] = theInput[i].re;
-    in[i][1] = theInput[i].im;
+    inBuf[i] = std::complex<double>(theInput[i].re, theInput[i].im);
   }
+  fftw_complex *in = reinterpret_cast<fftw_complex *>(inBuf.data());
   double *result = new double[length];
-  fftw_plan p = fftw_plan_dft_c2r_1d(length, in, result, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
-  fftw_free(in);
+  fftw_plan p = FFTPlanCache::GetC2RPlan(length, in, result);
+  fftw_execute_dft_c2r(p, in, result);
   return result;
 }
-}  // namespace rad
\ No newline at end of file
+}  // namespace rad
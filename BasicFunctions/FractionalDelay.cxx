@@ -0,0 +1,55 @@
+/*
+  FractionalDelay.cxx
+*/
+
+#include "BasicFunctions/FractionalDelay.h"
+
+#include <cmath>
+#include <iostream>
+
+rad::FractionalDelay::FractionalDelay(double delay, unsigned int halfLength,
+                                      double beta)
+    : delay(delay) {
+  if (!std::isfinite(delay) || halfLength == 0 || beta < 0) {
+    std::cout << "Invalid fractional delay parameters. Exiting.\n";
+    exit(1);
+  }
+
+  const double whole{std::round(delay)};
+  if (std::abs(delay - whole) < 1e-6) {
+    // Whole numbers of samples are just a shift
+    taps = {1};
+    offset = (long long)(whole);
+    return;
+  }
+
+  // The delayed sample lies a fraction mu of the way between input samples
+  // base and base + 1, and is interpolated from the halfLength samples on
+  // either side
+  const double floorDelay{std::floor(delay)};
+  const double mu{1 - (delay - floorDelay)};
+  offset = (long long)(floorDelay) + (long long)(halfLength);
+
+  const double i0Beta{std::cyl_bessel_i(0.0, beta)};
+  taps.resize(2 * halfLength);
+  double sum{0};
+  for (size_t j{0}; j < taps.size(); j++) {
+    // Distance from the interpolated point to this input sample
+    const double u{mu - (double(j) - double(halfLength) + 1)};
+    const double sinc{sin(M_PI * u) / (M_PI * u)};
+    const double r{u / double(halfLength)};
+    const double window{std::cyl_bessel_i(0.0, beta * sqrt(1 - r * r)) /
+                        i0Beta};
+    taps[j] = sinc * window;
+    sum += taps[j];
+  }
+  // Unit gain at DC
+  for (auto &t : taps) t /= sum;
+}
+
+void rad::FractionalDelay::GetOutputRange(size_t nIn, long long &first,
+                                          long long &end) const {
+  first = offset;
+  end = (long long)(nIn) - (long long)(taps.size()) + 1 + offset;
+  if (end < first) end = first;
+}
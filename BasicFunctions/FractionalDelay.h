@@ -0,0 +1,74 @@
+/*
+  FractionalDelay.h
+
+  Delays an evenly sampled signal by a fixed, non-integer number of samples
+  The delay is split into a whole number of samples, which is applied by
+  indexing, and a fraction of a sample, which is applied by a short Kaiser
+  windowed sinc interpolator. The taps only depend on the fraction, so they
+  are designed once and each output sample then costs 2 * halfLength
+  multiply-adds.
+*/
+
+#ifndef FRACTIONAL_DELAY_H
+#define FRACTIONAL_DELAY_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace rad {
+class FractionalDelay {
+ public:
+  // Input samples used either side of each interpolated point by default
+  static constexpr unsigned int kDefaultHalfLength{8};
+  // Kaiser window shape giving errors of a few parts per million from DC up
+  // to a quarter of the sample rate with the default length
+  static constexpr double kDefaultBeta{12};
+
+  /// @brief Parametrised constructor
+  /// @param delay Delay in samples. Delays within 1e-6 of a whole number of
+  /// samples are applied exactly, without interpolation
+  /// @param halfLength Input samples used either side of each interpolated
+  /// point
+  /// @param beta Shape parameter of the Kaiser window
+  explicit FractionalDelay(double delay,
+                           unsigned int halfLength = kDefaultHalfLength,
+                           double beta = kDefaultBeta);
+
+  /// @brief Getter function for the delay in samples
+  double GetDelay() const { return delay; }
+
+  /// @brief Getter function for filter coefficients
+  /// @return Vector of taps, normalised to unit gain at DC
+  std::vector<double> GetTaps() const { return taps; }
+
+  /// @brief Range of output samples that only use a block of input samples
+  /// @param nIn Number of input samples
+  /// @param first Set to the first output sample, numbered from the first
+  /// input sample
+  /// @param end Set to one past the last output sample
+  void GetOutputRange(size_t nIn, long long &first, long long &end) const;
+
+  /// @brief Delayed signal at one sample
+  /// @param x Input samples
+  /// @param i Output sample number, numbered from the first input sample.
+  /// Must be within the output range for x
+  /// @return Interpolated value of the input at sample i - delay
+  double Eval(std::span<const double> x, long long i) const {
+    const double *in{x.data() + (i - offset)};
+    double sum{0};
+    for (size_t j{0}; j < taps.size(); j++) sum += taps[j] * in[j];
+    return sum;
+  }
+
+ private:
+  double delay;
+
+  std::vector<double> taps;
+
+  // Output sample i uses input samples i - offset to i - offset + nTaps - 1
+  long long offset{0};
+};
+}  // namespace rad
+
+#endif
@@ -0,0 +1,79 @@
+/*
+  RingBuffer.h
+
+  Fixed capacity first-in first-out buffer held in one contiguous block
+  Once full, each new element overwrites the oldest one, so a stream can be
+  followed without any allocation or shifting of elements. Elements are
+  addressed by their absolute position in the stream, which stays valid for
+  as long as the element is held.
+*/
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rad {
+template <typename T>
+class RingBuffer {
+ public:
+  /// @brief Parametrised constructor
+  /// @param minCapacity Minimum number of elements held. Rounded up to a
+  /// power of two
+  explicit RingBuffer(size_t minCapacity = 1) {
+    size_t capacity{1};
+    while (capacity < minCapacity) capacity <<= 1;
+    data.resize(capacity);
+    mask = capacity - 1;
+  }
+
+  /// @brief Adds an element, dropping the oldest one if the buffer is full
+  /// @param value Element to add
+  void PushBack(const T &value) {
+    data[(first + count) & mask] = value;
+    if (count == data.size()) {
+      first++;
+    } else {
+      count++;
+    }
+  }
+
+  /// @brief Removes all the elements. Positions carry on from the last one
+  void Clear() {
+    first += count;
+    count = 0;
+  }
+
+  size_t Size() const { return count; }
+
+  bool Empty() const { return count == 0; }
+
+  size_t Capacity() const { return data.size(); }
+
+  /// @brief Stream position of the oldest element held
+  uint64_t FirstPos() const { return first; }
+
+  /// @brief Stream position of the newest element held
+  uint64_t LastPos() const { return first + count - 1; }
+
+  /// @param pos Stream position, between FirstPos() and LastPos()
+  /// @return Element at that position
+  const T &At(uint64_t pos) const { return data[pos & mask]; }
+
+  /// @brief Oldest element held
+  const T &Front() const { return At(first); }
+
+  /// @brief Newest element held
+  const T &Back() const { return At(first + count - 1); }
+
+ private:
+  std::vector<T> data;
+  uint64_t mask{0};
+  uint64_t first{0};  // Stream position of the oldest element
+  size_t count{0};
+};
+}  // namespace rad
+
+#endif
@@ -0,0 +1,111 @@
+/*
+  Spectrogram.cxx
+*/
+
+#include "BasicFunctions/Spectrogram.h"
+
+#include <fftw3.h>
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "BasicFunctions/FFTPlanCache.h"
+#include "BasicFunctions/ThreadPool.h"
+
+rad::Spectrogram::Spectrogram(size_t frameLength, size_t hop,
+                              WindowType windowType, SpectrumNorm norm)
+    : frameLength(frameLength),
+      hop(hop),
+      nFreqs(frameLength / 2 + 1),
+      norm(norm),
+      window(MakeWindow(windowType, frameLength)) {
+  if (frameLength < 2 || hop == 0) {
+    std::cout << "Invalid spectrogram frame length or hop. Exiting.\n";
+    exit(1);
+  }
+  double sumSq{0};
+  for (double w : window) sumSq += w * w;
+  windowScale = double(frameLength) / sumSq;
+}
+
+void rad::Spectrogram::Compute(TimeSeriesView x, unsigned int nThreads) {
+  t0 = x.GetStartTime();
+  dt = x.GetTimeStep();
+  nFrames = x.Size() < frameLength ? 0 : (x.Size() - frameLength) / hop + 1;
+  power.resize(nFrames * nFreqs);
+  if (nFrames == 0) return;
+
+  const size_t nBatches{(nFrames + kFramesPerBatch - 1) / kFramesPerBatch};
+  const size_t batchSize{std::min(kFramesPerBatch, nFrames)};
+  const size_t lastBatchSize{nFrames - (nBatches - 1) * kFramesPerBatch};
+  if (nThreads == 0) {
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  ThreadPool pool(std::min(nThreads, (unsigned int)(nBatches)));
+
+  // Each thread windows a batch of frames into its own buffer and
+  // transforms them together
+  std::vector<double *> timeBufs(pool.GetNThreads());
+  std::vector<fftw_complex *> freqBufs(pool.GetNThreads());
+  for (unsigned int t{0}; t < pool.GetNThreads(); t++) {
+    timeBufs[t] = (double *)fftw_malloc(sizeof(double) * frameLength *
+                                        batchSize);
+    freqBufs[t] = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * nFreqs *
+                                              batchSize);
+  }
+  // Plans are made up front since the planner is serialised
+  const fftw_plan batchPlan{FFTPlanCache::GetR2CManyPlan(
+      int(frameLength), int(batchSize), timeBufs[0], freqBufs[0])};
+  const fftw_plan lastPlan{FFTPlanCache::GetR2CManyPlan(
+      int(frameLength), int(lastBatchSize), timeBufs[0], freqBufs[0])};
+
+  const double *in{x.Data()};
+  pool.Run([&](unsigned int iThread) {
+    size_t begin, end;
+    pool.GetRange(nBatches, iThread, begin, end);
+    double *timeBuf{timeBufs[iThread]};
+    fftw_complex *freqBuf{freqBufs[iThread]};
+    for (size_t b{begin}; b < end; b++) {
+      const size_t firstFrame{b * kFramesPerBatch};
+      const bool lastBatch{b == nBatches - 1};
+      const size_t n{lastBatch ? lastBatchSize : batchSize};
+      for (size_t f{0}; f < n; f++) {
+        const double *frame{in + (firstFrame + f) * hop};
+        double *buf{timeBuf + f * frameLength};
+        for (size_t i{0}; i < frameLength; i++) buf[i] = frame[i] * window[i];
+      }
+
+      fftw_execute_dft_r2c(lastBatch ? lastPlan : batchPlan, timeBuf,
+                           freqBuf);
+      for (size_t f{0}; f < n; f++) {
+        SpectrumCalculator::Normalise(
+            freqBuf + f * nFreqs, frameLength, dt, norm, windowScale,
+            std::span<double>(power).subspan((firstFrame + f) * nFreqs,
+                                             nFreqs));
+      }
+    }
+  });
+
+  for (unsigned int t{0}; t < pool.GetNThreads(); t++) {
+    fftw_free(timeBufs[t]);
+    fftw_free(freqBufs[t]);
+  }
+}
+
+TH2D *rad::Spectrogram::ToTH2D(const char *name, const char *title) const {
+  const double hopTime{double(hop) * dt};
+  const double firstCentre{t0 + 0.5 * double(frameLength) * dt};
+  const double deltaF{GetFrequency(1)};
+  TH2D *h2 = new TH2D(name, title, int(nFrames), firstCentre - hopTime / 2,
+                      firstCentre + (double(nFrames) - 0.5) * hopTime,
+                      int(nFreqs), -deltaF / 2,
+                      (double(nFreqs) - 0.5) * deltaF);
+  for (size_t i{0}; i < nFrames; i++) {
+    const double *frame{power.data() + i * nFreqs};
+    for (size_t k{0}; k < nFreqs; k++) {
+      h2->SetBinContent(int(i) + 1, int(k) + 1, frame[k]);
+    }
+  }
+  return h2;
+}
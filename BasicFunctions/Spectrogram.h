@@ -0,0 +1,104 @@
+/*
+  Spectrogram.h
+
+  Short time Fourier transform of an evenly sampled time series
+  The series is cut into frames of a fixed length, which may overlap, and
+  each frame is windowed and transformed. Frames are transformed in batches
+  with a single FFTW plan, and the batches are shared between threads. The
+  spectra are stored in one contiguous row-major array, one row per frame,
+  and only copied into a histogram when asked for.
+*/
+
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "BasicFunctions/SpectrumCalculator.h"
+#include "BasicFunctions/TimeSeries.h"
+#include "TH2.h"
+
+namespace rad {
+class Spectrogram {
+ public:
+  // Frames transformed by each execution of the batched plan
+  static constexpr size_t kFramesPerBatch{64};
+
+  /// @brief Parametrised constructor
+  /// @param frameLength Number of samples in each frame
+  /// @param hop Number of samples between the starts of consecutive frames.
+  /// Equal to frameLength for frames which do not overlap
+  /// @param windowType Window function applied to each frame
+  /// @param norm Normalisation of each spectrum. Powers are divided by the
+  /// mean squared window coefficient.
+  Spectrogram(size_t frameLength, size_t hop,
+              WindowType windowType = WindowType::kRectangular,
+              SpectrumNorm norm = SpectrumNorm::kPeriodogram);
+
+  /// @brief Computes the spectrum of every whole frame in a time series,
+  /// replacing any earlier result
+  /// @param x Input time series
+  /// @param nThreads Number of threads to share the frames between. 0 uses
+  /// one per hardware thread
+  void Compute(TimeSeriesView x, unsigned int nThreads = 1);
+
+  /// @brief Getter function for the number of samples in each frame
+  size_t GetFrameLength() const { return frameLength; }
+
+  /// @brief Getter function for the number of samples between frames
+  size_t GetHop() const { return hop; }
+
+  /// @brief Number of frames in the last result
+  size_t GetNFrames() const { return nFrames; }
+
+  /// @brief Number of frequency bins in each frame, frameLength / 2 + 1
+  size_t GetNFrequencies() const { return nFreqs; }
+
+  /// @param i Frame number
+  /// @return Time of the first sample in the frame [s]
+  double GetFrameStartTime(size_t i) const {
+    return t0 + double(i * hop) * dt;
+  }
+
+  /// @param k Frequency bin number
+  /// @return Frequency of the bin [Hz]
+  double GetFrequency(size_t k) const {
+    return double(k) / (double(frameLength) * dt);
+  }
+
+  /// @brief All the spectra. Bin k of frame i is at i * GetNFrequencies() + k
+  std::span<const double> GetPower() const { return power; }
+
+  /// @param i Frame number
+  /// @return Spectrum of the frame
+  std::span<const double> GetFrame(size_t i) const {
+    return std::span<const double>(power).subspan(i * nFreqs, nFreqs);
+  }
+
+  /// @brief Copies the spectra into a new histogram, owned by the caller.
+  /// Time bins are centred on the middle of each frame and are one hop
+  /// wide. Frequency bins are centred on the bin frequencies.
+  /// @param name Name of the histogram
+  /// @param title Histogram and axis titles
+  TH2D *ToTH2D(const char *name = "",
+               const char *title = "; Time [s]; Frequency [Hz]") const;
+
+ private:
+  size_t frameLength;
+  size_t hop;
+  size_t nFreqs;
+  SpectrumNorm norm;
+  std::vector<double> window;
+  double windowScale;  // Reciprocal of the mean squared window coefficient
+
+  // Results of the last call to Compute
+  double t0{0};
+  double dt{1};
+  size_t nFrames{0};
+  std::vector<double> power;
+};
+}  // namespace rad
+
+#endif
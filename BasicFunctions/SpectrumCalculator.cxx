@@ -0,0 +1,115 @@
+/*
+  SpectrumCalculator.cxx
+*/
+
+#include "BasicFunctions/SpectrumCalculator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "BasicFunctions/FFTPlanCache.h"
+
+std::vector<double> rad::MakeWindow(WindowType type, size_t length) {
+  std::vector<double> w(length, 1.0);
+  for (size_t i{0}; i < length; i++) {
+    const double phase{2 * M_PI * double(i) / double(length)};
+    if (type == WindowType::kHann) {
+      w[i] = 0.5 - 0.5 * cos(phase);
+    } else if (type == WindowType::kHamming) {
+      w[i] = 0.54 - 0.46 * cos(phase);
+    } else if (type == WindowType::kBlackman) {
+      w[i] = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2 * phase);
+    }
+  }
+  return w;
+}
+
+rad::SpectrumCalculator::SpectrumCalculator(size_t length)
+    : n(length), nFreqs(length / 2 + 1) {
+  if (length < 2) {
+    std::cout << "Need at least two samples to make a spectrum. Exiting.\n";
+    exit(1);
+  }
+  timeBuf = (double *)fftw_malloc(sizeof(double) * n);
+  freqBuf = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * nFreqs);
+  plan = FFTPlanCache::GetR2CPlan(int(n), timeBuf, freqBuf);
+}
+
+rad::SpectrumCalculator::~SpectrumCalculator() {
+  fftw_free(timeBuf);
+  fftw_free(freqBuf);
+}
+
+void rad::SpectrumCalculator::CheckSizes(size_t nIn, size_t nOut) const {
+  if (nIn != n || nOut < nFreqs) {
+    std::cout << "Spectrum of " << n << " samples given " << nIn
+              << " samples and room for " << nOut << " bins. Exiting.\n";
+    exit(1);
+  }
+}
+
+void rad::SpectrumCalculator::Compute(std::span<const double> x,
+                                      double deltaT, SpectrumNorm norm,
+                                      std::span<double> out) {
+  CheckSizes(x.size(), out.size());
+  std::copy(x.begin(), x.end(), timeBuf);
+  fftw_execute_dft_r2c(plan, timeBuf, freqBuf);
+  Normalise(freqBuf, n, deltaT, norm, 1, out);
+}
+
+void rad::SpectrumCalculator::Compute(std::span<const double> x,
+                                      std::span<const double> window,
+                                      double deltaT, SpectrumNorm norm,
+                                      std::span<double> out) {
+  CheckSizes(x.size(), out.size());
+  if (window.size() != n) {
+    std::cout << "Window has " << window.size() << " coefficients for " << n
+              << " samples. Exiting.\n";
+    exit(1);
+  }
+  double sumSq{0};
+  for (size_t i{0}; i < n; i++) {
+    timeBuf[i] = x[i] * window[i];
+    sumSq += window[i] * window[i];
+  }
+  fftw_execute_dft_r2c(plan, timeBuf, freqBuf);
+  Normalise(freqBuf, n, deltaT, norm, double(n) / sumSq, out);
+}
+
+void rad::SpectrumCalculator::Normalise(const fftw_complex *fft, size_t n,
+                                        double deltaT, SpectrumNorm norm,
+                                        double scale, std::span<double> out) {
+  const size_t nFreqs{n / 2 + 1};
+  if (norm == SpectrumNorm::kMagnitude) {
+    for (size_t k{0}; k < nFreqs; k++) {
+      out[k] = std::hypot(fft[k][0], fft[k][1]);
+    }
+    return;
+  }
+
+  const double nDub{double(n)};
+  // Periodogram normalisation, then converted to the requested one
+  double binScale{scale / (nDub * nDub)};
+  if (norm == SpectrumNorm::kPSD) {
+    binScale *= nDub * deltaT;
+  } else if (norm == SpectrumNorm::kEnergySpectralDensity) {
+    binScale *= nDub * deltaT * nDub * deltaT;
+  }
+
+  for (size_t k{0}; k < nFreqs; k++) {
+    const double re{fft[k][0]};
+    const double im{fft[k][1]};
+    out[k] = (re * re + im * im) * binScale;
+  }
+  // Fold in the negative frequencies. For even lengths the last bin is the
+  // Nyquist frequency, which has no partner.
+  const size_t lastFolded{n % 2 == 0 ? nFreqs - 1 : nFreqs};
+  for (size_t k{1}; k < lastFolded; k++) out[k] *= 2;
+}
+
+void rad::SpectrumCalculator::GetFrequencies(double deltaT,
+                                             std::span<double> freqs) const {
+  const double deltaF{1 / (deltaT * double(n))};
+  for (size_t k{0}; k < nFreqs; k++) freqs[k] = double(k) * deltaF;
+}
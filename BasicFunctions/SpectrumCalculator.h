@@ -0,0 +1,108 @@
+/*
+  SpectrumCalculator.h
+
+  Single sided spectra of fixed length blocks of real samples
+  The FFT buffers are made once at construction and the plans come from the
+  shared cache, so each block only costs one copy and one FFT. The result is
+  written into an array provided by the caller, which lets spectrogram and
+  averaging loops run without allocating anything per block.
+*/
+
+#ifndef SPECTRUM_CALCULATOR_H
+#define SPECTRUM_CALCULATOR_H
+
+#include <fftw3.h>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace rad {
+/// Normalisations of the single sided spectrum X_k of N samples x_n spaced
+/// by dt. Every bin apart from zero frequency and the Nyquist frequency
+/// includes the matching negative frequency.
+enum class SpectrumNorm {
+  kMagnitude,    // |X_k|, with no normalisation or folding
+  kPeriodogram,  // Mean squared amplitude in each bin, summing to mean(x^2)
+  kPSD,          // Periodogram per unit frequency [x^2 Hz^-1]
+  kEnergySpectralDensity  // PSD multiplied by the block length N * dt
+};
+
+/// Window functions for tapering blocks before transforming them
+enum class WindowType { kRectangular, kHann, kHamming, kBlackman };
+
+/// @brief Makes the coefficients of a window. The windows are periodic, so
+/// that they sum to a constant when overlapped by suitable amounts
+/// @param type Window function
+/// @param length Number of coefficients
+/// @return Vector of length coefficients
+std::vector<double> MakeWindow(WindowType type, size_t length);
+
+class SpectrumCalculator {
+ public:
+  /// @brief Parametrised constructor
+  /// @param length Number of samples in each block
+  explicit SpectrumCalculator(size_t length);
+
+  /// Destructor, frees the FFTW buffers
+  ~SpectrumCalculator();
+
+  SpectrumCalculator(const SpectrumCalculator &) = delete;
+  SpectrumCalculator &operator=(const SpectrumCalculator &) = delete;
+
+  /// @brief Getter function for the number of samples in each block
+  size_t GetLength() const { return n; }
+
+  /// @brief Number of frequency bins, length / 2 + 1
+  size_t GetNFrequencies() const { return nFreqs; }
+
+  /// @brief Computes the spectrum of one block
+  /// @param x Block of GetLength() samples
+  /// @param deltaT Time between samples [s]
+  /// @param norm Normalisation of the output
+  /// @param out Set to the spectrum. Must hold GetNFrequencies() values
+  void Compute(std::span<const double> x, double deltaT, SpectrumNorm norm,
+               std::span<double> out);
+
+  /// @brief Computes the spectrum of a block with each sample scaled by a
+  /// window, without modifying the input
+  /// @param x Block of GetLength() samples
+  /// @param window GetLength() window coefficients
+  /// @param deltaT Time between samples [s]
+  /// @param norm Normalisation of the output. Powers are divided by the mean
+  /// squared window coefficient so that white noise keeps its level.
+  /// @param out Set to the spectrum. Must hold GetNFrequencies() values
+  void Compute(std::span<const double> x, std::span<const double> window,
+               double deltaT, SpectrumNorm norm, std::span<double> out);
+
+  /// @brief Frequencies of the output bins
+  /// @param deltaT Time between samples [s]
+  /// @param freqs Set to the bin frequencies [Hz]. Must hold
+  /// GetNFrequencies() values
+  void GetFrequencies(double deltaT, std::span<double> freqs) const;
+
+  /// @brief Converts an FFT of a block to a normalised spectrum
+  /// @param fft The n / 2 + 1 FFT outputs
+  /// @param n Number of samples in the block
+  /// @param deltaT Time between samples [s]
+  /// @param norm Normalisation of the output
+  /// @param scale Extra factor applied to the powers
+  /// @param out Set to the spectrum. Must hold n / 2 + 1 values
+  static void Normalise(const fftw_complex *fft, size_t n, double deltaT,
+                        SpectrumNorm norm, double scale,
+                        std::span<double> out);
+
+ private:
+  size_t n;       // Block length
+  size_t nFreqs;  // Number of frequency bins, n / 2 + 1
+
+  double *timeBuf = 0;
+  fftw_complex *freqBuf = 0;
+  fftw_plan plan = 0;  // Owned by FFTPlanCache
+
+  /// @brief Checks the sizes of the arrays passed in
+  void CheckSizes(size_t nIn, size_t nOut) const;
+};
+}  // namespace rad
+
+#endif
@@ -0,0 +1,82 @@
+/*
+  ThreadPool.cxx
+*/
+
+#include "BasicFunctions/ThreadPool.h"
+
+#include <algorithm>
+
+rad::ThreadPool::ThreadPool(unsigned int nThreads) : nThreads(nThreads) {
+  if (this->nThreads == 0) {
+    this->nThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned int i{1}; i < this->nThreads; i++) {
+    workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+rad::ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  startCV.notify_all();
+  for (auto &w : workers) w.join();
+}
+
+void rad::ThreadPool::GetRange(size_t nItems, unsigned int iThread,
+                               size_t &begin, size_t &end) const {
+  begin = nItems * iThread / nThreads;
+  end = nItems * (iThread + 1) / nThreads;
+}
+
+void rad::ThreadPool::Run(const std::function<void(unsigned int)> &job) {
+  if (workers.empty()) {
+    job(0);
+    return;
+  }
+
+  currentJob = &job;
+  nRunning = (unsigned int)(workers.size());
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    generation++;
+  }
+  startCV.notify_all();
+
+  // Do this thread's share, then wait for the others
+  job(0);
+  for (unsigned int spin{0}; spin < kSpinCount && nRunning > 0; spin++) {
+    std::this_thread::yield();
+  }
+  if (nRunning > 0) {
+    std::unique_lock<std::mutex> lock(mtx);
+    doneCV.wait(lock, [this] { return nRunning == 0; });
+  }
+  currentJob = 0;
+}
+
+void rad::ThreadPool::WorkerLoop(unsigned int iThread) {
+  uint64_t lastGeneration{0};
+  while (true) {
+    for (unsigned int spin{0}; spin < kSpinCount &&
+                               generation == lastGeneration && !stopping;
+         spin++) {
+      std::this_thread::yield();
+    }
+    if (generation == lastGeneration && !stopping) {
+      std::unique_lock<std::mutex> lock(mtx);
+      startCV.wait(lock, [this, lastGeneration] {
+        return stopping || generation != lastGeneration;
+      });
+    }
+    if (stopping) return;
+
+    lastGeneration = generation;
+    (*currentJob)(iThread);
+    if (--nRunning == 0) {
+      std::lock_guard<std::mutex> lock(mtx);
+      doneCV.notify_one();
+    }
+  }
+}
@@ -0,0 +1,72 @@
+/*
+  ThreadPool.h
+
+  Fixed set of worker threads for splitting repeated, short pieces of work
+  Each call to Run executes the same job once on every thread, including the
+  calling one, and returns when they have all finished. Workers spin briefly
+  before sleeping, since jobs usually follow each other closely.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rad {
+class ThreadPool {
+ public:
+  /// @brief Parametrised constructor
+  /// @param nThreads Total number of threads, including the calling one. 0
+  /// uses one per hardware thread
+  explicit ThreadPool(unsigned int nThreads = 0);
+
+  /// Destructor, joins the worker threads
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// @brief Getter function for total number of threads
+  unsigned int GetNThreads() const { return nThreads; }
+
+  /// @brief Runs a job on every thread and waits for them all to finish
+  /// @param job Function called with the thread index, from 0 to
+  /// GetNThreads() - 1. Index 0 is the calling thread.
+  void Run(const std::function<void(unsigned int)> &job);
+
+  /// @brief Splits a range of items evenly between the threads
+  /// @param nItems Number of items
+  /// @param iThread Thread index
+  /// @param begin Set to the first item for this thread
+  /// @param end Set to one past the last item for this thread
+  void GetRange(size_t nItems, unsigned int iThread, size_t &begin,
+                size_t &end) const;
+
+ private:
+  // Number of checks for a new job or completion before sleeping
+  static constexpr unsigned int kSpinCount{2000};
+
+  unsigned int nThreads;
+  std::vector<std::thread> workers;
+
+  std::mutex mtx;
+  std::condition_variable startCV;
+  std::condition_variable doneCV;
+  const std::function<void(unsigned int)> *currentJob = 0;
+  std::atomic<uint64_t> generation{0};  // Incremented for each new job
+  std::atomic<unsigned int> nRunning{0};
+  std::atomic<bool> stopping{false};
+
+  /// @brief Main loop of each worker thread
+  /// @param iThread Thread index
+  void WorkerLoop(unsigned int iThread);
+};
+}  // namespace rad
+
+#endif
@@ -0,0 +1,40 @@
+/*
+  TimeSeries.cxx
+*/
+
+#include "BasicFunctions/TimeSeries.h"
+
+#include <iostream>
+
+TGraph *rad::TimeSeriesView::ToTGraph() const {
+  // Fill the graph's own arrays rather than adding points one at a time
+  TGraph *gr = new TGraph(int(vals.size()));
+  double *x{gr->GetX()};
+  double *y{gr->GetY()};
+  for (size_t i{0}; i < vals.size(); i++) {
+    x[i] = GetTime(i);
+    y[i] = vals[i];
+  }
+  return gr;
+}
+
+rad::TimeSeries rad::TimeSeries::FromTGraph(const TGraph *gr) {
+  const int n{gr->GetN()};
+  if (n < 2) {
+    std::cout << "Need at least two points to make a time series. Exiting.\n";
+    exit(1);
+  }
+  const double *x{gr->GetX()};
+  const double *y{gr->GetY()};
+  const double dt{(x[n - 1] - x[0]) / double(n - 1)};
+  for (int i{1}; i < n; i++) {
+    if (std::abs(x[i] - x[0] - double(i) * dt) > 1e-6 * dt) {
+      std::cout << "Graph points are not evenly spaced in time. Exiting.\n";
+      exit(1);
+    }
+  }
+
+  TimeSeries ts(x[0], dt, size_t(n));
+  std::copy(y, y + n, ts.vals.begin());
+  return ts;
+}
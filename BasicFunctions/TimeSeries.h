@@ -0,0 +1,202 @@
+/*
+  TimeSeries.h
+
+  Evenly sampled time series held in one contiguous buffer
+  Sample i is at time t0 + i * dt, so only the values are stored. Views refer
+  to a run of samples held elsewhere without copying them, so a series can be
+  sliced and handed between processing stages for free. Graphs are only built
+  when a series is returned to the user.
+*/
+
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "TGraph.h"
+
+namespace rad {
+/// Non-owning view of an evenly sampled time series
+class TimeSeriesView {
+ public:
+  TimeSeriesView() = default;
+
+  /// @brief Parametrised constructor
+  /// @param startTime Time of the first sample [s]
+  /// @param timeStep Time between samples [s]
+  /// @param values Sample values, which must outlive the view
+  TimeSeriesView(double startTime, double timeStep,
+                 std::span<const double> values)
+      : t0(startTime), dt(timeStep), vals(values) {}
+
+  size_t Size() const { return vals.size(); }
+
+  bool Empty() const { return vals.empty(); }
+
+  /// @brief Time of the first sample [s]
+  double GetStartTime() const { return t0; }
+
+  /// @brief Time between samples [s]
+  double GetTimeStep() const { return dt; }
+
+  /// @brief Sample rate [Hz]
+  double GetSampleRate() const { return 1 / dt; }
+
+  /// @param i Sample number
+  /// @return Time of the sample [s]
+  double GetTime(size_t i) const { return t0 + double(i) * dt; }
+
+  const double &operator[](size_t i) const { return vals[i]; }
+
+  std::span<const double> GetValues() const { return vals; }
+
+  const double *Data() const { return vals.data(); }
+
+  /// @param t Time in seconds
+  /// @return Number of the first sample at or after t, between 0 and Size()
+  size_t FirstSampleAfter(double t) const {
+    if (vals.empty() || t <= t0) return 0;
+    const double i{std::ceil((t - t0) / dt)};
+    if (i >= double(vals.size())) return vals.size();
+    size_t n{size_t(i)};
+    // Rounding can put the estimate one sample out
+    if (n > 0 && GetTime(n - 1) >= t) n--;
+    if (GetTime(n) < t) n++;
+    return n;
+  }
+
+  /// @brief View of a run of samples, cut short at the end of the series
+  /// @param first First sample number
+  /// @param n Number of samples
+  TimeSeriesView Slice(size_t first, size_t n) const {
+    first = std::min(first, vals.size());
+    n = std::min(n, vals.size() - first);
+    return {GetTime(first), dt, vals.subspan(first, n)};
+  }
+
+  /// @brief View of the samples within a time interval
+  /// @param minTime Earliest time in seconds
+  /// @param maxTime Latest time in seconds
+  TimeSeriesView SliceTime(double minTime, double maxTime) const {
+    const size_t first{FirstSampleAfter(minTime)};
+    size_t end{FirstSampleAfter(maxTime)};
+    if (end < vals.size() && GetTime(end) <= maxTime) end++;
+    return Slice(first, end > first ? end - first : 0);
+  }
+
+  /// @brief Copies the samples into a new graph, owned by the caller
+  TGraph *ToTGraph() const;
+
+ private:
+  double t0{0};
+  double dt{1};
+  std::span<const double> vals;
+};
+
+/// Evenly sampled time series which owns its values
+class TimeSeries {
+ public:
+  /// @brief Parametrised constructor
+  /// @param startTime Time of the first sample [s]
+  /// @param timeStep Time between samples [s]
+  /// @param n Number of samples, initially zero
+  explicit TimeSeries(double startTime = 0, double timeStep = 1, size_t n = 0)
+      : t0(startTime), dt(timeStep), vals(n) {}
+
+  /// @brief Parametrised constructor
+  /// @param startTime Time of the first sample [s]
+  /// @param timeStep Time between samples [s]
+  /// @param values Sample values, moved into the series
+  TimeSeries(double startTime, double timeStep, std::vector<double> values)
+      : t0(startTime), dt(timeStep), vals(std::move(values)) {}
+
+  /// @brief Copies the samples of a view
+  explicit TimeSeries(TimeSeriesView view)
+      : t0(view.GetStartTime()),
+        dt(view.GetTimeStep()),
+        vals(view.GetValues().begin(), view.GetValues().end()) {}
+
+  /// @brief Copies the points of a graph. Exits if they are not evenly spaced
+  /// @param gr Graph with at least two points
+  static TimeSeries FromTGraph(const TGraph *gr);
+
+  size_t Size() const { return vals.size(); }
+
+  bool Empty() const { return vals.empty(); }
+
+  /// @brief Time of the first sample [s]
+  double GetStartTime() const { return t0; }
+
+  /// @brief Time between samples [s]
+  double GetTimeStep() const { return dt; }
+
+  /// @brief Sample rate [Hz]
+  double GetSampleRate() const { return 1 / dt; }
+
+  /// @param i Sample number
+  /// @return Time of the sample [s]
+  double GetTime(size_t i) const { return t0 + double(i) * dt; }
+
+  /// @brief Moves the whole series in time
+  /// @param startTime New time of the first sample [s]
+  void SetStartTime(double startTime) { t0 = startTime; }
+
+  double &operator[](size_t i) { return vals[i]; }
+
+  const double &operator[](size_t i) const { return vals[i]; }
+
+  std::span<double> GetValues() { return vals; }
+
+  std::span<const double> GetValues() const { return vals; }
+
+  double *Data() { return vals.data(); }
+
+  const double *Data() const { return vals.data(); }
+
+  /// @brief Appends a sample at the next time step
+  /// @param v Sample value
+  void PushBack(double v) { vals.push_back(v); }
+
+  /// @brief Changes the number of samples. New samples are zero
+  void Resize(size_t n) { vals.resize(n); }
+
+  void Reserve(size_t n) { vals.reserve(n); }
+
+  /// @brief Removes all the samples, keeping the start time and step
+  void Clear() { vals.clear(); }
+
+  /// @brief View of the whole series
+  TimeSeriesView View() const { return {t0, dt, vals}; }
+
+  operator TimeSeriesView() const { return View(); }
+
+  /// @brief View of a run of samples, cut short at the end of the series
+  /// @param first First sample number
+  /// @param n Number of samples
+  TimeSeriesView Slice(size_t first, size_t n) const {
+    return View().Slice(first, n);
+  }
+
+  /// @brief View of the samples within a time interval
+  /// @param minTime Earliest time in seconds
+  /// @param maxTime Latest time in seconds
+  TimeSeriesView SliceTime(double minTime, double maxTime) const {
+    return View().SliceTime(minTime, maxTime);
+  }
+
+  /// @brief Copies the samples into a new graph, owned by the caller
+  TGraph *ToTGraph() const { return View().ToTGraph(); }
+
+ private:
+  double t0{0};
+  double dt{1};
+  std::vector<double> vals;
+};
+}  // namespace rad
+
+#endif
@@ -0,0 +1,118 @@
+// TrajectoryInterpolator.cxx
+
+#include "BasicFunctions/TrajectoryInterpolator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "TMath.h"
+
+rad::TrajectoryInterpolator::TrajectoryInterpolator(
+    TString trajectoryFilePath)
+    : source(TrajectorySource::Open(trajectoryFilePath)) {
+  SetUp();
+}
+
+rad::TrajectoryInterpolator::TrajectoryInterpolator(
+    std::unique_ptr<TrajectorySource> trajectorySource)
+    : source(std::move(trajectorySource)) {
+  SetUp();
+}
+
+void rad::TrajectoryInterpolator::SetUp() {
+  nEntries = (long long)(source->GetNEntries());
+  if (nEntries < 2) {
+    std::cout << "Trajectory file needs at least two entries. Exiting.\n";
+    exit(1);
+  }
+  startTime = source->GetStartTime();
+  fileStepSize = source->GetTime(1) - startTime;
+  endTime = source->GetEndTime();
+
+  // Decimated files record the step they were simulated with
+  simStepSize = fileStepSize;
+  if (source->GetRecordedStepSize() > 0) {
+    simStepSize = source->GetRecordedStepSize();
+  }
+  stride = std::max(1u, (unsigned int)(round(fileStepSize / simStepSize)));
+}
+
+unsigned long rad::TrajectoryInterpolator::GetNSimSteps() const {
+  return (unsigned long)(round((endTime - startTime) / simStepSize)) + 1;
+}
+
+double rad::TrajectoryInterpolator::Gamma(const TVector3 &v) {
+  return 1 / sqrt(1 - v.Mag2() / (TMath::C() * TMath::C()));
+}
+
+rad::TrajectoryInterpolator::Node rad::TrajectoryInterpolator::ReadNode(
+    long long i) {
+  TrajectoryPoint pt;
+  source->GetEntry(size_t(i), pt);
+  Node n;
+  n.time = pt.time;
+  n.pos = pt.pos;
+  n.vel = pt.vel;
+  // The stored acceleration uses the rest mass, so the time derivative of
+  // the velocity is acc / gamma
+  n.dvdt = pt.acc * (1 / Gamma(n.vel));
+  return n;
+}
+
+void rad::TrajectoryInterpolator::LoadInterval(long long i) {
+  if (i == loadedIndex) return;
+  if (i == loadedIndex + 1) {
+    node0 = node1;
+  } else {
+    node0 = ReadNode(i);
+  }
+  node1 = ReadNode(i + 1);
+  loadedIndex = i;
+}
+
+void rad::TrajectoryInterpolator::GetState(double t, TVector3 &pos,
+                                           TVector3 &vel, TVector3 &acc) {
+  // Guess the interval from the file step, then correct for any irregular
+  // spacing such as a shorter final interval
+  long long i{(long long)(std::floor((t - startTime) / fileStepSize))};
+  i = std::clamp(i, 0LL, nEntries - 2);
+  LoadInterval(i);
+  while (i > 0 && t < node0.time) LoadInterval(--i);
+  while (i < nEntries - 2 && t > node1.time) LoadInterval(++i);
+
+  const double h{node1.time - node0.time};
+  const double x{(t - node0.time) / h};
+  pos = QuinticHermite(node0.pos, node0.vel, node0.dvdt, node1.pos, node1.vel,
+                       node1.dvdt, h, x);
+  TVector3 dvdt;
+  CubicHermite(node0.vel, node0.dvdt, node1.vel, node1.dvdt, h, x, vel, dvdt);
+  acc = dvdt * Gamma(vel);
+}
+
+TVector3 rad::TrajectoryInterpolator::QuinticHermite(
+    const TVector3 &p0, const TVector3 &v0, const TVector3 &a0,
+    const TVector3 &p1, const TVector3 &v1, const TVector3 &a1, double h,
+    double x) {
+  const double x2{x * x};
+  const double x3{x2 * x};
+  const double x4{x3 * x};
+  const double x5{x4 * x};
+  return (1 - 10 * x3 + 15 * x4 - 6 * x5) * p0 +
+         (10 * x3 - 15 * x4 + 6 * x5) * p1 +
+         h * ((x - 6 * x3 + 8 * x4 - 3 * x5) * v0 +
+              (-4 * x3 + 7 * x4 - 3 * x5) * v1) +
+         h * h * 0.5 *
+             ((x2 - 3 * x3 + 3 * x4 - x5) * a0 + (x3 - 2 * x4 + x5) * a1);
+}
+
+void rad::TrajectoryInterpolator::CubicHermite(
+    const TVector3 &v0, const TVector3 &a0, const TVector3 &v1,
+    const TVector3 &a1, double h, double x, TVector3 &v, TVector3 &a) {
+  const double x2{x * x};
+  const double x3{x2 * x};
+  v = (2 * x3 - 3 * x2 + 1) * v0 + (-2 * x3 + 3 * x2) * v1 +
+      h * ((x3 - 2 * x2 + x) * a0 + (x3 - x2) * a1);
+  a = ((6 * x2 - 6 * x) * v0 + (-6 * x2 + 6 * x) * v1) * (1 / h) +
+      (3 * x2 - 4 * x + 1) * a0 + (3 * x2 - 2 * x) * a1;
+}
@@ -0,0 +1,137 @@
+/*
+  TrajectoryInterpolator.h
+
+  Reconstructs the electron state at arbitrary times from a trajectory file
+  Positions are quintic Hermite interpolated from the stored positions,
+  velocities and accelerations, and velocities are cubic Hermite interpolated
+  from the stored velocities and accelerations. This allows trajectories to be
+  written out only every few simulation steps and read back at the full
+  simulation step without significant loss of accuracy.
+*/
+
+#ifndef TRAJECTORY_INTERPOLATOR_H
+#define TRAJECTORY_INTERPOLATOR_H
+
+#include <memory>
+
+#include "BasicFunctions/TrajectorySource.h"
+#include "TString.h"
+#include "TVector3.h"
+
+namespace rad {
+class TrajectoryInterpolator {
+ public:
+  /// @brief Parametrised constructor
+  /// @param trajectoryFilePath Path to electron trajectory file
+  TrajectoryInterpolator(TString trajectoryFilePath);
+
+  /// @brief Parametrised constructor
+  /// @param trajectorySource Already opened trajectory
+  TrajectoryInterpolator(std::unique_ptr<TrajectorySource> trajectorySource);
+
+  /// @brief The underlying stored trajectory
+  TrajectorySource &GetSource() { return *source; }
+
+  /// @brief Time of the first stored state [s]
+  double GetStartTime() const { return startTime; }
+
+  /// @brief Time of the last stored state [s]
+  double GetEndTime() const { return endTime; }
+
+  /// @brief Time between the stored states [s]
+  double GetFileStepSize() const { return fileStepSize; }
+
+  /// @brief Step size the trajectory was simulated with [s]. For files
+  /// without a recorded step size this is the time between stored states.
+  double GetSimStepSize() const { return simStepSize; }
+
+  /// @brief Number of simulation steps between stored states
+  unsigned int GetStride() const { return stride; }
+
+  /// @brief Whether the file holds fewer states than were simulated
+  bool IsDecimated() const { return stride > 1; }
+
+  /// @brief Number of points on the simulation step grid between the first
+  /// and last stored states
+  unsigned long GetNSimSteps() const;
+
+  /// @brief Reconstructs the electron state at a given time
+  /// @param t Time in seconds. Times outside the file are extrapolated
+  /// @param pos Set to the electron position [m]
+  /// @param vel Set to the electron velocity [m/s]
+  /// @param acc Set to the electron acceleration [m/s^2], using the same rest
+  /// mass convention as the stored accelerations
+  void GetState(double t, TVector3 &pos, TVector3 &vel, TVector3 &acc);
+
+  /// @brief Quintic Hermite interpolation of the position across a step,
+  /// matching position, velocity and acceleration at both ends
+  /// @param p0 Position at the start of the step
+  /// @param v0 Velocity at the start of the step
+  /// @param a0 Time derivative of the velocity at the start of the step
+  /// @param p1 Position at the end of the step
+  /// @param v1 Velocity at the end of the step
+  /// @param a1 Time derivative of the velocity at the end of the step
+  /// @param h Step length in seconds
+  /// @param x Fraction of the step in [0, 1]
+  /// @return Interpolated position
+  static TVector3 QuinticHermite(const TVector3 &p0, const TVector3 &v0,
+                                 const TVector3 &a0, const TVector3 &p1,
+                                 const TVector3 &v1, const TVector3 &a1,
+                                 double h, double x);
+
+  /// @brief Cubic Hermite interpolation of the velocity across a step. The
+  /// integrated velocities are more accurate than a derivative of the
+  /// interpolated position.
+  /// @param v0 Velocity at the start of the step
+  /// @param a0 Time derivative of the velocity at the start of the step
+  /// @param v1 Velocity at the end of the step
+  /// @param a1 Time derivative of the velocity at the end of the step
+  /// @param h Step length in seconds
+  /// @param x Fraction of the step in [0, 1]
+  /// @param v Set to the interpolated velocity
+  /// @param a Set to the interpolated time derivative of the velocity
+  static void CubicHermite(const TVector3 &v0, const TVector3 &a0,
+                           const TVector3 &v1, const TVector3 &a1, double h,
+                           double x, TVector3 &v, TVector3 &a);
+
+  /// @brief Lorentz factor for a given velocity
+  /// @param v Velocity [m/s]
+  static double Gamma(const TVector3 &v);
+
+ private:
+  /// Stored state with the time derivative of the velocity
+  struct Node {
+    double time;
+    TVector3 pos;
+    TVector3 vel;
+    TVector3 dvdt;
+  };
+
+  std::unique_ptr<TrajectorySource> source;
+
+  long long nEntries{0};
+  double startTime{};
+  double endTime{};
+  double fileStepSize{};
+  double simStepSize{};
+  unsigned int stride{1};
+
+  // Stored states bracketing the last requested time
+  long long loadedIndex{-1};
+  Node node0{};
+  Node node1{};
+
+  /// @brief Reads the file properties from the source
+  void SetUp();
+
+  /// @brief Reads a stored state from the source
+  /// @param i Entry number
+  Node ReadNode(long long i);
+
+  /// @brief Makes node0 and node1 hold entries i and i + 1
+  /// @param i Entry number of the earlier state
+  void LoadInterval(long long i);
+};
+}  // namespace rad
+
+#endif
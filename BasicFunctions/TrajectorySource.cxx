@@ -0,0 +1,293 @@
+// TrajectorySource.cxx
+
+#include "BasicFunctions/TrajectorySource.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "TParameter.h"
+
+namespace {
+constexpr char kTrajectoryMagic[8] = {'R', 'A', 'D', 'T', 'R', 'A', 'J', '\0'};
+constexpr uint32_t kTrajectoryVersion{1};
+
+// Number of states buffered per column when writing
+constexpr size_t kWriteChunk{65536};
+
+// Columns following the header must stay 8 byte aligned
+static_assert(sizeof(rad::TrajectoryFileHeader) % sizeof(double) == 0,
+              "Trajectory header must be a multiple of 8 bytes");
+}  // namespace
+
+double rad::TrajectorySource::GetTime(size_t i) {
+  TrajectoryPoint pt;
+  GetEntry(i, pt);
+  return pt.time;
+}
+
+size_t rad::TrajectorySource::FindEntry(double t) {
+  const size_t n{GetNEntries()};
+  const double t0{GetTime(0)};
+  if (t < t0 || n == 1) return 0;
+
+  // Trajectories are usually evenly spaced, so guess from the first step
+  // and check the guess against its neighbour
+  const double step{GetTime(1) - t0};
+  if (step > 0) {
+    const double guess{std::floor((t - t0) / step)};
+    if (guess < double(n)) {
+      size_t i{size_t(guess)};
+      // Rounding can put the guess one state out
+      if (i > 0 && GetTime(i) > t) i--;
+      if (i + 1 < n && GetTime(i + 1) <= t) i++;
+      if (GetTime(i) <= t && (i + 1 == n || GetTime(i + 1) > t)) return i;
+    }
+  }
+
+  size_t lo{0};
+  size_t hi{n};
+  // Find the first state after t
+  while (lo < hi) {
+    const size_t mid{lo + (hi - lo) / 2};
+    if (GetTime(mid) <= t) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo > 0 ? lo - 1 : 0;
+}
+
+void rad::TrajectorySource::FindRange(double minTime, double maxTime,
+                                      size_t &first, size_t &end) {
+  first = FindEntry(minTime);
+  if (GetTime(first) < minTime) first++;
+  end = FindEntry(maxTime) + 1;
+  if (GetTime(end - 1) > maxTime) end--;
+  if (end < first) end = first;
+}
+
+bool rad::TrajectorySource::Next(TrajectoryPoint &pt) {
+  if (nextEntry >= GetNEntries()) return false;
+  GetEntry(nextEntry, pt);
+  nextEntry++;
+  return true;
+}
+
+std::unique_ptr<rad::TrajectorySource> rad::TrajectorySource::Open(
+    TString filePath) {
+  if (MappedTrajectorySource::IsTrajectoryFile(filePath.Data())) {
+    return std::make_unique<MappedTrajectorySource>(filePath.Data());
+  }
+  return std::make_unique<RootTrajectorySource>(filePath);
+}
+
+rad::RootTrajectorySource::RootTrajectorySource(TString filePath) {
+  inputFile = std::make_unique<TFile>(filePath, "READ");
+  if (!inputFile->IsOpen()) {
+    std::cout << "Couldn't open file! Exiting.\n";
+    exit(1);
+  }
+  inputTree = (TTree *)inputFile->Get("tree");
+  if (!inputTree) {
+    std::cout << "No trajectory tree in " << filePath << ". Exiting.\n";
+    exit(1);
+  }
+  inputTree->SetBranchAddress("time", &time);
+  inputTree->SetBranchAddress("xPos", &xPos);
+  inputTree->SetBranchAddress("yPos", &yPos);
+  inputTree->SetBranchAddress("zPos", &zPos);
+  inputTree->SetBranchAddress("xVel", &xVel);
+  inputTree->SetBranchAddress("yVel", &yVel);
+  inputTree->SetBranchAddress("zVel", &zVel);
+  inputTree->SetBranchAddress("xAcc", &xAcc);
+  inputTree->SetBranchAddress("yAcc", &yAcc);
+  inputTree->SetBranchAddress("zAcc", &zAcc);
+  nEntries = size_t(inputTree->GetEntries());
+  timeBranch = inputTree->GetBranch("time");
+
+  // Every branch is read for each entry
+  inputTree->SetCacheSize(kCacheSize);
+  inputTree->AddBranchToCache("*", true);
+
+  // Written by ElectronTrajectoryGen alongside the tree
+  auto step = inputFile->Get<TParameter<double>>("simStepSize");
+  if (step) recordedStepSize = step->GetVal();
+}
+
+rad::RootTrajectorySource::~RootTrajectorySource() {
+  delete inputTree;
+  inputFile->Close();
+}
+
+void rad::RootTrajectorySource::GetEntry(size_t i, TrajectoryPoint &pt) {
+  inputTree->GetEntry(i);
+  pt.time = time;
+  pt.pos.SetXYZ(xPos, yPos, zPos);
+  pt.vel.SetXYZ(xVel, yVel, zVel);
+  pt.acc.SetXYZ(xAcc, yAcc, zAcc);
+}
+
+double rad::RootTrajectorySource::GetTime(size_t i) {
+  timeBranch->GetEntry(i);
+  return time;
+}
+
+void rad::RootTrajectorySource::PrepareRange(size_t first, size_t end) {
+  if (end <= first) return;
+  inputTree->SetCacheEntryRange(Long64_t(first), Long64_t(end - 1));
+  inputTree->StopCacheLearningPhase();
+}
+
+rad::MappedTrajectorySource::MappedTrajectorySource(std::string filePath) {
+  int fd{open(filePath.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    std::cout << "Unable to open trajectory file " << filePath << ". Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 ||
+      size_t(sb.st_size) < sizeof(TrajectoryFileHeader)) {
+    std::cout << "Trajectory file " << filePath << " is too small. Exiting."
+              << std::endl;
+    close(fd);
+    exit(1);
+  }
+  mappingSize = size_t(sb.st_size);
+
+  mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid once the descriptor is closed
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cout << "Unable to map trajectory file " << filePath << ". Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  header = static_cast<const TrajectoryFileHeader *>(mapping);
+  if (std::memcmp(header->magic, kTrajectoryMagic,
+                  sizeof(kTrajectoryMagic)) != 0 ||
+      header->version != kTrajectoryVersion ||
+      header->nColumns != kNColumns) {
+    std::cout << filePath << " is not a valid trajectory file. Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  const size_t expectedSize{sizeof(TrajectoryFileHeader) +
+                            size_t(header->nEntries) * kNColumns *
+                                sizeof(double)};
+  if (mappingSize < expectedSize || header->nEntries == 0) {
+    std::cout << "Trajectory file " << filePath << " is truncated. Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  arrays = reinterpret_cast<const double *>(
+      static_cast<const char *>(mapping) + sizeof(TrajectoryFileHeader));
+  // States are usually read in order
+  madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+}
+
+rad::MappedTrajectorySource::~MappedTrajectorySource() {
+  if (mapping != 0 && mapping != MAP_FAILED) munmap(mapping, mappingSize);
+}
+
+bool rad::MappedTrajectorySource::IsTrajectoryFile(std::string filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file.is_open()) return false;
+  char magic[sizeof(kTrajectoryMagic)];
+  file.read(magic, sizeof(magic));
+  return file.gcount() == sizeof(magic) &&
+         std::memcmp(magic, kTrajectoryMagic, sizeof(magic)) == 0;
+}
+
+void rad::MappedTrajectorySource::PrepareRange(size_t first, size_t end) {
+  if (end <= first) return;
+  // Each column is a separate block of the mapping
+  const size_t pageSize{size_t(sysconf(_SC_PAGESIZE))};
+  const size_t n{size_t(header->nEntries)};
+  for (size_t c{0}; c < kNColumns; c++) {
+    const char *start{reinterpret_cast<const char *>(arrays + c * n + first)};
+    const char *stop{reinterpret_cast<const char *>(arrays + c * n + end)};
+    char *alignedStart{const_cast<char *>(start) -
+                       (reinterpret_cast<uintptr_t>(start) % pageSize)};
+    madvise(alignedStart, size_t(stop - alignedStart), MADV_WILLNEED);
+  }
+}
+
+void rad::MappedTrajectorySource::GetEntry(size_t i, TrajectoryPoint &pt) {
+  const size_t n{size_t(header->nEntries)};
+  const double *col{arrays + i};
+  pt.time = col[kTime * n];
+  pt.pos.SetXYZ(col[kXPos * n], col[kYPos * n], col[kZPos * n]);
+  pt.vel.SetXYZ(col[kXVel * n], col[kYVel * n], col[kZVel * n]);
+  pt.acc.SetXYZ(col[kXAcc * n], col[kYAcc * n], col[kZAcc * n]);
+}
+
+void rad::WriteColumnarTrajectory(std::string filePath,
+                                  TrajectorySource &source) {
+  const size_t nEntries{source.GetNEntries()};
+  if (nEntries == 0) {
+    std::cout << "No trajectory states to write. Exiting." << std::endl;
+    exit(1);
+  }
+
+  TrajectoryFileHeader header{};
+  std::memcpy(header.magic, kTrajectoryMagic, sizeof(kTrajectoryMagic));
+  header.version = kTrajectoryVersion;
+  header.nColumns = MappedTrajectorySource::kNColumns;
+  header.nEntries = nEntries;
+  header.simStepSize = source.GetRecordedStepSize();
+
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    std::cout << "Unable to create trajectory file " << filePath
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  // Read the source once, buffering a chunk of each column and writing it
+  // to its place in the file
+  constexpr size_t nCols{MappedTrajectorySource::kNColumns};
+  std::array<std::vector<double>, nCols> buffers;
+  for (auto &b : buffers) b.resize(std::min(kWriteChunk, nEntries));
+  TrajectoryPoint pt;
+  source.Seek(0);
+  for (size_t start{0}; start < nEntries; start += kWriteChunk) {
+    const size_t n{std::min(kWriteChunk, nEntries - start)};
+    for (size_t i{0}; i < n; i++) {
+      source.Next(pt);
+      const double values[nCols]{pt.time,    pt.pos.X(), pt.pos.Y(),
+                                 pt.pos.Z(), pt.vel.X(), pt.vel.Y(),
+                                 pt.vel.Z(), pt.acc.X(), pt.acc.Y(),
+                                 pt.acc.Z()};
+      for (size_t c{0}; c < nCols; c++) buffers[c][i] = values[c];
+    }
+    for (size_t c{0}; c < nCols; c++) {
+      file.seekp(std::streamoff(sizeof(header) +
+                                (c * nEntries + start) * sizeof(double)));
+      file.write(reinterpret_cast<const char *>(buffers[c].data()),
+                 std::streamsize(n * sizeof(double)));
+    }
+  }
+
+  if (!file.good()) {
+    std::cout << "Failed writing trajectory file " << filePath
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+}
@@ -0,0 +1,205 @@
+/*
+  TrajectorySource.h
+
+  Format independent read access to electron trajectory files
+  Trajectories are either the ROOT tree written by ElectronTrajectoryGen or a
+  flat columnar binary file. The columnar file is a fixed size header followed
+  by contiguous float64 arrays of time, position, velocity and acceleration.
+  It is read with a single read-only mmap, so each column can be used in place
+  without any copying or deserialisation.
+*/
+
+#ifndef TRAJECTORY_SOURCE_H
+#define TRAJECTORY_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "TBranch.h"
+#include "TFile.h"
+#include "TString.h"
+#include "TTree.h"
+#include "TVector3.h"
+
+namespace rad {
+/// A single electron state from a trajectory
+struct TrajectoryPoint {
+  double time;
+  TVector3 pos;
+  TVector3 vel;
+  TVector3 acc;
+};
+
+/// Read access to a stored electron trajectory
+class TrajectorySource {
+ public:
+  virtual ~TrajectorySource() = default;
+
+  /// @brief Number of stored states
+  virtual size_t GetNEntries() const = 0;
+
+  /// @brief Reads a stored state
+  /// @param i Entry number
+  /// @param pt Set to the stored state
+  virtual void GetEntry(size_t i, TrajectoryPoint &pt) = 0;
+
+  /// @brief Time of a stored state
+  /// @param i Entry number
+  /// @return Time in seconds
+  virtual double GetTime(size_t i);
+
+  /// @brief Step size the trajectory was simulated with, if it was recorded
+  /// @return Step size in seconds, or 0 if not recorded
+  virtual double GetRecordedStepSize() const = 0;
+
+  /// @brief Time of the first stored state [s]
+  double GetStartTime() { return GetTime(0); }
+
+  /// @brief Time of the last stored state [s]
+  double GetEndTime() { return GetTime(GetNEntries() - 1); }
+
+  /// @brief Finds the last stored state at or before a time. The entry is
+  /// computed directly for evenly spaced states, otherwise found by bisection
+  /// @param t Time in seconds
+  /// @return Entry number, 0 if t is before the first state
+  size_t FindEntry(double t);
+
+  /// @brief Finds the range of stored states within a time interval
+  /// @param minTime Earliest time in seconds
+  /// @param maxTime Latest time in seconds
+  /// @param first Set to the first entry at or after minTime
+  /// @param end Set to one past the last entry at or before maxTime
+  void FindRange(double minTime, double maxTime, size_t &first, size_t &end);
+
+  /// @brief Hint that the entries in a range are about to be read in order
+  /// @param first First entry to be read
+  /// @param end One past the last entry to be read
+  virtual void PrepareRange(size_t first, size_t end) {}
+
+  /// @brief Sets the entry that the next call to Next will read
+  /// @param i Entry number
+  void Seek(size_t i) { nextEntry = i; }
+
+  /// @brief Sequential access. Reads the next state
+  /// @param pt Set to the next state
+  /// @return False once all the states have been read
+  bool Next(TrajectoryPoint &pt);
+
+  /// @brief Opens a trajectory file, choosing the backend from its contents
+  /// @param filePath Path to a ROOT or columnar trajectory file
+  static std::unique_ptr<TrajectorySource> Open(TString filePath);
+
+ private:
+  size_t nextEntry{0};
+};
+
+/// Trajectory stored as a ROOT tree
+class RootTrajectorySource : public TrajectorySource {
+ public:
+  /// @brief Parametrised constructor. Exits if the tree cannot be read
+  /// @param filePath Path to the ROOT file
+  RootTrajectorySource(TString filePath);
+
+  /// Destructor
+  ~RootTrajectorySource();
+
+  RootTrajectorySource(const RootTrajectorySource &) = delete;
+  RootTrajectorySource &operator=(const RootTrajectorySource &) = delete;
+
+  size_t GetNEntries() const override { return nEntries; }
+
+  void GetEntry(size_t i, TrajectoryPoint &pt) override;
+
+  double GetTime(size_t i) override;
+
+  double GetRecordedStepSize() const override { return recordedStepSize; }
+
+  /// @brief Sets the tree cache to read ahead over the range
+  void PrepareRange(size_t first, size_t end) override;
+
+ private:
+  // Size of the tree cache for sequential range reads
+  static constexpr Long64_t kCacheSize{64 * 1024 * 1024};
+
+  std::unique_ptr<TFile> inputFile;
+  TTree *inputTree = 0;
+  TBranch *timeBranch = 0;  // Read on its own when searching for times
+  size_t nEntries{0};
+  double recordedStepSize{0};
+
+  // Variables for input tree
+  double time{};
+  double xPos{}, yPos{}, zPos{};
+  double xVel{}, yVel{}, zVel{};
+  double xAcc{}, yAcc{}, zAcc{};
+};
+
+/// On-disk header of a columnar trajectory file
+struct TrajectoryFileHeader {
+  char magic[8];         // "RADTRAJ" followed by a null character
+  uint32_t version;      // Format version
+  uint32_t nColumns;     // Number of columns, always kNColumns
+  uint64_t nEntries;     // Number of stored states
+  double simStepSize;    // Simulation step size in seconds, 0 if unknown
+};
+
+/// Read-only, memory-mapped view of a columnar trajectory file
+class MappedTrajectorySource : public TrajectorySource {
+ public:
+  enum Column_t {
+    kTime,
+    kXPos, kYPos, kZPos,
+    kXVel, kYVel, kZVel,
+    kXAcc, kYAcc, kZAcc,
+    kNColumns
+  };
+
+  /// @brief Parametrised constructor. Exits if the file is not valid
+  /// @param filePath Path to the columnar trajectory file
+  MappedTrajectorySource(std::string filePath);
+
+  /// Destructor, unmaps the file
+  ~MappedTrajectorySource();
+
+  MappedTrajectorySource(const MappedTrajectorySource &) = delete;
+  MappedTrajectorySource &operator=(const MappedTrajectorySource &) = delete;
+
+  /// @brief Checks whether a file starts with the columnar trajectory
+  /// signature
+  /// @param filePath Path to the file
+  static bool IsTrajectoryFile(std::string filePath);
+
+  size_t GetNEntries() const override { return size_t(header->nEntries); }
+
+  void GetEntry(size_t i, TrajectoryPoint &pt) override;
+
+  double GetTime(size_t i) override { return GetColumn(kTime)[i]; }
+
+  double GetRecordedStepSize() const override { return header->simStepSize; }
+
+  /// @brief Asks the kernel to read ahead the mapped range
+  void PrepareRange(size_t first, size_t end) override;
+
+  /// @param c Chosen column
+  /// @return View of the column in the mapped file
+  std::span<const double> GetColumn(Column_t c) const {
+    return {arrays + size_t(c) * header->nEntries, size_t(header->nEntries)};
+  }
+
+ private:
+  void *mapping = 0;
+  size_t mappingSize{0};
+  const TrajectoryFileHeader *header = 0;
+  const double *arrays = 0;
+};
+
+/// @brief Writes any trajectory to the columnar format
+/// @param filePath Output file path
+/// @param source Trajectory to write
+void WriteColumnarTrajectory(std::string filePath, TrajectorySource &source);
+}  // namespace rad
+
+#endif
@@ -8,4 +8,26 @@ double rad::BaseField::evaluate_field_magnitude(TVector3 v) {
 
 double rad::BaseField::evaluate_e_field_magnitude(TVector3 v) {
   return evaluate_e_field_at_point(v).Mag();
-}
\ No newline at end of file
+}
+
+void rad::BaseField::evaluate_field_batch(const double *x, const double *y,
+                                          const double *z, double *bx,
+                                          double *by, double *bz, size_t n) {
+  for (size_t i{0}; i < n; i++) {
+    TVector3 field{evaluate_field_at_point(TVector3(x[i], y[i], z[i]))};
+    bx[i] = field.X();
+    by[i] = field.Y();
+    bz[i] = field.Z();
+  }
+}
+
+void rad::BaseField::evaluate_e_field_batch(const double *x, const double *y,
+                                            const double *z, double *ex,
+                                            double *ey, double *ez, size_t n) {
+  for (size_t i{0}; i < n; i++) {
+    TVector3 field{evaluate_e_field_at_point(TVector3(x[i], y[i], z[i]))};
+    ex[i] = field.X();
+    ey[i] = field.Y();
+    ez[i] = field.Z();
+  }
+}
@@ -8,6 +8,8 @@
 #ifndef BASE_FIELD_H
 #define BASE_FIELD_H
 
+#include <cstddef>
+
 #include "TVector3.h"
 
 namespace rad {
@@ -33,6 +35,32 @@ class BaseField {
   /// @return Magnetic field magnitude in Tesla
   double evaluate_field_magnitude(TVector3 v);
 
+  /// @brief Calculates the magnetic field at a batch of points
+  /// The default implementation loops over evaluate_field_at_point
+  /// @param x Array of x coordinates in metres
+  /// @param y Array of y coordinates in metres
+  /// @param z Array of z coordinates in metres
+  /// @param bx Output array of field x components in tesla
+  /// @param by Output array of field y components in tesla
+  /// @param bz Output array of field z components in tesla
+  /// @param n Number of points
+  virtual void evaluate_field_batch(const double *x, const double *y,
+                                    const double *z, double *bx, double *by,
+                                    double *bz, size_t n);
+
+  /// @brief Calculates the electric field at a batch of points
+  /// The default implementation loops over evaluate_e_field_at_point
+  /// @param x Array of x coordinates in metres
+  /// @param y Array of y coordinates in metres
+  /// @param z Array of z coordinates in metres
+  /// @param ex Output array of field x components in volts/metre
+  /// @param ey Output array of field y components in volts/metre
+  /// @param ez Output array of field z components in volts/metre
+  /// @param n Number of points
+  virtual void evaluate_e_field_batch(const double *x, const double *y,
+                                      const double *z, double *ex, double *ey,
+                                      double *ez, size_t n);
+
   virtual ~BaseField() {}
 };
 
@@ -0,0 +1,321 @@
+/*
+  BorisEnsembleSolver.cxx
+
+  Function implementations for the structure-of-arrays Boris pusher
+*/
+
+#include "ElectronDynamics/BorisEnsembleSolver.h"
+
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include "TFile.h"
+#include "TTree.h"
+
+namespace {
+// Radiation reaction acceleration for one electron, as in
+// BorisSolver::radiation_acceleration
+inline void RadiationAcceleration(double tau, double ox, double oy, double oz,
+                                  double vx, double vy, double vz, double &ax,
+                                  double &ay, double &az) {
+  const double denom{1 + tau * tau * (ox * ox + oy * oy + oz * oz)};
+  ax = (-tau * (oz * oz + oy * oy) * vx + tau * ox * (oz * vz + oy * vy)) /
+       denom;
+  ay = (-tau * (oz * oz + ox * ox) * vy + tau * oy * (oz * vz + ox * vx)) /
+       denom;
+  az = (-tau * (ox * ox + oy * oy) * vz + tau * oz * (ox * vx + oy * vy)) /
+       denom;
+}
+}  // namespace
+
+rad::BorisEnsembleSolver::BorisEnsembleSolver(BaseField *field_v,
+                                              double charge_v, double mass_v,
+                                              double tau_v, double startTime)
+    : field(field_v),
+      charge(charge_v),
+      mass(mass_v),
+      tau(tau_v),
+      simTime(startTime) {}
+
+size_t rad::BorisEnsembleSolver::AddElectron(TVector3 pos, TVector3 vel) {
+  const size_t i{trajectories.size()};
+  xPos.push_back(pos.X());
+  yPos.push_back(pos.Y());
+  zPos.push_back(pos.Z());
+  xVel.push_back(vel.X());
+  yVel.push_back(vel.Y());
+  zVel.push_back(vel.Z());
+
+  // Initial acceleration
+  const TVector3 BField{field->evaluate_field_at_point(pos)};
+  const TVector3 EField{field->evaluate_e_field_at_point(pos)};
+  const double invMass{1.0 / mass};
+  const double ox{charge * BField.X() * invMass};
+  const double oy{charge * BField.Y() * invMass};
+  const double oz{charge * BField.Z() * invMass};
+  double rx{0}, ry{0}, rz{0};
+  RadiationAcceleration(tau, ox, oy, oz, vel.X(), vel.Y(), vel.Z(), rx, ry,
+                        rz);
+  xAcc.push_back(vel.Y() * oz - vel.Z() * oy + rx + charge * EField.X());
+  yAcc.push_back(vel.Z() * ox - vel.X() * oz + ry + charge * EField.Y());
+  zAcc.push_back(vel.X() * oy - vel.Y() * ox + rz + charge * EField.Z());
+
+  laneElectron.push_back(i);
+  electronLane.push_back(i);
+  // Move the new electron in front of any escaped ones
+  SwapLanes(nActive, i);
+  nActive++;
+
+  trajectories.emplace_back();
+  if (trajStride > 0) RecordLane(electronLane[i]);
+
+  // Keep the scratch arrays the same size as the state
+  for (auto *v : {&xHalf, &yHalf, &zHalf, &ex, &ey, &ez, &bx, &by, &bz,
+                  &cosTheta, &sinTheta}) {
+    v->resize(xPos.size());
+  }
+  escaped.resize(xPos.size());
+  return i;
+}
+
+void rad::BorisEnsembleSolver::SetEscapeCylinder(double rMax, double zMax) {
+  escapeR = rMax;
+  escapeZ = zMax;
+}
+
+void rad::BorisEnsembleSolver::SetTrajectoryStride(unsigned int stride) {
+  trajStride = stride;
+}
+
+TVector3 rad::BorisEnsembleSolver::GetPosition(size_t i) const {
+  const size_t l{electronLane[i]};
+  return TVector3(xPos[l], yPos[l], zPos[l]);
+}
+
+TVector3 rad::BorisEnsembleSolver::GetVelocity(size_t i) const {
+  const size_t l{electronLane[i]};
+  return TVector3(xVel[l], yVel[l], zVel[l]);
+}
+
+TVector3 rad::BorisEnsembleSolver::GetAcceleration(size_t i) const {
+  const size_t l{electronLane[i]};
+  return TVector3(xAcc[l], yAcc[l], zAcc[l]);
+}
+
+void rad::BorisEnsembleSolver::SwapLanes(size_t a, size_t b) {
+  if (a == b) return;
+  for (auto *v : {&xPos, &yPos, &zPos, &xVel, &yVel, &zVel, &xAcc, &yAcc,
+                  &zAcc}) {
+    std::swap((*v)[a], (*v)[b]);
+  }
+  std::swap(laneElectron[a], laneElectron[b]);
+  electronLane[laneElectron[a]] = a;
+  electronLane[laneElectron[b]] = b;
+}
+
+void rad::BorisEnsembleSolver::AdvanceStep(double timeStep) {
+  // Only the active lanes, which are kept at the front, are pushed
+  const size_t n{nActive};
+  const double c2{TMath::C() * TMath::C()};
+  const double halfStep{timeStep / 2.0};
+  const double invMass{1.0 / mass};
+  const double kick{timeStep * charge / (2 * mass)};
+  const double rrScale{mass / charge};
+
+  // Half position step
+  for (size_t i{0}; i < n; i++) {
+    xHalf[i] = xPos[i] + xVel[i] * halfStep;
+    yHalf[i] = yPos[i] + yVel[i] * halfStep;
+    zHalf[i] = zPos[i] + zVel[i] * halfStep;
+  }
+
+  // Fields at the half step, evaluated once for all electrons
+  field->evaluate_e_field_batch(xHalf.data(), yHalf.data(), zHalf.data(),
+                                ex.data(), ey.data(), ez.data(), n);
+  field->evaluate_field_batch(xHalf.data(), yHalf.data(), zHalf.data(),
+                              bx.data(), by.data(), bz.data(), n);
+
+  // Rotation angle
+  for (size_t i{0}; i < n; i++) {
+    const double v2{xVel[i] * xVel[i] + yVel[i] * yVel[i] + zVel[i] * zVel[i]};
+    const double gamma_n{1 / sqrt(1 - v2 / c2)};
+    const double ux{xVel[i] * gamma_n};
+    const double uy{yVel[i] * gamma_n};
+    const double uz{zVel[i] * gamma_n};
+    const double u2{ux * ux + uy * uy + uz * uz};
+    const double gamma_minus{sqrt(1.0 + u2 / c2)};
+    const double bMag{sqrt(bx[i] * bx[i] + by[i] * by[i] + bz[i] * bz[i])};
+    cosTheta[i] = charge * timeStep / (mass * gamma_minus) * bMag;
+  }
+  for (size_t i{0}; i < n; i++) {
+    const double theta{cosTheta[i]};
+    cosTheta[i] = cos(theta);
+    sinTheta[i] = sin(theta);
+  }
+
+  // Velocity update and second half position step
+  for (size_t i{0}; i < n; i++) {
+    const double v2{xVel[i] * xVel[i] + yVel[i] * yVel[i] + zVel[i] * zVel[i]};
+    const double gamma_n{1 / sqrt(1 - v2 / c2)};
+    const double ux{xVel[i] * gamma_n};
+    const double uy{yVel[i] * gamma_n};
+    const double uz{zVel[i] * gamma_n};
+
+    const double ox{charge * bx[i] * invMass};
+    const double oy{charge * by[i] * invMass};
+    const double oz{charge * bz[i] * invMass};
+
+    // First half of the Coulomb force
+    double rx{0}, ry{0}, rz{0};
+    RadiationAcceleration(tau, ox, oy, oz, ux, uy, uz, rx, ry, rz);
+    const double umx{ux + kick * (ex[i] + rx * rrScale)};
+    const double umy{uy + kick * (ey[i] + ry * rrScale)};
+    const double umz{uz + kick * (ez[i] + rz * rrScale)};
+
+    // Rotation about the field direction
+    const double b2{bx[i] * bx[i] + by[i] * by[i] + bz[i] * bz[i]};
+    const double bNorm{b2 > 0.0 ? 1.0 / sqrt(b2) : 1.0};
+    const double bhx{bx[i] * bNorm};
+    const double bhy{by[i] * bNorm};
+    const double bhz{bz[i] * bNorm};
+    const double uDotB{umx * bhx + umy * bhy + umz * bhz};
+    const double upx{uDotB * bhx};
+    const double upy{uDotB * bhy};
+    const double upz{uDotB * bhz};
+    const double uplx{upx + (umx - upx) * cosTheta[i] +
+                      (umy * bhz - umz * bhy) * sinTheta[i]};
+    const double uply{upy + (umy - upy) * cosTheta[i] +
+                      (umz * bhx - umx * bhz) * sinTheta[i]};
+    const double uplz{upz + (umz - upz) * cosTheta[i] +
+                      (umx * bhy - umy * bhx) * sinTheta[i]};
+
+    // Second half of the Coulomb force
+    RadiationAcceleration(tau, ox, oy, oz, uplx, uply, uplz, rx, ry, rz);
+    const double u1x{uplx + kick * (ex[i] + rx * rrScale)};
+    const double u1y{uply + kick * (ey[i] + ry * rrScale)};
+    const double u1z{uplz + kick * (ez[i] + rz * rrScale)};
+
+    const double u1Mag{sqrt(u1x * u1x + u1y * u1y + u1z * u1z)};
+    const double gamma_nplus1{
+        sqrt(1 + (u1Mag / TMath::C()) * (u1Mag / TMath::C()))};
+    const double invGamma{1 / gamma_nplus1};
+    const double v1x{u1x * invGamma};
+    const double v1y{u1y * invGamma};
+    const double v1z{u1z * invGamma};
+    xVel[i] = v1x;
+    yVel[i] = v1y;
+    zVel[i] = v1z;
+    xPos[i] = xHalf[i] + v1x * halfStep;
+    yPos[i] = yHalf[i] + v1y * halfStep;
+    zPos[i] = zHalf[i] + v1z * halfStep;
+  }
+
+  // Acceleration at the new positions
+  field->evaluate_e_field_batch(xPos.data(), yPos.data(), zPos.data(),
+                                ex.data(), ey.data(), ez.data(), n);
+  field->evaluate_field_batch(xPos.data(), yPos.data(), zPos.data(), bx.data(),
+                              by.data(), bz.data(), n);
+  for (size_t i{0}; i < n; i++) {
+    const double ox{charge * bx[i] * invMass};
+    const double oy{charge * by[i] * invMass};
+    const double oz{charge * bz[i] * invMass};
+    double rx{0}, ry{0}, rz{0};
+    RadiationAcceleration(tau, ox, oy, oz, xVel[i], yVel[i], zVel[i], rx, ry,
+                          rz);
+    xAcc[i] = yVel[i] * oz - zVel[i] * oy + rx + charge * ex[i];
+    yAcc[i] = zVel[i] * ox - xVel[i] * oz + ry + charge * ey[i];
+    zAcc[i] = xVel[i] * oy - yVel[i] * ox + rz + charge * ez[i];
+  }
+
+  simTime += timeStep;
+  nStepsTaken++;
+  if (trajStride > 0 && nStepsTaken % trajStride == 0) RecordStates();
+
+  // Flag electrons which have left the trap
+  if (escapeR <= 0 || escapeZ <= 0) return;
+  const double r2Max{escapeR * escapeR};
+  size_t nEscaped{0};
+  for (size_t i{0}; i < n; i++) {
+    const double r2{xPos[i] * xPos[i] + yPos[i] * yPos[i]};
+    escaped[i] = r2 > r2Max || std::abs(zPos[i]) > escapeZ;
+    nEscaped += escaped[i];
+  }
+  if (nEscaped == 0) return;
+
+  // Move escaped electrons behind the active ones. Their states are frozen
+  // from here on.
+  size_t i{0};
+  while (i < nActive) {
+    if (escaped[i]) {
+      nActive--;
+      SwapLanes(i, nActive);
+      escaped[i] = escaped[nActive];
+    } else {
+      i++;
+    }
+  }
+}
+
+void rad::BorisEnsembleSolver::Advance(double timeStep, unsigned long nSteps) {
+  for (unsigned long iStep{0}; iStep < nSteps; iStep++) {
+    if (nActive == 0) break;
+    AdvanceStep(timeStep);
+  }
+}
+
+void rad::BorisEnsembleSolver::RecordStates() {
+  for (size_t l{0}; l < nActive; l++) RecordLane(l);
+}
+
+void rad::BorisEnsembleSolver::RecordLane(size_t l) {
+  Trajectory &traj{trajectories[laneElectron[l]]};
+  traj.time.push_back(simTime);
+  traj.xPos.push_back(xPos[l]);
+  traj.yPos.push_back(yPos[l]);
+  traj.zPos.push_back(zPos[l]);
+  traj.xVel.push_back(xVel[l]);
+  traj.yVel.push_back(yVel[l]);
+  traj.zVel.push_back(zVel[l]);
+  traj.xAcc.push_back(xAcc[l]);
+  traj.yAcc.push_back(yAcc[l]);
+  traj.zAcc.push_back(zAcc[l]);
+}
+
+void rad::BorisEnsembleSolver::WriteTrajectory(size_t i,
+                                               TString outputFile) const {
+  auto fout = std::make_unique<TFile>(outputFile, "RECREATE");
+  TTree *tree = new TTree("tree", "tree");
+  double time{};
+  double xP{}, yP{}, zP{};
+  double xV{}, yV{}, zV{};
+  double xA{}, yA{}, zA{};
+  tree->Branch("time", &time);
+  tree->Branch("xPos", &xP);
+  tree->Branch("yPos", &yP);
+  tree->Branch("zPos", &zP);
+  tree->Branch("xVel", &xV);
+  tree->Branch("yVel", &yV);
+  tree->Branch("zVel", &zV);
+  tree->Branch("xAcc", &xA);
+  tree->Branch("yAcc", &yA);
+  tree->Branch("zAcc", &zA);
+
+  const Trajectory &traj{trajectories[i]};
+  for (size_t j{0}; j < traj.time.size(); j++) {
+    time = traj.time[j];
+    xP = traj.xPos[j];
+    yP = traj.yPos[j];
+    zP = traj.zPos[j];
+    xV = traj.xVel[j];
+    yV = traj.yVel[j];
+    zV = traj.zVel[j];
+    xA = traj.xAcc[j];
+    yA = traj.yAcc[j];
+    zA = traj.zAcc[j];
+    tree->Fill();
+  }
+  fout->cd();
+  tree->Write("", TObject::kOverwrite);
+  fout->Close();
+}
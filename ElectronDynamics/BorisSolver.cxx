@@ -27,7 +27,11 @@ TVector3 rad::BorisSolver::get_omega(const TVector3 pos) {
 
 TVector3 rad::BorisSolver::radiation_acceleration(const TVector3 pos,
                                                   const TVector3 vel) {
-  TVector3 omega = get_omega(pos);
+  return radiation_acceleration_omega(get_omega(pos), vel);
+}
+
+TVector3 rad::BorisSolver::radiation_acceleration_omega(const TVector3 omega,
+                                                        const TVector3 vel) {
   double denom = 1 + tau * tau * omega.Dot(omega);
   double accX = 0;
   double accY = 0;
@@ -47,16 +51,24 @@ TVector3 rad::BorisSolver::radiation_acceleration(const TVector3 pos,
 }
 
 TVector3 rad::BorisSolver::acc(const TVector3 pos, const TVector3 vel) {
-  TVector3 omega = get_omega(pos);
+  return acc_from_fields(calc_b_field(pos), calc_e_field(pos), vel);
+}
+
+TVector3 rad::BorisSolver::acc_from_fields(const TVector3 BField,
+                                           const TVector3 EField,
+                                           const TVector3 vel) {
+  TVector3 omega = calculate_omega(BField, charge, 0.0, mass);
 
   // Lorentz force
   TVector3 acc = vel.Cross(omega);
 
   // Add Larmor terms
-  acc += radiation_acceleration(pos, vel);
+  acc += radiation_acceleration_omega(omega, vel);
 
-  // Acceleration from electric field
-  acc += charge * calc_e_field(pos);
+  // Acceleration from electric field. Part of the work done goes into
+  // gamma rather than the velocity.
+  const double c2{TMath::C() * TMath::C()};
+  acc += (charge / mass) * (EField - vel * (vel.Dot(EField) / c2));
 
   return acc;
 }
@@ -71,24 +83,29 @@ std::tuple<TVector3, TVector3> rad::BorisSolver::advance_step(
   // Half position step
   TVector3 x_nplushalf{x_n + v_n * (time_step / 2.0)};
 
-  // Do the first half of the Coloumb force
+  // Fields at the half step, shared by the Coulomb, rotation and radiation
+  // reaction terms
   TVector3 E_nplushalf{calc_e_field(x_nplushalf)};
-  TVector3 E_tot_minus{E_nplushalf + radiation_acceleration(x_nplushalf, u_n) *
-                                         (mass / charge)};
+  TVector3 B_nplushalf{calc_b_field(x_nplushalf)};
+  TVector3 omega_nplushalf{calculate_omega(B_nplushalf, charge, 0.0, mass)};
+
+  // Do the first half of the Coloumb force
+  TVector3 E_tot_minus{
+      E_nplushalf +
+      radiation_acceleration_omega(omega_nplushalf, u_n) * (mass / charge)};
   TVector3 u_minus{u_n + (time_step * charge / (2 * mass)) * E_tot_minus};
   double gamma_minus{sqrt(1.0 + u_n.Dot(u_n) / pow(TMath::C(), 2))};
 
   // Rotation step
-  TVector3 B_nplushalf{calc_b_field(x_nplushalf)};
   double theta{charge * time_step / (mass * gamma_minus) * B_nplushalf.Mag()};
   TVector3 u_minus_par{u_minus.Dot(B_nplushalf.Unit()) * B_nplushalf.Unit()};
   TVector3 u_plus{u_minus_par + (u_minus - u_minus_par) * cos(theta) +
                   (u_minus.Cross(B_nplushalf.Unit())) * sin(theta)};
 
   // Second half of the Coulomb force
-  TVector3 E_tot_plus{E_nplushalf +
-                      radiation_acceleration(x_nplushalf, u_plus) *
-                          (mass / charge)};
+  TVector3 E_tot_plus{
+      E_nplushalf +
+      radiation_acceleration_omega(omega_nplushalf, u_plus) * (mass / charge)};
   TVector3 u_nplus1{u_plus + (time_step * charge / (2 * mass)) * E_tot_plus};
 
   // Now update position
@@ -99,6 +116,14 @@ std::tuple<TVector3, TVector3> rad::BorisSolver::advance_step(
   return std::make_tuple(x_nplus1, v_nplus1);
 }
 
+std::tuple<TVector3, TVector3, TVector3>
+rad::BorisSolver::advance_step_with_acc(const double time_step,
+                                        const TVector3 x0, const TVector3 v0) {
+  auto [x_nplus1, v_nplus1] = advance_step(time_step, x0, v0);
+  TVector3 a_nplus1{acc(x_nplus1, v_nplus1)};
+  return std::make_tuple(x_nplus1, v_nplus1, a_nplus1);
+}
+
 TVector3 rad::BorisSolver::calc_b_field(TVector3 pos) {
   return (field->evaluate_field_at_point(pos));
 }
@@ -34,6 +34,13 @@ class BorisSolver {
   /// \Returns a 3-vector of the acceleration from the RR force
   TVector3 radiation_acceleration(const TVector3 pos, const TVector3 vel);
 
+  /// Calculate radiation acceleration from a precomputed omega
+  /// \param omega Cyclotron angular velocity vector at the charge position
+  /// \param vel Velocity of the charge
+  /// \Returns a 3-vector of the acceleration from the RR force
+  TVector3 radiation_acceleration_omega(const TVector3 omega,
+                                        const TVector3 vel);
+
   /// @brief Returns the B field at the position
   /// @param pos Electron position
   /// @return Magnetic field vector in Tesla
@@ -66,11 +73,32 @@ class BorisSolver {
                                               const TVector3 x0,
                                               const TVector3 v0);
 
+  /// Advances position and velocity vector by a set time and calculates the
+  /// acceleration at the new position. The fields are evaluated once at the
+  /// half step point and once at the end point.
+  /// \param time_step The time step over which to advance the charge's motion
+  /// \param x0 Vector of the charge's starting position
+  /// \param v0 Vector of the charge's starting velocity
+  /// \returns Tuple containing (1) the output position vector, (2) the
+  /// output velocity vector and (3) the acceleration vector at the output
+  /// position
+  std::tuple<TVector3, TVector3, TVector3> advance_step_with_acc(
+      const double time_step, const TVector3 x0, const TVector3 v0);
+
   /// Calculate acceleration due to B field and RR force
   /// \param pos Position of the charge
   /// \param vec Velocity of the charge
   /// \returns a 3-vector of the acceleration
   TVector3 acc(const TVector3 pos, const TVector3 vel);
+
+  /// Calculate acceleration from precomputed fields. Like acc, this uses the
+  /// rest mass, so the time derivative of the velocity is acc / gamma
+  /// \param BField Magnetic field at the charge position
+  /// \param EField Electric field at the charge position
+  /// \param vel Velocity of the charge
+  /// \returns a 3-vector of the acceleration
+  TVector3 acc_from_fields(const TVector3 BField, const TVector3 EField,
+                           const TVector3 vel);
 };
 }  // namespace rad
 
@@ -0,0 +1,390 @@
+/// CachedAxisymmetricField.cxx
+
+#include "ElectronDynamics/CachedAxisymmetricField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr char kCacheMagic[8] = {'R', 'A', 'D', 'F', 'C', 'A', 'C', 'H'};
+constexpr uint32_t kCacheVersion{2};
+
+// Number of z blocks used when refining adaptively
+constexpr unsigned int kAdaptiveBlocks{16};
+// Nodes in each dimension of a block before any refinement
+constexpr unsigned int kInitialNodes{9};
+// The error is only sampled half way between nodes, so refine to a fraction
+// of the tolerance to allow for larger errors elsewhere in the cells
+constexpr double kToleranceMargin{0.5};
+// Refinement stops once a block would exceed this many nodes
+constexpr size_t kMaxBlockNodes{size_t(1) << 20};
+
+// Fractions of the cylinder at which the wrapped field is sampled to
+// identify it. Chosen away from the axis and mid-plane, where components
+// vanish by symmetry
+constexpr double kFingerprintFractions[3]{0.19, 0.53, 0.87};
+constexpr unsigned int kFingerprintPoints{9};
+// Loaded fingerprints may differ from the field by this fraction of the
+// tolerance, allowing for rounding differences between builds
+constexpr double kFingerprintMargin{0.01};
+
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t nBlocks;
+  double rMax;
+  double zMin;
+  double zMax;
+  double tolerance;
+  uint32_t adaptive;
+  uint32_t padding;
+  double maxError;
+  double fingerprint[2 * kFingerprintPoints];  // (Br, Bz) at the sample points
+};
+
+/// Samples (Br, Bz) of an axisymmetric field at points on the +x axis
+void SampleField(rad::BaseField *field, const std::vector<double> &r,
+                 const std::vector<double> &z, std::vector<double> &br,
+                 std::vector<double> &bz) {
+  const size_t n{r.size()};
+  std::vector<double> y(n, 0.0);
+  std::vector<double> by(n);
+  br.resize(n);
+  bz.resize(n);
+  field->evaluate_field_batch(r.data(), y.data(), z.data(), br.data(),
+                              by.data(), bz.data(), n);
+}
+
+/// (Br, Bz) of a field at fixed fractions of the tabulated cylinder,
+/// used to tell whether a saved table was made from the same field
+void FieldFingerprint(rad::BaseField *field, double rMax, double zMin,
+                      double zMax, double *fingerprint) {
+  std::vector<double> r;
+  std::vector<double> z;
+  for (double fr : kFingerprintFractions) {
+    for (double fz : kFingerprintFractions) {
+      r.push_back(fr * rMax);
+      z.push_back(zMin + fz * (zMax - zMin));
+    }
+  }
+  std::vector<double> br;
+  std::vector<double> bz;
+  SampleField(field, r, z, br, bz);
+  for (unsigned int i{0}; i < kFingerprintPoints; i++) {
+    fingerprint[2 * i] = br[i];
+    fingerprint[2 * i + 1] = bz[i];
+  }
+}
+
+/// Largest deviation of either tabulated component from the field
+double MaxGridError(rad::BaseField *field, const rad::RZFieldGrid &brGrid,
+                    const rad::RZFieldGrid &bzGrid,
+                    const std::vector<double> &r,
+                    const std::vector<double> &z) {
+  std::vector<double> br;
+  std::vector<double> bz;
+  SampleField(field, r, z, br, bz);
+  double err{0};
+  for (size_t i{0}; i < r.size(); i++) {
+    err = std::max(err, std::abs(brGrid.Interpolate(r[i], z[i]) - br[i]));
+    err = std::max(err, std::abs(bzGrid.Interpolate(r[i], z[i]) - bz[i]));
+  }
+  return err;
+}
+}  // namespace
+
+rad::CachedAxisymmetricField::CachedAxisymmetricField(
+    BaseField *field, double rMax, double zMin, double zMax, double tolerance,
+    bool adaptive, std::string cacheFile)
+    : baseField(field),
+      rMax(rMax),
+      zMin(zMin),
+      zMax(zMax),
+      tol(tolerance),
+      isAdaptive(adaptive) {
+  if (rMax <= 0 || zMax <= zMin || tolerance <= 0) {
+    std::cout << "Invalid field table dimensions or tolerance. Exiting.\n";
+    exit(1);
+  }
+
+  nBlocks = isAdaptive ? kAdaptiveBlocks : 1;
+  blockWidth = (zMax - zMin) / double(nBlocks);
+
+  if (!cacheFile.empty() && Load(cacheFile)) {
+    std::cout << "Loaded field table from " << cacheFile << " ("
+              << GetNNodes() << " nodes)\n";
+    return;
+  }
+
+  for (unsigned int iBlock{0}; iBlock < nBlocks; iBlock++) {
+    const double zLo{zMin + blockWidth * double(iBlock)};
+    const double zHi{iBlock == nBlocks - 1 ? zMax : zLo + blockWidth};
+    maxError = std::max(maxError, TabulateBlock(zLo, zHi));
+  }
+  std::cout << "Tabulated field with " << GetNNodes() << " nodes in "
+            << nBlocks << " blocks, max error = " << maxError << " T\n";
+
+  if (!cacheFile.empty()) Save(cacheFile);
+}
+
+double rad::CachedAxisymmetricField::TabulateBlock(double zLo, double zHi) {
+  unsigned int nR{kInitialNodes};
+  unsigned int nZ{kInitialNodes};
+
+  while (true) {
+    // Pad the grid by one node on each side so the bicubic stencil is never
+    // clamped inside the block. The nodes at negative r sample the field on
+    // the -x axis, giving the odd continuation of Br and even one of Bz.
+    const unsigned int nRPad{nR + 2};
+    const unsigned int nZPad{nZ + 2};
+    const double dr{rMax / double(nR - 1)};
+    const double dz{(zHi - zLo) / double(nZ - 1)};
+
+    // Nodes, r varying fastest
+    std::vector<double> r(size_t(nRPad) * nZPad);
+    std::vector<double> z(size_t(nRPad) * nZPad);
+    for (unsigned int iz{0}; iz < nZPad; iz++) {
+      for (unsigned int ir{0}; ir < nRPad; ir++) {
+        r[size_t(iz) * nRPad + ir] = dr * (double(ir) - 1.0);
+        z[size_t(iz) * nRPad + ir] = zLo + dz * (double(iz) - 1.0);
+      }
+    }
+    std::vector<double> br;
+    std::vector<double> bz;
+    SampleField(baseField, r, z, br, bz);
+    RZFieldGrid brGrid{MakeBlockGrid(zLo, zHi, nRPad, nZPad, std::move(br))};
+    RZFieldGrid bzGrid{MakeBlockGrid(zLo, zHi, nRPad, nZPad, std::move(bz))};
+
+    // Check the error half way between nodes in r, in z and in both
+    std::vector<double> rTest;
+    std::vector<double> zTest;
+    for (unsigned int iz{0}; iz < nZ; iz++) {
+      for (unsigned int ir{0}; ir + 1 < nR; ir++) {
+        rTest.push_back(dr * (double(ir) + 0.5));
+        zTest.push_back(zLo + dz * double(iz));
+      }
+    }
+    const double errR{MaxGridError(baseField, brGrid, bzGrid, rTest, zTest)};
+
+    rTest.clear();
+    zTest.clear();
+    for (unsigned int iz{0}; iz + 1 < nZ; iz++) {
+      for (unsigned int ir{0}; ir < nR; ir++) {
+        rTest.push_back(dr * double(ir));
+        zTest.push_back(zLo + dz * (double(iz) + 0.5));
+      }
+    }
+    const double errZ{MaxGridError(baseField, brGrid, bzGrid, rTest, zTest)};
+
+    rTest.clear();
+    zTest.clear();
+    for (unsigned int iz{0}; iz + 1 < nZ; iz++) {
+      for (unsigned int ir{0}; ir + 1 < nR; ir++) {
+        rTest.push_back(dr * (double(ir) + 0.5));
+        zTest.push_back(zLo + dz * (double(iz) + 0.5));
+      }
+    }
+    const double errC{MaxGridError(baseField, brGrid, bzGrid, rTest, zTest)};
+
+    const double err{std::max({errR, errZ, errC})};
+    const double target{kToleranceMargin * tol};
+    bool refineR{errR > target};
+    bool refineZ{errZ > target};
+    if (!refineR && !refineZ && errC > target) refineR = refineZ = true;
+
+    const size_t nextNodes{size_t(refineR ? 2 * nR + 1 : nRPad) *
+                           size_t(refineZ ? 2 * nZ + 1 : nZPad)};
+    if ((!refineR && !refineZ) || nextNodes > kMaxBlockNodes) {
+      if (refineR || refineZ) {
+        std::cout << "Field table block z = [" << zLo << ", " << zHi
+                  << "] reached the node limit with error " << err << " T\n";
+      }
+      brBlocks.push_back(brGrid);
+      bzBlocks.push_back(bzGrid);
+      return err;
+    }
+
+    // Halving the spacing keeps the existing nodes
+    if (refineR) nR = 2 * nR - 1;
+    if (refineZ) nZ = 2 * nZ - 1;
+  }
+}
+
+rad::RZFieldGrid rad::CachedAxisymmetricField::MakeBlockGrid(
+    double zLo, double zHi, unsigned int nRPad, unsigned int nZPad,
+    std::vector<double> values) const {
+  const double dr{rMax / double(nRPad - 3)};
+  const double dz{(zHi - zLo) / double(nZPad - 3)};
+  return RZFieldGrid(-dr, rMax + dr, nRPad, zLo - dz, zHi + dz, nZPad,
+                     std::move(values), RZFieldGrid::kBicubic);
+}
+
+size_t rad::CachedAxisymmetricField::GetNNodes() const {
+  size_t nNodes{0};
+  for (const auto &grid : brBlocks) {
+    nNodes += size_t(grid.GetNR()) * grid.GetNZ();
+  }
+  return nNodes;
+}
+
+void rad::CachedAxisymmetricField::InterpolateTables(double r, double z,
+                                                     double &br,
+                                                     double &bz) const {
+  const int iBlock{std::clamp(int(std::floor((z - zMin) / blockWidth)), 0,
+                              int(nBlocks) - 1)};
+  br = brBlocks[iBlock].Interpolate(r, z);
+  bz = bzBlocks[iBlock].Interpolate(r, z);
+}
+
+TVector3 rad::CachedAxisymmetricField::evaluate_field_at_point(
+    const TVector3 vec) {
+  const double r{vec.Perp()};
+  if (!IsInside(r, vec.Z())) return baseField->evaluate_field_at_point(vec);
+
+  double br{0};
+  double bz{0};
+  InterpolateTables(r, vec.Z(), br, bz);
+  if (r == 0) return TVector3(0, 0, bz);
+  return TVector3(br * vec.X() / r, br * vec.Y() / r, bz);
+}
+
+TVector3 rad::CachedAxisymmetricField::evaluate_e_field_at_point(TVector3 v) {
+  return baseField->evaluate_e_field_at_point(v);
+}
+
+void rad::CachedAxisymmetricField::evaluate_field_batch(
+    const double *x, const double *y, const double *z, double *bx, double *by,
+    double *bz, size_t n) {
+  for (size_t i{0}; i < n; i++) {
+    const double r{sqrt(x[i] * x[i] + y[i] * y[i])};
+    if (!IsInside(r, z[i])) {
+      TVector3 field{
+          baseField->evaluate_field_at_point(TVector3(x[i], y[i], z[i]))};
+      bx[i] = field.X();
+      by[i] = field.Y();
+      bz[i] = field.Z();
+      continue;
+    }
+
+    double br{0};
+    InterpolateTables(r, z[i], br, bz[i]);
+    bx[i] = r == 0 ? 0.0 : br * x[i] / r;
+    by[i] = r == 0 ? 0.0 : br * y[i] / r;
+  }
+}
+
+void rad::CachedAxisymmetricField::evaluate_e_field_batch(
+    const double *x, const double *y, const double *z, double *ex, double *ey,
+    double *ez, size_t n) {
+  baseField->evaluate_e_field_batch(x, y, z, ex, ey, ez, n);
+}
+
+void rad::CachedAxisymmetricField::Save(std::string filePath) const {
+  CacheHeader header{};
+  std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.version = kCacheVersion;
+  header.nBlocks = nBlocks;
+  header.rMax = rMax;
+  header.zMin = zMin;
+  header.zMax = zMax;
+  header.tolerance = tol;
+  header.adaptive = isAdaptive ? 1 : 0;
+  header.maxError = maxError;
+  FieldFingerprint(baseField, rMax, zMin, zMax, header.fingerprint);
+
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    std::cout << "Unable to create field table file " << filePath
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (unsigned int iBlock{0}; iBlock < nBlocks; iBlock++) {
+    const uint32_t dims[2]{brBlocks[iBlock].GetNR(), brBlocks[iBlock].GetNZ()};
+    file.write(reinterpret_cast<const char *>(dims), sizeof(dims));
+    for (const auto *grid : {&brBlocks[iBlock], &bzBlocks[iBlock]}) {
+      for (uint32_t iz{0}; iz < dims[1]; iz++) {
+        for (uint32_t ir{0}; ir < dims[0]; ir++) {
+          const double value{grid->GetNodeValue(ir, iz)};
+          file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+      }
+    }
+  }
+  if (!file.good()) {
+    std::cout << "Failed writing field table file " << filePath
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+}
+
+bool rad::CachedAxisymmetricField::Load(std::string filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file.is_open()) return false;
+
+  CacheHeader header{};
+  file.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!file.good() ||
+      std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+      header.version != kCacheVersion) {
+    std::cout << filePath << " is not a field table, it will be overwritten\n";
+    return false;
+  }
+  if (header.nBlocks != nBlocks || header.rMax != rMax ||
+      header.zMin != zMin || header.zMax != zMax || header.tolerance != tol ||
+      header.adaptive != (isAdaptive ? 1u : 0u)) {
+    std::cout << "Field table " << filePath
+              << " was made with different parameters, retabulating\n";
+    return false;
+  }
+  double fingerprint[2 * kFingerprintPoints];
+  FieldFingerprint(baseField, rMax, zMin, zMax, fingerprint);
+  for (unsigned int i{0}; i < 2 * kFingerprintPoints; i++) {
+    if (std::abs(fingerprint[i] - header.fingerprint[i]) >
+        kFingerprintMargin * tol) {
+      std::cout << "Field table " << filePath
+                << " was made from a different field, retabulating\n";
+      return false;
+    }
+  }
+
+  std::vector<RZFieldGrid> brLoaded;
+  std::vector<RZFieldGrid> bzLoaded;
+  for (unsigned int iBlock{0}; iBlock < nBlocks; iBlock++) {
+    const double zLo{zMin + blockWidth * double(iBlock)};
+    const double zHi{iBlock == nBlocks - 1 ? zMax : zLo + blockWidth};
+
+    uint32_t dims[2]{0, 0};
+    file.read(reinterpret_cast<char *>(dims), sizeof(dims));
+    const size_t nNodes{size_t(dims[0]) * dims[1]};
+    if (!file.good() || dims[0] < 4 || dims[1] < 4 ||
+        nNodes > kMaxBlockNodes) {
+      std::cout << "Field table " << filePath << " is corrupt, retabulating\n";
+      return false;
+    }
+    std::vector<double> br(nNodes);
+    std::vector<double> bz(nNodes);
+    file.read(reinterpret_cast<char *>(br.data()), nNodes * sizeof(double));
+    file.read(reinterpret_cast<char *>(bz.data()), nNodes * sizeof(double));
+    if (!file.good()) {
+      std::cout << "Field table " << filePath
+                << " is truncated, retabulating\n";
+      return false;
+    }
+    brLoaded.push_back(
+        MakeBlockGrid(zLo, zHi, dims[0], dims[1], std::move(br)));
+    bzLoaded.push_back(
+        MakeBlockGrid(zLo, zHi, dims[0], dims[1], std::move(bz)));
+  }
+
+  brBlocks = std::move(brLoaded);
+  bzBlocks = std::move(bzLoaded);
+  maxError = header.maxError;
+  return true;
+}
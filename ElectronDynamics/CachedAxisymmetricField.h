@@ -0,0 +1,130 @@
+/*
+  CachedAxisymmetricField.h
+
+  Decorator serving an axisymmetric field from (Br, Bz) tables on an (r, z)
+  grid rather than recomputing the full field expression at every point.
+  The z range is split into blocks, each refined until the interpolation error
+  is within a set tolerance, so that steep regions (e.g. near trap coils) get
+  finer grids than the flat regions between them.
+*/
+
+#ifndef CACHED_AXISYMMETRIC_FIELD_H
+#define CACHED_AXISYMMETRIC_FIELD_H
+
+#include <string>
+#include <vector>
+
+#include "ElectronDynamics/BaseField.h"
+#include "ElectronDynamics/RZFieldGrid.h"
+#include "TVector3.h"
+
+namespace rad {
+class CachedAxisymmetricField : public BaseField {
+ public:
+  /// @brief Parametrised constructor. Tabulates the field, or loads a
+  /// previously saved table if one matching the parameters exists.
+  /// @param field Field to tabulate. Must be axisymmetric about the z axis
+  /// and outlive this object
+  /// @param rMax Radius of the tabulated cylinder [m]
+  /// @param zMin Lower z limit of the tabulated cylinder [m]
+  /// @param zMax Upper z limit of the tabulated cylinder [m]
+  /// @param tolerance Maximum interpolation error of each component [T]
+  /// @param adaptive Refine each z block independently. If false a single
+  /// uniform grid is refined until the whole cylinder meets the tolerance
+  /// @param cacheFile Table file to load from, or save to after tabulating.
+  /// Nothing is saved or loaded if empty
+  CachedAxisymmetricField(BaseField *field, double rMax, double zMin,
+                          double zMax, double tolerance, bool adaptive = true,
+                          std::string cacheFile = "");
+
+  /// @brief Calculate B field at a point
+  /// Points outside the tabulated cylinder are passed to the wrapped field
+  /// @param vec Position vector [m]
+  /// @return B field vector [T]
+  TVector3 evaluate_field_at_point(const TVector3 vec) override;
+
+  /// @brief Calculate E field at a point, passed to the wrapped field
+  /// @param v Position vector [m]
+  /// @return E field vector [V/m]
+  TVector3 evaluate_e_field_at_point(TVector3 v) override;
+
+  /// @brief Calculate B field at a batch of points
+  /// @param x Array of x coordinates [m]
+  /// @param y Array of y coordinates [m]
+  /// @param z Array of z coordinates [m]
+  /// @param bx Output array of field x components [T]
+  /// @param by Output array of field y components [T]
+  /// @param bz Output array of field z components [T]
+  /// @param n Number of points
+  void evaluate_field_batch(const double *x, const double *y, const double *z,
+                            double *bx, double *by, double *bz,
+                            size_t n) override;
+
+  /// @brief Calculate E field at a batch of points, passed to the wrapped field
+  void evaluate_e_field_batch(const double *x, const double *y,
+                              const double *z, double *ex, double *ey,
+                              double *ez, size_t n) override;
+
+  /// @brief Writes the tables to disk
+  /// @param filePath Output file path
+  void Save(std::string filePath) const;
+
+  /// @brief Number of z blocks in the table
+  unsigned int GetNBlocks() const { return nBlocks; }
+
+  /// @brief Total number of (r, z) nodes across all blocks
+  size_t GetNNodes() const;
+
+  /// @brief Largest interpolation error found when tabulating [T]
+  double GetMaxError() const { return maxError; }
+
+ private:
+  BaseField *baseField = 0;
+  double rMax;
+  double zMin;
+  double zMax;
+  double tol;
+  bool isAdaptive;
+
+  unsigned int nBlocks;
+  double blockWidth;
+  std::vector<RZFieldGrid> brBlocks;
+  std::vector<RZFieldGrid> bzBlocks;
+  double maxError{0};
+
+  /// @brief Samples one z block, refining until it meets the tolerance
+  /// @param zLo Lower z edge of the block [m]
+  /// @param zHi Upper z edge of the block [m]
+  /// @return Largest interpolation error of the final grid [T]
+  double TabulateBlock(double zLo, double zHi);
+
+  /// @brief Builds the grid for one block including its padding nodes
+  /// @param zLo Lower z edge of the block [m]
+  /// @param zHi Upper z edge of the block [m]
+  /// @param nRPad Number of r nodes including one padding node either side
+  /// @param nZPad Number of z nodes including one padding node either side
+  /// @param values Node values, r varying fastest
+  RZFieldGrid MakeBlockGrid(double zLo, double zHi, unsigned int nRPad,
+                            unsigned int nZPad,
+                            std::vector<double> values) const;
+
+  /// @brief Loads tables from disk
+  /// @param filePath Table file path
+  /// @return True if the file exists, matches the requested parameters and
+  /// was made from a field agreeing with the wrapped one at a few fixed points
+  bool Load(std::string filePath);
+
+  bool IsInside(double r, double z) const {
+    return r <= rMax && z >= zMin && z <= zMax;
+  }
+
+  /// @brief Interpolates the tables at a point inside the cylinder
+  /// @param r Radial coordinate [m]
+  /// @param z Axial coordinate [m]
+  /// @param br Set to the radial field component [T]
+  /// @param bz Set to the axial field component [T]
+  void InterpolateTables(double r, double z, double &br, double &bz) const;
+};
+}  // namespace rad
+
+#endif
@@ -5,144 +5,195 @@
 #include "TGraph2D.h"
 #include "TVector3.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <iostream>
+#include <vector>
 
-rad::ComsolField::ComsolField(std::string fieldFile, double centralField)
+namespace
 {
-    fieldValues = new TGraph2D();
-
-    // Need to read in field data first of all
-    std::ifstream file110mm(fieldFile);
-    if (file110mm.is_open())
+    /// Samples a COMSOL map (x = z, y = r) onto a regular grid covering the
+    /// extent of the map nodes and reports the error at those nodes
+    std::unique_ptr<rad::RZFieldGrid> ResampleFieldMap(TGraph2D *gr, double rSpacing,
+                                                       double zSpacing,
+                                                       rad::RZFieldGrid::Interp_t interp,
+                                                       rad::RZFieldGrid::GridError &err)
     {
-        std::string line;
-        int nLines{0};
-        int ix{1};
-        int iy{1};
+        if (rSpacing <= 0 || zSpacing <= 0)
+        {
+            std::cout << "Invalid grid spacing (" << rSpacing << ", " << zSpacing
+                      << "). Exiting." << std::endl;
+            exit(1);
+        }
 
-        // Read in line by line
-        while (std::getline(file110mm, line))
+        const double rMin{gr->GetYmin()};
+        const double rMax{gr->GetYmax()};
+        const double zMin{gr->GetXmin()};
+        const double zMax{gr->GetXmax()};
+        const unsigned int nR{(unsigned int)(std::round((rMax - rMin) / rSpacing)) + 1};
+        const unsigned int nZ{(unsigned int)(std::round((zMax - zMin) / zSpacing)) + 1};
+
+        // Keep samples a hair inside the convex hull, where the Delaunay
+        // interpolation returns zero
+        const double rEps{1e-9 * (rMax - rMin)};
+        const double zEps{1e-9 * (zMax - zMin)};
+
+        std::vector<double> values(size_t(nR) * size_t(nZ));
+        for (unsigned int iz{0}; iz < nZ; iz++)
         {
-            nLines++;
-            // Exclude the lines containing the headers and stuff
-            if (nLines >= 10)
+            double z{zMin + (zMax - zMin) * double(iz) / double(nZ - 1)};
+            z = std::min(std::max(z, zMin + zEps), zMax - zEps);
+            for (unsigned int ir{0}; ir < nR; ir++)
             {
-                std::stringstream ss{line};
-                std::string r;
-                std::string z;
-                std::string magB;
-                std::getline(ss, r, ',');
-                std::getline(ss, z, ',');
-                std::getline(ss, magB, ',');
-                double magBDouble{std::stod(magB)};
-                double zDouble{std::stod(z)};
-                double rDouble{std::stod(r)};
-                // Convert from mm to m
-                zDouble *= 1e-3;
-                rDouble *= 1e-3;
-                fieldValues->SetPoint(fieldValues->GetN(),
-                                      zDouble, rDouble, magBDouble);
+                double r{rMin + (rMax - rMin) * double(ir) / double(nR - 1)};
+                r = std::min(std::max(r, rMin + rEps), rMax - rEps);
+                values[size_t(iz) * nR + ir] = gr->Interpolate(z, r);
             }
         }
 
-        if (centralField == 0.0)
+        auto grid = std::make_unique<rad::RZFieldGrid>(rMin, rMax, nR, zMin, zMax,
+                                                       nZ, std::move(values), interp);
+        err = grid->CompareToPoints(gr->GetN(), gr->GetY(), gr->GetX(), gr->GetZ());
+        std::cout << "Resampled field map onto " << nR << " x " << nZ
+                  << " (r, z) grid. Error at " << err.nPoints
+                  << " map nodes: max = " << err.maxAbsError
+                  << " T, rms = " << err.rmsError
+                  << " T, max relative = " << err.maxRelError << std::endl;
+        return grid;
+    }
+}
+
+rad::ComsolFieldMap::ComsolFieldMap(std::string fieldFile)
+{
+    if (MappedFieldMap::IsFieldMapFile(fieldFile))
+    {
+        // Binary map, no parsing required
+        mappedFile = std::make_unique<MappedFieldMap>(fieldFile);
+        if (mappedFile->IsRegularGrid())
         {
-            scaleFactor = 1.0;
+            // Evaluate directly from the mapped nodes
+            const FieldMapHeader &header{mappedFile->GetHeader()};
+            grid = std::make_unique<RZFieldGrid>(header.rMin, header.rMax, header.nR,
+                                                 header.zMin, header.zMax, header.nZ,
+                                                 mappedFile->GetComponent(0),
+                                                 RZFieldGrid::kBilinear);
         }
         else
         {
-            std::cout<<centralField<<std::endl;
-            //std::cout<<evaluate_field_at_point(TVector3(0.01, 0.01, 0.01)).Mag()<<std::endl;
-            //scaleFactor = centralField / evaluate_field_at_point(TVector3(0, 0.0001, 0.0001)).Mag();
-            scaleFactor = centralField;
+            BuildGraphFromMappedFile();
         }
-        std::cout<<"Scale factor is "<<scaleFactor<<std::endl;
     }
     else
     {
-        std::cout << "Unable to open field map file. Exiting." << std::endl;
-        exit(1);
+        std::vector<double> r;
+        std::vector<double> z;
+        std::vector<double> magB;
+        ReadComsolCSV(fieldFile, r, z, magB);
+        fieldValues = new TGraph2D(int(r.size()), z.data(), r.data(), magB.data());
     }
 }
 
-TVector3 rad::ComsolField::evaluate_field_at_point(const TVector3 vec)
+rad::ComsolFieldMap::~ComsolFieldMap()
 {
-    double r{vec.Perp()};
-    double z{vec.Z()};
-    // Consider B field to only be in z direction
-
-    return TVector3(0, 0, scaleFactor * fieldValues->Interpolate(z, r));
+    delete fieldValues;
 }
 
-rad::ComsolField::~ComsolField()
+void rad::ComsolFieldMap::BuildGraphFromMappedFile()
 {
-    delete fieldValues;
+    // TGraph2D takes non-const arrays but copies them
+    const size_t nPoints{mappedFile->GetNPoints()};
+    std::vector<double> r(mappedFile->GetR(), mappedFile->GetR() + nPoints);
+    std::vector<double> z(mappedFile->GetZ(), mappedFile->GetZ() + nPoints);
+    std::vector<double> magB(mappedFile->GetComponent(0),
+                             mappedFile->GetComponent(0) + nPoints);
+    fieldValues = new TGraph2D(int(nPoints), z.data(), r.data(), magB.data());
 }
 
-rad::ComsolHarmonicField::ComsolHarmonicField(double radius, double current,
-                                              std::string fieldFile, double centralField)
+double rad::ComsolFieldMap::Evaluate(double r, double z)
 {
-    fieldValues = new TGraph2D();
+    if (grid)
+        return grid->Interpolate(r, z);
 
-    // Need to read in field data first of all
-    std::ifstream file110mm(fieldFile);
-    if (file110mm.is_open())
-    {
-        std::string line;
-        int nLines{0};
-        int ix{1};
-        int iy{1};
+    return fieldValues->Interpolate(z, r);
+}
 
-        // Read in line by line
-        while (std::getline(file110mm, line))
+rad::RZFieldGrid::GridError rad::ComsolFieldMap::UseRegularGrid(double rSpacing,
+                                                                double zSpacing,
+                                                                RZFieldGrid::Interp_t interp)
+{
+    if (mappedFile && mappedFile->IsRegularGrid())
+    {
+        // A binary map already on the requested grid is used in place
+        const FieldMapHeader &header{mappedFile->GetHeader()};
+        const double mapRSpacing{(header.rMax - header.rMin) / double(header.nR - 1)};
+        const double mapZSpacing{(header.zMax - header.zMin) / double(header.nZ - 1)};
+        if (std::abs(mapRSpacing - rSpacing) <= 1e-6 * rSpacing &&
+            std::abs(mapZSpacing - zSpacing) <= 1e-6 * zSpacing)
         {
-            nLines++;
-            // Exclude the lines containing the headers and stuff
-            if (nLines >= 10)
-            {
-                std::stringstream ss{line};
-                std::string r;
-                std::string z;
-                std::string magB;
-                std::getline(ss, r, ',');
-                std::getline(ss, z, ',');
-                std::getline(ss, magB, ',');
-                double magBDouble{std::stod(magB)};
-                double zDouble{std::stod(z)};
-                double rDouble{std::stod(r)};
-                // Convert from mm to m
-                zDouble *= 1e-3;
-                rDouble *= 1e-3;
-                fieldValues->SetPoint(fieldValues->GetN(),
-                                      zDouble, rDouble, magBDouble);
-            }
+            grid = std::make_unique<RZFieldGrid>(header.rMin, header.rMax, header.nR,
+                                                 header.zMin, header.zMax, header.nZ,
+                                                 mappedFile->GetComponent(0), interp);
+            std::cout << "Using the " << header.nR << " x " << header.nZ
+                      << " (r, z) grid of the field map directly" << std::endl;
+            // The grid nodes are the map nodes
+            return RZFieldGrid::GridError{0, 0, 0, (unsigned int)(header.nPoints)};
         }
+    }
 
-        if (centralField == 0.0)
-        {
-            scaleFactor = 1.0;
-        }
-        else
-        {
-            // scaleFactor = centralField / evaluate_field_at_point(TVector3(0, 0, 0)).Mag();
-            scaleFactor = centralField;
-        }
+    // Resampling is done from the original scattered nodes
+    if (!fieldValues)
+        BuildGraphFromMappedFile();
+
+    RZFieldGrid::GridError err;
+    grid = ResampleFieldMap(fieldValues, rSpacing, zSpacing, interp, err);
+    return err;
+}
+
+rad::ComsolField::ComsolField(std::string fieldFile, double centralField)
+    : fieldMap(fieldFile)
+{
+    if (centralField == 0.0)
+    {
+        scaleFactor = 1.0;
     }
     else
     {
-        std::cout << "Unable to open field map file. Exiting." << std::endl;
-        exit(1);
+        std::cout << centralField << std::endl;
+        scaleFactor = centralField;
     }
+    std::cout << "Scale factor is " << scaleFactor << std::endl;
+}
 
-    coil = CoilField(radius, current, 0.0, MU0);
+TVector3 rad::ComsolField::evaluate_field_at_point(const TVector3 vec)
+{
+    double r{vec.Perp()};
+    double z{vec.Z()};
+    // Consider B field to only be in z direction
+    return TVector3(0, 0, scaleFactor * fieldMap.Evaluate(r, z));
 }
 
-rad::ComsolHarmonicField::~ComsolHarmonicField()
+rad::RZFieldGrid::GridError rad::ComsolField::UseRegularGrid(double rSpacing,
+                                                             double zSpacing,
+                                                             RZFieldGrid::Interp_t interp)
 {
-    delete fieldValues;
+    return fieldMap.UseRegularGrid(rSpacing, zSpacing, interp);
+}
+
+rad::ComsolHarmonicField::ComsolHarmonicField(double radius, double current,
+                                              std::string fieldFile, double centralField)
+    : fieldMap(fieldFile)
+{
+    if (centralField == 0.0)
+    {
+        scaleFactor = 1.0;
+    }
+    else
+    {
+        scaleFactor = centralField;
+    }
+
+    coil = CoilField(radius, current, 0.0, MU0);
 }
 
 TVector3 rad::ComsolHarmonicField::evaluate_field_at_point(const TVector3 vec)
@@ -151,5 +202,12 @@ TVector3 rad::ComsolHarmonicField::evaluate_field_at_point(const TVector3 vec)
     double z{vec.Z()};
     // Consider B field to only be in z direction
     TVector3 coilBField = coil.evaluate_field_at_point(vec);
-    return TVector3(0, 0, scaleFactor * fieldValues->Interpolate(z, r)) - coilBField;
-}
\ No newline at end of file
+    return TVector3(0, 0, scaleFactor * fieldMap.Evaluate(r, z)) - coilBField;
+}
+
+rad::RZFieldGrid::GridError rad::ComsolHarmonicField::UseRegularGrid(double rSpacing,
+                                                                     double zSpacing,
+                                                                     RZFieldGrid::Interp_t interp)
+{
+    return fieldMap.UseRegularGrid(rSpacing, zSpacing, interp);
+}
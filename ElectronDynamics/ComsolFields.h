@@ -10,33 +10,80 @@
 #ifndef COMSOL_FIELDS_H
 #define COMSOL_FIELDS_H
 
+#include <memory>
 #include <string>
 
 #include "ElectronDynamics/BaseField.h"
+#include "ElectronDynamics/FieldMapFile.h"
 #include "ElectronDynamics/QTNMFields.h"
+#include "ElectronDynamics/RZFieldGrid.h"
 #include "TGraph2D.h"
 #include "TVector3.h"
 
 namespace rad {
-class ComsolField : public BaseField {
+/// Field magnitude map shared by the COMSOL field classes
+/// Loaded either from a COMSOL CSV export or from a binary field map file
+class ComsolFieldMap {
  private:
   TGraph2D *fieldValues = 0;
+  std::unique_ptr<MappedFieldMap> mappedFile;
+  std::unique_ptr<RZFieldGrid> grid;
+
+  /// Builds the scattered point interpolation from the mapped arrays
+  void BuildGraphFromMappedFile();
+
+ public:
+  /// Parametrised constructor
+  /// \param fieldFile CSV or binary field map file path
+  ComsolFieldMap(std::string fieldFile);
+
+  /// Destructor
+  ~ComsolFieldMap();
+
+  ComsolFieldMap(const ComsolFieldMap &) = delete;
+  ComsolFieldMap &operator=(const ComsolFieldMap &) = delete;
+
+  /// Field magnitude at a point
+  /// \param r Radial coordinate (units of metres)
+  /// \param z Axial coordinate (units of metres)
+  /// \return Field magnitude (units of tesla)
+  double Evaluate(double r, double z);
+
+  /// Resamples the field map onto a uniform (r, z) grid
+  /// \param rSpacing Grid spacing in r (units of metres)
+  /// \param zSpacing Grid spacing in z (units of metres)
+  /// \param interp Interpolation scheme used on the grid
+  /// \return Interpolation error of the grid at the original map nodes
+  RZFieldGrid::GridError UseRegularGrid(double rSpacing, double zSpacing,
+                                        RZFieldGrid::Interp_t interp);
+};
+
+class ComsolField : public BaseField {
+ private:
+  ComsolFieldMap fieldMap;
   double scaleFactor;
 
  public:
   /// Parametrised constructor
-  /// \param fieldFile CSV file path
+  /// \param fieldFile CSV or binary field map file path
   /// \param centralField The desired central magnetic field
   ComsolField(std::string fieldFile, double centralField = 0.0);
 
-  /// Destructor
-  ~ComsolField() override;
-
   /// Calculates the magnetic field at a point in space
   /// \param vec The position vector (units of metres)
   /// \return The magnetic field vector (units of tesla)
   TVector3 evaluate_field_at_point(const TVector3 vec) override;
 
+  /// Resamples the field map onto a uniform (r, z) grid
+  /// Subsequent evaluations use the grid rather than the Delaunay interpolation
+  /// \param rSpacing Grid spacing in r (units of metres)
+  /// \param zSpacing Grid spacing in z (units of metres)
+  /// \param interp Interpolation scheme used on the grid
+  /// \return Interpolation error of the grid at the original map nodes
+  RZFieldGrid::GridError UseRegularGrid(
+      double rSpacing, double zSpacing,
+      RZFieldGrid::Interp_t interp = RZFieldGrid::kBicubic);
+
   /// @brief Calculate electric field at a point
   /// @param v Position at which to calculate field
   /// @return Electric field = 0
@@ -48,24 +95,31 @@ class ComsolField : public BaseField {
 class ComsolHarmonicField : public BaseField {
  private:
   CoilField coil;
-  TGraph2D *fieldValues = 0;
+  ComsolFieldMap fieldMap;
   double scaleFactor;
 
  public:
   /// Parametrised constructor
-  /// \param fieldFile CSV file path
+  /// \param fieldFile CSV or binary field map file path
   /// \param centralField The desired central magnetic field
   ComsolHarmonicField(double radius, double current, std::string fieldFile,
                       double centralField = 0.0);
 
-  /// Destructor
-  ~ComsolHarmonicField() override;
-
   /// Calculates the magnetic field at a point in space
   /// \param vec The position vector (units of metres)
   /// \return The magnetic field vector (units of tesla)
   TVector3 evaluate_field_at_point(const TVector3 vec) override;
 
+  /// Resamples the field map onto a uniform (r, z) grid
+  /// Subsequent evaluations use the grid rather than the Delaunay interpolation
+  /// \param rSpacing Grid spacing in r (units of metres)
+  /// \param zSpacing Grid spacing in z (units of metres)
+  /// \param interp Interpolation scheme used on the grid
+  /// \return Interpolation error of the grid at the original map nodes
+  RZFieldGrid::GridError UseRegularGrid(
+      double rSpacing, double zSpacing,
+      RZFieldGrid::Interp_t interp = RZFieldGrid::kBicubic);
+
   /// @brief Calculate electric field at a point
   /// @param v Position at which to calculate field
   /// @return Electric field = 0
@@ -0,0 +1,223 @@
+/// FieldMapFile.cxx
+
+#include "ElectronDynamics/FieldMapFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr char kFieldMapMagic[8] = {'R', 'A', 'D', 'F', 'M', 'A', 'P', '\0'};
+constexpr uint32_t kFieldMapVersion{3};
+// Version 1 files have the same layout
+constexpr uint32_t kLegacyFieldMapVersion{1};
+
+// Arrays following the header must stay 8 byte aligned
+static_assert(sizeof(rad::FieldMapHeader) % sizeof(double) == 0,
+              "Field map header must be a multiple of 8 bytes");
+}  // namespace
+
+rad::MappedFieldMap::MappedFieldMap(std::string filePath) {
+  int fd{open(filePath.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    std::cout << "Unable to open field map file " << filePath << ". Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 || size_t(sb.st_size) < sizeof(FieldMapHeader)) {
+    std::cout << "Field map file " << filePath << " is too small. Exiting."
+              << std::endl;
+    close(fd);
+    exit(1);
+  }
+  mappingSize = size_t(sb.st_size);
+
+  mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid once the descriptor is closed
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cout << "Unable to map field map file " << filePath << ". Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  header = static_cast<const FieldMapHeader *>(mapping);
+  if (std::memcmp(header->magic, kFieldMapMagic, sizeof(kFieldMapMagic)) != 0) {
+    std::cout << filePath << " is not a valid field map file. Exiting."
+              << std::endl;
+    exit(1);
+  }
+  if (header->version != kFieldMapVersion &&
+      header->version != kLegacyFieldMapVersion) {
+    std::cout << "Field map file " << filePath << " has format version "
+              << header->version << " but version " << kFieldMapVersion
+              << " is required. Convert the map again. Exiting." << std::endl;
+    exit(1);
+  }
+
+  const size_t expectedSize{sizeof(FieldMapHeader) +
+                            size_t(header->nPoints) *
+                                (2 + header->nComponents) * sizeof(double)};
+  if (mappingSize < expectedSize) {
+    std::cout << "Field map file " << filePath << " is truncated. Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  if (header->lengthUnit != 1.0 || header->fieldUnit != 1.0) {
+    std::cout << "Field map file " << filePath << " is stored in units of "
+              << header->lengthUnit << " m and " << header->fieldUnit
+              << " T, but metres and tesla are required. Exiting."
+              << std::endl;
+    exit(1);
+  }
+
+  arrays = reinterpret_cast<const double *>(
+      static_cast<const char *>(mapping) + sizeof(FieldMapHeader));
+}
+
+rad::MappedFieldMap::~MappedFieldMap() {
+  if (mapping != 0 && mapping != MAP_FAILED) munmap(mapping, mappingSize);
+}
+
+bool rad::MappedFieldMap::IsFieldMapFile(std::string filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file.is_open()) return false;
+  char magic[sizeof(kFieldMapMagic)];
+  file.read(magic, sizeof(magic));
+  return file.gcount() == sizeof(magic) &&
+         std::memcmp(magic, kFieldMapMagic, sizeof(magic)) == 0;
+}
+
+const double *rad::MappedFieldMap::GetComponent(unsigned int i) const {
+  if (i >= header->nComponents) {
+    std::cout << "Requested field map component " << i << " but only "
+              << header->nComponents << " exist. Exiting." << std::endl;
+    exit(1);
+  }
+  return arrays + (2 + size_t(i)) * header->nPoints;
+}
+
+void rad::ReadComsolCSV(std::string filePath, std::vector<double> &r,
+                        std::vector<double> &z, std::vector<double> &magB) {
+  std::ifstream file(filePath);
+  if (!file.is_open()) {
+    std::cout << "Unable to open field map file. Exiting." << std::endl;
+    exit(1);
+  }
+
+  r.clear();
+  z.clear();
+  magB.clear();
+
+  std::string line;
+  int nLines{0};
+  // Read in line by line
+  while (std::getline(file, line)) {
+    nLines++;
+    // Exclude the lines containing the headers and stuff
+    if (nLines < 10) continue;
+
+    std::stringstream ss{line};
+    std::string rStr;
+    std::string zStr;
+    std::string magBStr;
+    std::getline(ss, rStr, ',');
+    std::getline(ss, zStr, ',');
+    std::getline(ss, magBStr, ',');
+    // Convert from mm to m
+    r.push_back(std::stod(rStr) * 1e-3);
+    z.push_back(std::stod(zStr) * 1e-3);
+    magB.push_back(std::stod(magBStr));
+  }
+}
+
+void rad::WriteFieldMap(std::string filePath, const std::vector<double> &r,
+                        const std::vector<double> &z,
+                        const std::vector<std::vector<double>> &components) {
+  const size_t nPoints{r.size()};
+  if (z.size() != nPoints || nPoints == 0) {
+    std::cout << "Invalid field map coordinates. Exiting." << std::endl;
+    exit(1);
+  }
+  for (const auto &comp : components) {
+    if (comp.size() != nPoints) {
+      std::cout << "Field map component size does not match coordinates. "
+                   "Exiting."
+                << std::endl;
+      exit(1);
+    }
+  }
+
+  FieldMapHeader header{};
+  std::memcpy(header.magic, kFieldMapMagic, sizeof(kFieldMapMagic));
+  header.version = kFieldMapVersion;
+  header.nComponents = uint32_t(components.size());
+  header.nPoints = nPoints;
+  header.rMin = *std::min_element(r.begin(), r.end());
+  header.rMax = *std::max_element(r.begin(), r.end());
+  header.zMin = *std::min_element(z.begin(), z.end());
+  header.zMax = *std::max_element(z.begin(), z.end());
+  header.lengthUnit = 1.0;
+  header.fieldUnit = 1.0;
+
+  // Detect a complete regular grid with r varying fastest
+  size_t nR{0};
+  while (nR < nPoints && z[nR] == z[0]) nR++;
+  const size_t nZ{nR > 0 ? nPoints / nR : 0};
+  bool isRegular{nR > 1 && nZ > 1 && nR * nZ == nPoints};
+  if (isRegular) {
+    const double dr{(header.rMax - header.rMin) / double(nR - 1)};
+    const double dz{(header.zMax - header.zMin) / double(nZ - 1)};
+    for (size_t i{0}; i < nPoints && isRegular; i++) {
+      const double rExpected{header.rMin + dr * double(i % nR)};
+      const double zExpected{header.zMin + dz * double(i / nR)};
+      isRegular = std::abs(r[i] - rExpected) < 1e-6 * dr &&
+                  std::abs(z[i] - zExpected) < 1e-6 * dz;
+    }
+  }
+  header.nR = isRegular ? uint32_t(nR) : 0;
+  header.nZ = isRegular ? uint32_t(nZ) : 0;
+
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    std::cout << "Unable to create field map file " << filePath
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(r.data()),
+             nPoints * sizeof(double));
+  file.write(reinterpret_cast<const char *>(z.data()),
+             nPoints * sizeof(double));
+  for (const auto &comp : components) {
+    file.write(reinterpret_cast<const char *>(comp.data()),
+               nPoints * sizeof(double));
+  }
+  if (!file.good()) {
+    std::cout << "Failed writing field map file " << filePath << ". Exiting."
+              << std::endl;
+    exit(1);
+  }
+}
+
+void rad::ConvertComsolCSVToBinary(std::string csvPath,
+                                   std::string binaryPath) {
+  std::vector<double> r;
+  std::vector<double> z;
+  std::vector<double> magB;
+  ReadComsolCSV(csvPath, r, z, magB);
+  WriteFieldMap(binaryPath, r, z, {magB});
+}
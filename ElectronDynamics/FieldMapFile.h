@@ -0,0 +1,107 @@
+/*
+  FieldMapFile.h
+
+  Compact binary format for axisymmetric (r, z) field maps.
+  A fixed size header is followed by contiguous float64 arrays of r, z and then
+  each stored field component. The header records the units of the arrays,
+  which must be metres and tesla so the arrays can be used directly from the
+  mapping. Files are read with a single read-only mmap so that concurrent jobs
+  on a node share the page cache.
+*/
+
+#ifndef FIELD_MAP_FILE_H
+#define FIELD_MAP_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rad {
+/// On-disk header of a binary field map
+struct FieldMapHeader {
+  char magic[8];           // "RADFMAP" followed by a null character
+  uint32_t version;        // Format version
+  uint32_t nComponents;    // Number of field arrays following r and z
+  uint64_t nPoints;        // Number of map nodes
+  uint32_t nR;             // Number of regular grid nodes in r (0 if scattered)
+  uint32_t nZ;             // Number of regular grid nodes in z (0 if scattered)
+  double rMin;             // Extent of the map in metres
+  double rMax;
+  double zMin;
+  double zMax;
+  double lengthUnit;       // Metres per stored length unit
+  double fieldUnit;        // Tesla per stored field unit
+};
+
+/// Read-only, memory-mapped view of a binary field map
+class MappedFieldMap {
+ public:
+  /// @brief Parametrised constructor. Exits if the file is not a valid map
+  /// @param filePath Path to the binary field map
+  MappedFieldMap(std::string filePath);
+
+  /// Destructor, unmaps the file
+  ~MappedFieldMap();
+
+  MappedFieldMap(const MappedFieldMap &) = delete;
+  MappedFieldMap &operator=(const MappedFieldMap &) = delete;
+
+  /// @brief Checks whether a file starts with the binary field map signature
+  /// @param filePath Path to the file
+  static bool IsFieldMapFile(std::string filePath);
+
+  const FieldMapHeader &GetHeader() const { return *header; }
+
+  size_t GetNPoints() const { return size_t(header->nPoints); }
+
+  unsigned int GetNComponents() const { return header->nComponents; }
+
+  /// @brief Are the nodes a complete regular grid with r varying fastest
+  bool IsRegularGrid() const {
+    return header->nR > 1 && header->nZ > 1 &&
+           uint64_t(header->nR) * header->nZ == header->nPoints;
+  }
+
+  /// @return Radial coordinates of the nodes [m]
+  const double *GetR() const { return arrays; }
+
+  /// @return Axial coordinates of the nodes [m]
+  const double *GetZ() const { return arrays + header->nPoints; }
+
+  /// @param i Component index
+  /// @return Values of the chosen field component at the nodes [T]
+  const double *GetComponent(unsigned int i) const;
+
+ private:
+  void *mapping = 0;
+  size_t mappingSize{0};
+  const FieldMapHeader *header = 0;
+  const double *arrays = 0;
+};
+
+/// @brief Reads a COMSOL CSV export of an axisymmetric field map
+/// @param filePath Path to the CSV file
+/// @param r Filled with the radial coordinates in metres
+/// @param z Filled with the axial coordinates in metres
+/// @param magB Filled with the field magnitude in tesla
+void ReadComsolCSV(std::string filePath, std::vector<double> &r,
+                   std::vector<double> &z, std::vector<double> &magB);
+
+/// @brief Writes a binary field map, detecting whether the nodes form a
+/// regular grid (r varying fastest)
+/// @param filePath Output file path
+/// @param r Radial node coordinates in metres
+/// @param z Axial node coordinates in metres
+/// @param components Field component values in tesla, one vector per component
+void WriteFieldMap(std::string filePath, const std::vector<double> &r,
+                   const std::vector<double> &z,
+                   const std::vector<std::vector<double>> &components);
+
+/// @brief Converts a COMSOL CSV export to the binary field map format
+/// @param csvPath Path to the input CSV file
+/// @param binaryPath Path to the output binary file
+void ConvertComsolCSVToBinary(std::string csvPath, std::string binaryPath);
+}  // namespace rad
+
+#endif
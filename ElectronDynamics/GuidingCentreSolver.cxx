@@ -0,0 +1,338 @@
+/*
+  GuidingCentreSolver.cxx
+
+  Function implementations for the guiding centre integrator
+*/
+
+#include "ElectronDynamics/GuidingCentreSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+#include "TParameter.h"
+
+rad::GuidingCentreSolver::GuidingCentreSolver(BaseField *field_v,
+                                              double charge_v, double mass_v,
+                                              double tau_v, double gradStep)
+    : field(field_v),
+      solver(field_v, charge_v, mass_v, tau_v),
+      charge(charge_v),
+      mass(mass_v),
+      tau(tau_v),
+      h(gradStep) {
+  if (h <= 0) {
+    std::cout << "Invalid gradient step (" << h << "). Exiting..."
+              << std::endl;
+    exit(1);
+  }
+}
+
+rad::GuidingCentreSolver::~GuidingCentreSolver() { CloseTrajectory(); }
+
+void rad::GuidingCentreSolver::PerpendicularBasis(TVector3 bHat, TVector3 &e1,
+                                                  TVector3 &e2) {
+  // Reference axis well away from the field direction
+  TVector3 ref{std::abs(bHat.X()) < 0.9 ? TVector3(1, 0, 0)
+                                        : TVector3(0, 1, 0)};
+  e1 = (ref - ref.Dot(bHat) * bHat).Unit();
+  e2 = bHat.Cross(e1);
+}
+
+void rad::GuidingCentreSolver::FieldGeometry(TVector3 pos, TVector3 &bHat,
+                                             double &bMag, TVector3 &gradB,
+                                             TVector3 &curv) {
+  // Centre point followed by +/- h along each axis
+  double x[7], y[7], z[7];
+  double bx[7], by[7], bz[7];
+  for (int i{0}; i < 7; i++) {
+    x[i] = pos.X();
+    y[i] = pos.Y();
+    z[i] = pos.Z();
+  }
+  x[1] += h;
+  x[2] -= h;
+  y[3] += h;
+  y[4] -= h;
+  z[5] += h;
+  z[6] -= h;
+  field->evaluate_field_batch(x, y, z, bx, by, bz, 7);
+
+  const TVector3 B0(bx[0], by[0], bz[0]);
+  bMag = B0.Mag();
+  bHat = B0 * (1 / bMag);
+
+  // Columns of the field Jacobian
+  TVector3 dBdx((bx[1] - bx[2]) / (2 * h), (by[1] - by[2]) / (2 * h),
+                (bz[1] - bz[2]) / (2 * h));
+  TVector3 dBdy((bx[3] - bx[4]) / (2 * h), (by[3] - by[4]) / (2 * h),
+                (bz[3] - bz[4]) / (2 * h));
+  TVector3 dBdz((bx[5] - bx[6]) / (2 * h), (by[5] - by[6]) / (2 * h),
+                (bz[5] - bz[6]) / (2 * h));
+
+  gradB = TVector3(bHat.Dot(dBdx), bHat.Dot(dBdy), bHat.Dot(dBdz));
+
+  // (bHat . grad) bHat = [(bHat . grad) B - bHat (bHat . grad |B|)] / |B|
+  TVector3 bGradB{bHat.X() * dBdx + bHat.Y() * dBdy + bHat.Z() * dBdz};
+  curv = (bGradB - bHat.Dot(gradB) * bHat) * (1 / bMag);
+}
+
+rad::GuidingCentreSolver::GCState rad::GuidingCentreSolver::Derivatives(
+    const GCState &s) {
+  TVector3 bHat, gradB, curv;
+  double bMag{0};
+  FieldGeometry(s.centre, bHat, bMag, gradB, curv);
+  const TVector3 E{field->evaluate_e_field_at_point(s.centre)};
+
+  const double c2{TMath::C() * TMath::C()};
+  const double uPerp2{2 * s.mu * bMag};
+  const double gamma{sqrt(1 + (s.uPar * s.uPar + uPerp2) / c2)};
+  // Signed non-relativistic cyclotron frequency
+  const double omega0{charge * bMag / mass};
+
+  GCState d;
+  // Parallel streaming plus grad-B, curvature and ExB drifts
+  d.centre = (s.uPar / gamma) * bHat +
+             (s.mu / (gamma * omega0)) * bHat.Cross(gradB) +
+             (s.uPar * s.uPar / (gamma * omega0)) * bHat.Cross(curv) +
+             E.Cross(bHat) * (1 / bMag);
+  // Mirror force and parallel electric field
+  d.uPar = -(s.mu / gamma) * bHat.Dot(gradB) + (charge / mass) * E.Dot(bHat);
+  // Radiation reaction on the perpendicular momentum, as in the Boris solver
+  d.mu = -2 * tau * omega0 * omega0 / (1 + tau * tau * omega0 * omega0) * s.mu;
+  d.phase = -omega0 / gamma;
+  return d;
+}
+
+rad::GuidingCentreSolver::GCState rad::GuidingCentreSolver::Combine(
+    const GCState &s, const GCState &d, double f) {
+  GCState out;
+  out.centre = s.centre + f * d.centre;
+  out.uPar = s.uPar + f * d.uPar;
+  out.mu = s.mu + f * d.mu;
+  out.phase = s.phase + f * d.phase;
+  return out;
+}
+
+rad::GuidingCentreSolver::GCNode rad::GuidingCentreSolver::MakeNode(
+    double time, const GCState &s) {
+  GCNode node;
+  node.time = time;
+  node.state = s;
+  node.deriv = Derivatives(s);
+  node.centreVel = node.deriv.centre;
+  return node;
+}
+
+void rad::GuidingCentreSolver::SetParticleState(TVector3 pos, TVector3 vel,
+                                                double time) {
+  const double c2{TMath::C() * TMath::C()};
+  const double gamma{1 / sqrt(1 - vel.Dot(vel) / c2)};
+  const TVector3 u{vel * gamma};
+
+  // Step back from the particle to its guiding centre
+  const TVector3 B0{field->evaluate_field_at_point(pos)};
+  const double bMag0{B0.Mag()};
+  const TVector3 bHat0{B0 * (1 / bMag0)};
+  const TVector3 vPerp0{vel - vel.Dot(bHat0) * bHat0};
+  const double omega{-charge * bMag0 / (gamma * mass)};
+  GCState s;
+  s.centre = pos - vPerp0.Cross(bHat0) * (1 / omega);
+
+  // Split the momentum about the field at the centre
+  const TVector3 B{field->evaluate_field_at_point(s.centre)};
+  const TVector3 bHat{B.Unit()};
+  s.uPar = u.Dot(bHat);
+  const double uPerp2{std::max(u.Dot(u) - s.uPar * s.uPar, 0.0)};
+  s.mu = uPerp2 / (2 * B.Mag());
+
+  TVector3 e1, e2;
+  PerpendicularBasis(bHat, e1, e2);
+  const TVector3 w{(vel - vel.Dot(bHat) * bHat).Cross(bHat)};
+  s.phase = atan2(w.Dot(e2), w.Dot(e1));
+  // Keep the unwrapped phase continuous with any earlier history
+  if (!history.empty()) {
+    const double prev{history.back().state.phase};
+    s.phase += TMath::TwoPi() * std::round((prev - s.phase) / TMath::TwoPi());
+  }
+
+  history.push_back(MakeNode(time, s));
+  WriteSamples();
+}
+
+void rad::GuidingCentreSolver::AdvanceStep(double time_step) {
+  const double t0{history.back().time};
+  const GCState y{history.back().state};
+  const GCState k1{history.back().deriv};
+
+  const GCState k2{Derivatives(Combine(y, k1, time_step / 2))};
+  const GCState k3{Derivatives(Combine(y, k2, time_step / 2))};
+  const GCState k4{Derivatives(Combine(y, k3, time_step))};
+
+  GCState yNew{Combine(y, k1, time_step / 6)};
+  yNew = Combine(yNew, k2, time_step / 3);
+  yNew = Combine(yNew, k3, time_step / 3);
+  yNew = Combine(yNew, k4, time_step / 6);
+
+  history.push_back(MakeNode(t0 + time_step, yNew));
+  WriteSamples();
+}
+
+double rad::GuidingCentreSolver::GetKE() const {
+  const GCState &s{history.back().state};
+  const double c2{TMath::C() * TMath::C()};
+  const double bMag{field->evaluate_field_at_point(s.centre).Mag()};
+  const double gamma{sqrt(1 + (s.uPar * s.uPar + 2 * s.mu * bMag) / c2)};
+  return (gamma - 1) * mass * c2 / TMath::Qe();
+}
+
+void rad::GuidingCentreSolver::ClearHistory() {
+  history.erase(history.begin(), history.end() - 1);
+}
+
+std::tuple<TVector3, TVector3, TVector3>
+rad::GuidingCentreSolver::GetParticleState(double time) {
+  // Last node at or before the requested time. Restarts produce two nodes at
+  // the same time, in which case the later one is used.
+  auto it = std::upper_bound(
+      history.begin(), history.end(), time,
+      [](double t, const GCNode &node) { return t < node.time; });
+  const size_t k{it == history.begin() ? 0
+                                       : size_t(it - history.begin()) - 1};
+  const GCNode &n0{history[k]};
+
+  GCState s;
+  TVector3 centreVel;
+  if (k + 1 < history.size() && history[k + 1].time > n0.time) {
+    // Cubic Hermite interpolation between neighbouring nodes
+    const GCNode &n1{history[k + 1]};
+    const double H{n1.time - n0.time};
+    const double x{(time - n0.time) / H};
+    const double h00{2 * x * x * x - 3 * x * x + 1};
+    const double h10{(x * x * x - 2 * x * x + x) * H};
+    const double h01{-2 * x * x * x + 3 * x * x};
+    const double h11{(x * x * x - x * x) * H};
+    s.centre = h00 * n0.state.centre + h10 * n0.deriv.centre +
+               h01 * n1.state.centre + h11 * n1.deriv.centre;
+    s.uPar = h00 * n0.state.uPar + h10 * n0.deriv.uPar +
+             h01 * n1.state.uPar + h11 * n1.deriv.uPar;
+    s.mu = h00 * n0.state.mu + h10 * n0.deriv.mu + h01 * n1.state.mu +
+           h11 * n1.deriv.mu;
+    s.phase = h00 * n0.state.phase + h10 * n0.deriv.phase +
+              h01 * n1.state.phase + h11 * n1.deriv.phase;
+
+    const double d00{(6 * x * x - 6 * x) / H};
+    const double d10{3 * x * x - 4 * x + 1};
+    const double d01{(-6 * x * x + 6 * x) / H};
+    const double d11{3 * x * x - 2 * x};
+    centreVel = d00 * n0.state.centre + d10 * n0.deriv.centre +
+                d01 * n1.state.centre + d11 * n1.deriv.centre;
+  } else {
+    // Outside the stored history so extrapolate linearly
+    s = Combine(n0.state, n0.deriv, time - n0.time);
+    centreVel = n0.centreVel;
+  }
+
+  // Rebuild the gyro-orbit about the interpolated centre
+  const TVector3 B{field->evaluate_field_at_point(s.centre)};
+  const double bMag{B.Mag()};
+  const TVector3 bHat{B * (1 / bMag)};
+  const double c2{TMath::C() * TMath::C()};
+  const double uPerp{sqrt(std::max(2 * s.mu * bMag, 0.0))};
+  const double gamma{sqrt(1 + (s.uPar * s.uPar + uPerp * uPerp) / c2)};
+  const double vPerp{uPerp / gamma};
+  const double omega{-charge * bMag / (gamma * mass)};
+
+  TVector3 e1, e2;
+  PerpendicularBasis(bHat, e1, e2);
+  const double cosPhi{cos(s.phase)};
+  const double sinPhi{sin(s.phase)};
+  const TVector3 pos{s.centre + (vPerp / omega) * (cosPhi * e1 + sinPhi * e2)};
+  const TVector3 vel{centreVel + vPerp * (-sinPhi * e1 + cosPhi * e2)};
+  const TVector3 acc{solver.acc(pos, vel)};
+  return std::make_tuple(pos, vel, acc);
+}
+
+void rad::GuidingCentreSolver::OpenTrajectory(TString outputFile,
+                                              double simStep,
+                                              unsigned int outputStride) {
+  if (simStep <= 0 || outputStride == 0) {
+    std::cout << "Invalid trajectory step (" << simStep << ") or stride ("
+              << outputStride << "). Exiting..." << std::endl;
+    exit(1);
+  }
+  if (history.empty()) {
+    std::cout << "Set the particle state before writing a trajectory. "
+                 "Exiting..."
+              << std::endl;
+    exit(1);
+  }
+  CloseTrajectory();
+
+  outFile = std::make_unique<TFile>(outputFile, "RECREATE");
+  if (!outFile || outFile->IsZombie()) {
+    std::cout << "File cannot be created. Exiting..." << std::endl;
+    exit(1);
+  }
+  outTree = new TTree("tree", "tree");
+  outTree->Branch("time", &outTime);
+  outTree->Branch("xPos", &outPos[0]);
+  outTree->Branch("yPos", &outPos[1]);
+  outTree->Branch("zPos", &outPos[2]);
+  outTree->Branch("xVel", &outVel[0]);
+  outTree->Branch("yVel", &outVel[1]);
+  outTree->Branch("zVel", &outVel[2]);
+  outTree->Branch("xAcc", &outAcc[0]);
+  outTree->Branch("yAcc", &outAcc[1]);
+  outTree->Branch("zAcc", &outAcc[2]);
+
+  outStep = simStep;
+  outStride = outputStride;
+  outStartTime = GetTime();
+  nextOutStep = 0;
+  WriteSamples();
+}
+
+void rad::GuidingCentreSolver::CloseTrajectory() {
+  if (!outTree) return;
+
+  outFile->cd();
+  outTree->Write("", TObject::kOverwrite);
+  // Record the orbit step so readers can reconstruct the skipped steps
+  TParameter<double> stepParam("simStepSize", outStep);
+  stepParam.Write();
+  outFile->Close();
+  outFile.reset();
+  // The tree was owned by the file
+  outTree = 0;
+}
+
+void rad::GuidingCentreSolver::WriteSamples() {
+  if (!outTree) return;
+
+  const double tEnd{GetTime()};
+  while (true) {
+    const double t{outStartTime + double(nextOutStep) * outStep};
+    if (t > tEnd) break;
+    FillSample(t);
+    nextOutStep += outStride;
+  }
+  // Every later sample lies after the current state
+  ClearHistory();
+}
+
+void rad::GuidingCentreSolver::FillSample(double time) {
+  const auto [pos, vel, acc] = GetParticleState(time);
+  outTime = time;
+  outPos[0] = pos.X();
+  outPos[1] = pos.Y();
+  outPos[2] = pos.Z();
+  outVel[0] = vel.X();
+  outVel[1] = vel.Y();
+  outVel[2] = vel.Z();
+  outAcc[0] = acc.X();
+  outAcc[1] = acc.Y();
+  outAcc[2] = acc.Z();
+  outTree->Fill();
+}
@@ -0,0 +1,179 @@
+/*
+  GuidingCentreSolver.h
+
+  Adiabatic guiding centre integrator for long electron tracks in slowly
+  varying trap fields. Rather than resolving every cyclotron orbit the
+  guiding centre position, parallel momentum, magnetic moment and gyrophase
+  are advanced with an RK4 step that can be nanoseconds long. The motion
+  includes the parallel streaming, mirror force, grad-B, curvature and ExB
+  drifts and the radiative loss of perpendicular momentum, using the same
+  radiation reaction model as BorisSolver. The full particle orbit is
+  reconstructed analytically from the gyrophase whenever it is needed, and
+  can be streamed to a trajectory file as the guiding centre is advanced.
+*/
+
+#ifndef GUIDING_CENTRE_SOLVER_H
+#define GUIDING_CENTRE_SOLVER_H
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "BasicFunctions/Constants.h"
+#include "ElectronDynamics/BaseField.h"
+#include "ElectronDynamics/BorisSolver.h"
+#include "TFile.h"
+#include "TMath.h"
+#include "TString.h"
+#include "TTree.h"
+#include "TVector3.h"
+
+namespace rad {
+class GuidingCentreSolver {
+ public:
+  /// @brief Parametrised constructor
+  /// @param field_v Pointer to a field calculator
+  /// @param charge_v Particle charge. Default is electron charge
+  /// @param mass_v Particle mass. Default is electron mass
+  /// @param tau_v Energy loss. Default is zero
+  /// @param gradStep Step used for the field derivatives [m]
+  GuidingCentreSolver(BaseField *field_v, double charge_v = -TMath::Qe(),
+                      double mass_v = ME, double tau_v = 0.0,
+                      double gradStep = 1e-6);
+
+  /// Destructor, closes any open trajectory file
+  ~GuidingCentreSolver();
+
+  GuidingCentreSolver(const GuidingCentreSolver &) = delete;
+  GuidingCentreSolver &operator=(const GuidingCentreSolver &) = delete;
+
+  /// @brief Sets the guiding centre state from a particle position and
+  /// velocity. Any earlier history is kept, so this can be used to restart
+  /// the track after e.g. a scatter.
+  /// @param pos Particle position [m]
+  /// @param vel Particle velocity [m/s]
+  /// @param time Simulation time of the state [s]
+  void SetParticleState(TVector3 pos, TVector3 vel, double time);
+
+  /// @brief Advances the guiding centre by one time step
+  /// @param time_step The time step [s]
+  void AdvanceStep(double time_step);
+
+  /// @brief Current simulation time [s]
+  double GetTime() const { return history.back().time; }
+
+  /// @brief Current guiding centre position [m]
+  TVector3 GetCentre() const { return history.back().state.centre; }
+
+  /// @brief Current guiding centre velocity including drifts [m/s]
+  TVector3 GetCentreVelocity() const { return history.back().centreVel; }
+
+  /// @brief Current kinetic energy [eV]
+  double GetKE() const;
+
+  /// @brief Time of the first stored state [s]. While a trajectory is
+  /// being written only the current state is stored
+  double GetStartTime() const { return history.front().time; }
+
+  /// @brief Number of stored guiding centre states
+  size_t GetNStates() const { return history.size(); }
+
+  /// @brief Discards all stored states apart from the current one
+  void ClearHistory();
+
+  /// @brief Reconstructs the full particle orbit at a time within the
+  /// stored history. Later times are extrapolated from the current state
+  /// @param time Time at which to evaluate the orbit [s]
+  /// @return Tuple of the particle position, velocity and acceleration
+  std::tuple<TVector3, TVector3, TVector3> GetParticleState(double time);
+
+  /// @brief Starts writing the reconstructed particle orbit to a ROOT file
+  /// in the same format as ElectronTrajectoryGen, beginning at the current
+  /// state. The orbit is written as the guiding centre is advanced and the
+  /// history behind it is discarded, so memory use does not grow with the
+  /// length of the track.
+  /// @param outputFile Output file path
+  /// @param simStep Time step of the reconstructed orbit [s]. This is
+  /// recorded in the file so that readers can interpolate to it
+  /// @param outputStride Write only every outputStride-th orbit step
+  void OpenTrajectory(TString outputFile, double simStep,
+                      unsigned int outputStride = 1);
+
+  /// @brief Closes the trajectory file. The file ends at the last written
+  /// orbit step, up to outputStride orbit steps before the current time
+  void CloseTrajectory();
+
+ private:
+  /// Guiding centre state and its time derivative
+  struct GCState {
+    TVector3 centre;  // Guiding centre position [m]
+    double uPar;      // Parallel momentum per unit mass [m/s]
+    double mu;        // Perpendicular momentum^2 / (2 * m^2 * B) [m^2/s^2/T]
+    double phase;     // Gyrophase, not wrapped [rad]
+  };
+
+  /// Stored state, with derivatives for interpolation between steps
+  struct GCNode {
+    double time;
+    GCState state;
+    GCState deriv;
+    TVector3 centreVel;
+  };
+
+  BaseField *field = 0;
+  BorisSolver solver;
+  double charge;
+  double mass;
+  double tau;
+  double h;
+
+  std::vector<GCNode> history;
+
+  // Streamed trajectory output
+  std::unique_ptr<TFile> outFile;
+  TTree *outTree = 0;
+  double outStep{0};
+  unsigned int outStride{1};
+  double outStartTime{0};
+  unsigned long nextOutStep{0};  // Orbit step number of the next sample
+  double outTime{};
+  double outPos[3]{};
+  double outVel[3]{};
+  double outAcc[3]{};
+
+  /// @brief Guiding centre equations of motion
+  /// @param s State at which to evaluate the derivatives
+  /// @return Time derivative of each state variable
+  GCState Derivatives(const GCState &s);
+
+  /// @brief Evaluates |B|, its gradient and the field line curvature
+  /// @param pos Position [m]
+  /// @param bHat Set to the field direction
+  /// @param bMag Set to the field magnitude [T]
+  /// @param gradB Set to the gradient of |B| [T/m]
+  /// @param curv Set to the field line curvature vector [1/m]
+  void FieldGeometry(TVector3 pos, TVector3 &bHat, double &bMag,
+                     TVector3 &gradB, TVector3 &curv);
+
+  /// @brief Perpendicular unit vectors defining the gyrophase origin
+  /// @param bHat Field direction
+  /// @param e1 Set to the direction of zero gyrophase
+  /// @param e2 Set to bHat x e1, such that e1 x e2 = bHat
+  static void PerpendicularBasis(TVector3 bHat, TVector3 &e1, TVector3 &e2);
+
+  /// @brief Creates a node from a state, evaluating its derivatives
+  GCNode MakeNode(double time, const GCState &s);
+
+  /// @brief Writes the orbit samples up to the current state to the
+  /// trajectory file, then discards the history before the current state
+  void WriteSamples();
+
+  /// @brief Reconstructs the orbit at a time and fills the output tree
+  void FillSample(double time);
+
+  /// @brief Returns s + f * d for each state variable
+  static GCState Combine(const GCState &s, const GCState &d, double f);
+};
+}  // namespace rad
+
+#endif
@@ -1,5 +1,7 @@
 #include "ElectronDynamics/PenningTraps.h"
 
+#include <algorithm>
+
 rad::IdealPenningTrap::IdealPenningTrap(double BField, double v0, double rho0,
                                         double z0)
     : B(TVector3(0, 0, BField)), V0(v0), Rho0(rho0), Z0(z0) {}
@@ -11,4 +13,27 @@ TVector3 rad::IdealPenningTrap::evaluate_field_at_point(const TVector3 vec) {
 TVector3 rad::IdealPenningTrap::evaluate_e_field_at_point(TVector3 v) {
   double c{2 * V0 / (Z0 * Z0 + 0.5 * Rho0 * Rho0)};
   return c * TVector3(0.5 * v.X(), 0.5 * v.Y(), -v.Z());
-}
\ No newline at end of file
+}
+
+void rad::IdealPenningTrap::evaluate_field_batch(const double *x,
+                                                 const double *y,
+                                                 const double *z, double *bx,
+                                                 double *by, double *bz,
+                                                 size_t n) {
+  std::fill(bx, bx + n, B.X());
+  std::fill(by, by + n, B.Y());
+  std::fill(bz, bz + n, B.Z());
+}
+
+void rad::IdealPenningTrap::evaluate_e_field_batch(const double *x,
+                                                   const double *y,
+                                                   const double *z, double *ex,
+                                                   double *ey, double *ez,
+                                                   size_t n) {
+  const double c{2 * V0 / (Z0 * Z0 + 0.5 * Rho0 * Rho0)};
+  for (size_t i{0}; i < n; i++) {
+    ex[i] = c * 0.5 * x[i];
+    ey[i] = c * 0.5 * y[i];
+    ez[i] = -c * z[i];
+  }
+}
@@ -32,6 +32,30 @@ class IdealPenningTrap : public BaseField {
   /// @return E field vector in volts / metre
   TVector3 evaluate_e_field_at_point(TVector3 v) override;
 
+  /// @brief Calculate B field at a batch of points
+  /// @param x Array of x coordinates [m]
+  /// @param y Array of y coordinates [m]
+  /// @param z Array of z coordinates [m]
+  /// @param bx Output array of field x components [T]
+  /// @param by Output array of field y components [T]
+  /// @param bz Output array of field z components [T]
+  /// @param n Number of points
+  void evaluate_field_batch(const double *x, const double *y, const double *z,
+                            double *bx, double *by, double *bz,
+                            size_t n) override;
+
+  /// @brief Calculate E field at a batch of points
+  /// @param x Array of x coordinates [m]
+  /// @param y Array of y coordinates [m]
+  /// @param z Array of z coordinates [m]
+  /// @param ex Output array of field x components [V/m]
+  /// @param ey Output array of field y components [V/m]
+  /// @param ez Output array of field z components [V/m]
+  /// @param n Number of points
+  void evaluate_e_field_batch(const double *x, const double *y,
+                              const double *z, double *ex, double *ey,
+                              double *ez, size_t n) override;
+
  private:
   TVector3 B;
   double V0;
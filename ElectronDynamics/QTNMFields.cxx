@@ -5,14 +5,50 @@
 #include <boost/math/special_functions/ellint_1.hpp>
 #include <boost/math/special_functions/ellint_2.hpp>
 #include <boost/math/special_functions/heuman_lambda.hpp>
+#include <algorithm>
 #include <cmath>
 
 #include "BasicFunctions/Constants.h"
+#include "BasicFunctions/EllipticIntegrals.h"
 #include "TGraph.h"
 #include "TMath.h"
 #include "TSpline.h"
 #include "TVector3.h"
 
+namespace {
+// Number of points processed together by the batched field evaluations
+// Sized so the per-chunk scratch arrays stay in L1 cache
+constexpr size_t kFieldBatchChunk{64};
+
+void complete_elliptic(rad::EllipticImpl_t impl, double k, double &int_k,
+                       double &int_e) {
+  if (impl == rad::kAGMElliptic) {
+    rad::CompleteEllipticIntegrals(k, int_k, int_e);
+  } else {
+    int_k = boost::math::ellint_1(k);
+    int_e = boost::math::ellint_2(k);
+  }
+}
+
+void complete_elliptic_batch(rad::EllipticImpl_t impl, const double *k,
+                             double *int_k, double *int_e, size_t n) {
+  if (impl == rad::kAGMElliptic) {
+    rad::CompleteEllipticIntegralsBatch(k, int_k, int_e, n);
+  } else {
+    for (size_t i{0}; i < n; i++) {
+      int_k[i] = boost::math::ellint_1(k[i]);
+      int_e[i] = boost::math::ellint_2(k[i]);
+    }
+  }
+}
+
+void fill_zero_batch(double *ex, double *ey, double *ez, size_t n) {
+  std::fill(ex, ex + n, 0.0);
+  std::fill(ey, ey + n, 0.0);
+  std::fill(ez, ez + n, 0.0);
+}
+}  // namespace
+
 TVector3 rad::UniformField::evaluate_field_at_point(const TVector3 vec) {
   TVector3 BField(0, 0, fieldStrength);
   return BField;
@@ -50,8 +86,9 @@ TVector3 rad::CoilField::evaluate_field_at_point(const TVector3 vec) {
   double alpha = pow(1.0 + rad_norm, 2) + z_norm * z_norm;
   double root_alpha_pi = sqrt(alpha) * TMath::Pi();
   double beta = 4 * rad_norm / alpha;
-  double int_k = boost::math::ellint_1(sqrt(beta));
-  double int_e = boost::math::ellint_2(sqrt(beta));
+  double int_k{0};
+  double int_e{0};
+  complete_elliptic(ellipticImpl, sqrt(beta), int_k, int_e);
   double gamma = alpha - 4 * rad_norm;
 
   double b_r =
@@ -69,6 +106,82 @@ TVector3 rad::CoilField::evaluate_field_at_point(const TVector3 vec) {
   return BField;
 }
 
+void rad::CoilField::accumulate_field_batch(const double *x, const double *y,
+                                            const double *z, double *bx,
+                                            double *by, double *bz,
+                                            size_t n) {
+  const double b_central = central_field();
+  const double onAxisPremult =
+      coilMu * coilCurrent * coilRadius * coilRadius / 2.0;
+
+  double rad[kFieldBatchChunk];
+  double k[kFieldBatchChunk];
+  double int_k[kFieldBatchChunk];
+  double int_e[kFieldBatchChunk];
+
+  for (size_t start{0}; start < n; start += kFieldBatchChunk) {
+    const size_t m{std::min(kFieldBatchChunk, n - start)};
+    const double *xc{x + start};
+    const double *yc{y + start};
+    const double *zc{z + start};
+
+    // Geometry, no branches so this vectorises
+    for (size_t i{0}; i < m; i++) {
+      rad[i] = sqrt(xc[i] * xc[i] + yc[i] * yc[i]);
+      const double rad_norm = rad[i] / coilRadius;
+      const double z_norm = (zc[i] - coilZ) / coilRadius;
+      const double alpha =
+          (1.0 + rad_norm) * (1.0 + rad_norm) + z_norm * z_norm;
+      k[i] = sqrt(4 * rad_norm / alpha);
+    }
+
+    complete_elliptic_batch(ellipticImpl, k, int_k, int_e, m);
+
+    for (size_t i{0}; i < m; i++) {
+      const bool onAxis = rad[i] / coilRadius < 1e-10;
+      const double z_rel = zc[i] - coilZ;
+      const double rad_norm = rad[i] / coilRadius;
+      const double z_norm = z_rel / coilRadius;
+      const double alpha =
+          (1.0 + rad_norm) * (1.0 + rad_norm) + z_norm * z_norm;
+      const double root_alpha_pi = sqrt(alpha) * TMath::Pi();
+      const double gamma = alpha - 4 * rad_norm;
+      // Avoid dividing by zero for points on the axis
+      const double safeRad = onAxis ? 1.0 : rad[i];
+
+      const double b_r =
+          b_central *
+          (int_e[i] * ((1.0 + rad_norm * rad_norm + z_norm * z_norm) / gamma) -
+           int_k[i]) /
+          root_alpha_pi * (z_rel / safeRad);
+      const double b_z =
+          b_central *
+          (int_e[i] * ((1.0 - rad_norm * rad_norm - z_norm * z_norm) / gamma) +
+           int_k[i]) /
+          root_alpha_pi;
+      const double b_zAxis =
+          onAxisPremult / pow(coilRadius * coilRadius + z_rel * z_rel, 1.5);
+
+      bx[start + i] += onAxis ? 0.0 : b_r * xc[i] / safeRad;
+      by[start + i] += onAxis ? 0.0 : b_r * yc[i] / safeRad;
+      bz[start + i] += onAxis ? b_zAxis : b_z;
+    }
+  }
+}
+
+void rad::CoilField::evaluate_field_batch(const double *x, const double *y,
+                                          const double *z, double *bx,
+                                          double *by, double *bz, size_t n) {
+  fill_zero_batch(bx, by, bz, n);
+  accumulate_field_batch(x, y, z, bx, by, bz, n);
+}
+
+void rad::CoilField::evaluate_e_field_batch(const double *x, const double *y,
+                                            const double *z, double *ex,
+                                            double *ey, double *ez, size_t n) {
+  fill_zero_batch(ex, ey, ez, n);
+}
+
 rad::BathtubField::BathtubField(const double radius, const double current,
                                 const double Z1, const double Z2,
                                 TVector3 background)
@@ -84,6 +197,25 @@ TVector3 rad::BathtubField::evaluate_field_at_point(const TVector3 vec) {
   return totalField;
 }
 
+void rad::BathtubField::evaluate_field_batch(const double *x, const double *y,
+                                             const double *z, double *bx,
+                                             double *by, double *bz,
+                                             size_t n) {
+  std::fill(bx, bx + n, btBkg.X());
+  std::fill(by, by + n, btBkg.Y());
+  std::fill(bz, bz + n, btBkg.Z());
+  coil1.accumulate_field_batch(x, y, z, bx, by, bz, n);
+  coil2.accumulate_field_batch(x, y, z, bx, by, bz, n);
+}
+
+void rad::BathtubField::evaluate_e_field_batch(const double *x,
+                                               const double *y,
+                                               const double *z, double *ex,
+                                               double *ey, double *ez,
+                                               size_t n) {
+  fill_zero_batch(ex, ey, ez, n);
+}
+
 double rad::SolenoidField::on_axis_field(const double z) {
   const double shiftedZ = z - zOff;
   const double xiPlus = shiftedZ + l / 2;
@@ -111,10 +243,12 @@ TVector3 rad::SolenoidField::evaluate_field_at_point(const TVector3 vec) {
   double kPlus = sqrt(4 * rad * r / (xiPlus * xiPlus + pow(rad + r, 2)));
   double kMinus = sqrt(4 * rad * r / (xiMinus * xiMinus + pow(rad + r, 2)));
 
-  double int_kPlus = boost::math::ellint_1(kPlus);
-  double int_kMinus = boost::math::ellint_1(kMinus);
-  double int_ePlus = boost::math::ellint_2(kPlus);
-  double int_eMinus = boost::math::ellint_2(kMinus);
+  double int_kPlus{0};
+  double int_kMinus{0};
+  double int_ePlus{0};
+  double int_eMinus{0};
+  complete_elliptic(ellipticImpl, kPlus, int_kPlus, int_ePlus);
+  complete_elliptic(ellipticImpl, kMinus, int_kMinus, int_eMinus);
 
   double Br =
       ((2 - kPlus * kPlus) / (2 * kPlus) * int_kPlus - int_ePlus / kPlus) -
@@ -151,6 +285,108 @@ TVector3 rad::SolenoidField::evaluate_field_at_point(const TVector3 vec) {
   return BField;
 }
 
+void rad::SolenoidField::evaluate_field_batch(const double *x, const double *y,
+                                              const double *z, double *bx,
+                                              double *by, double *bz,
+                                              size_t n) {
+  // n is the number of points here, the turns density is this->n
+  const double premultZ = (mu * this->n * i / 4);
+  const double axisPremult = (mu * this->n * i / 2);
+  const double radialPremult = (mu * this->n * i / TMath::Pi());
+
+  double rad[kFieldBatchChunk];
+  double kPlus[kFieldBatchChunk];
+  double kMinus[kFieldBatchChunk];
+  double phiPlus[kFieldBatchChunk];
+  double phiMinus[kFieldBatchChunk];
+  double int_kPlus[kFieldBatchChunk];
+  double int_kMinus[kFieldBatchChunk];
+  double int_ePlus[kFieldBatchChunk];
+  double int_eMinus[kFieldBatchChunk];
+  double lambdaPlus[kFieldBatchChunk];
+  double lambdaMinus[kFieldBatchChunk];
+
+  for (size_t start{0}; start < n; start += kFieldBatchChunk) {
+    const size_t m{std::min(kFieldBatchChunk, n - start)};
+    const double *xc{x + start};
+    const double *yc{y + start};
+    const double *zc{z + start};
+
+    // Geometry, no branches so this vectorises
+    for (size_t j{0}; j < m; j++) {
+      rad[j] = sqrt(xc[j] * xc[j] + yc[j] * yc[j]);
+      const double xiPlus = (zc[j] - zOff) + l / 2;
+      const double xiMinus = (zc[j] - zOff) - l / 2;
+      kPlus[j] = sqrt(4 * rad[j] * r /
+                      (xiPlus * xiPlus + (rad[j] + r) * (rad[j] + r)));
+      kMinus[j] = sqrt(4 * rad[j] * r /
+                       (xiMinus * xiMinus + (rad[j] + r) * (rad[j] + r)));
+      phiPlus[j] = atan(std::abs(xiPlus / (r - rad[j])));
+      phiMinus[j] = atan(std::abs(xiMinus / (r - rad[j])));
+    }
+
+    // Special functions. On the axis k = 0 and the closed form is used
+    complete_elliptic_batch(ellipticImpl, kPlus, int_kPlus, int_ePlus, m);
+    complete_elliptic_batch(ellipticImpl, kMinus, int_kMinus, int_eMinus, m);
+    for (size_t j{0}; j < m; j++) {
+      if (rad[j] / r < 1e-10) {
+        lambdaPlus[j] = lambdaMinus[j] = 0;
+        continue;
+      }
+      lambdaPlus[j] = boost::math::heuman_lambda(kPlus[j], phiPlus[j]);
+      lambdaMinus[j] = boost::math::heuman_lambda(kMinus[j], phiMinus[j]);
+    }
+
+    for (size_t j{0}; j < m; j++) {
+      const bool onAxis = rad[j] / r < 1e-10;
+      // Avoid dividing by zero for points on the axis
+      const double safeRad = onAxis ? r : rad[j];
+      const double xiPlus = (zc[j] - zOff) + l / 2;
+      const double xiMinus = (zc[j] - zOff) - l / 2;
+      const double kP = onAxis ? 1.0 : kPlus[j];
+      const double kM = onAxis ? 1.0 : kMinus[j];
+
+      const double premultR = radialPremult * sqrt(r / safeRad);
+      const double Br =
+          premultR *
+          (((2 - kP * kP) / (2 * kP) * int_kPlus[j] - int_ePlus[j] / kP) -
+           ((2 - kM * kM) / (2 * kM) * int_kMinus[j] - int_eMinus[j] / kM));
+
+      // The sign of the Heuman lambda term is taken as positive when xi = 0
+      const double signPlus =
+          xiPlus == 0
+              ? 1.0
+              : (r - safeRad) * xiPlus / std::abs((r - safeRad) * xiPlus);
+      const double signMinus =
+          xiMinus == 0
+              ? 1.0
+              : (r - safeRad) * xiMinus / std::abs((r - safeRad) * xiMinus);
+      const double rootRRad = TMath::Pi() * sqrt(r * safeRad);
+      const double Bz =
+          premultZ *
+          ((xiPlus * kP * int_kPlus[j] / rootRRad + signPlus * lambdaPlus[j]) -
+           (xiMinus * kM * int_kMinus[j] / rootRRad +
+            signMinus * lambdaMinus[j]));
+
+      const double BzAxis =
+          axisPremult * ((xiPlus / sqrt(xiPlus * xiPlus + r * r)) -
+                         (xiMinus / sqrt(xiMinus * xiMinus + r * r)));
+
+      bx[start + j] = onAxis ? 0.0 : Br * xc[j] / safeRad;
+      by[start + j] = onAxis ? 0.0 : Br * yc[j] / safeRad;
+      bz[start + j] = onAxis ? BzAxis : Bz;
+    }
+  }
+}
+
+void rad::SolenoidField::evaluate_e_field_batch(const double *x,
+                                                const double *y,
+                                                const double *z, double *ex,
+                                                double *ey, double *ez,
+                                                size_t n) {
+  fill_zero_batch(ex, ey, ez, n);
+}
+
 TVector3 rad::InhomogeneousBackgroundField::evaluate_field_at_point(
     const TVector3 vec) {
   const double r = sqrt(vec.X() * vec.X() + vec.Y() * vec.Y());
@@ -196,6 +432,24 @@ TVector3 rad::HarmonicField::evaluate_field_at_point(const TVector3 vec) {
   return totalField;
 }
 
+void rad::HarmonicField::evaluate_field_batch(const double *x, const double *y,
+                                              const double *z, double *bx,
+                                              double *by, double *bz,
+                                              size_t n) {
+  std::fill(bx, bx + n, btBkg.X());
+  std::fill(by, by + n, btBkg.Y());
+  std::fill(bz, bz + n, btBkg.Z());
+  coil.accumulate_field_batch(x, y, z, bx, by, bz, n);
+}
+
+void rad::HarmonicField::evaluate_e_field_batch(const double *x,
+                                                const double *y,
+                                                const double *z, double *ex,
+                                                double *ey, double *ez,
+                                                size_t n) {
+  fill_zero_batch(ex, ey, ez, n);
+}
+
 rad::HTSMagnetUCL::HTSMagnetUCL() {
   // Create the graphs and splines
   grFieldZ = new TGraph();
@@ -10,6 +10,7 @@
 #define QTNM_FIELDS_H
 
 #include "BasicFunctions/Constants.h"
+#include "BasicFunctions/EllipticIntegrals.h"
 #include "ElectronDynamics/BaseField.h"
 #include "TGraph.h"
 #include "TSpline.h"
@@ -45,6 +46,7 @@ class CoilField : public BaseField {
   double coilCurrent;
   double coilZ;
   double coilMu;
+  EllipticImpl_t ellipticImpl{kAGMElliptic};
 
   double central_field();
 
@@ -58,16 +60,56 @@ class CoilField : public BaseField {
   CoilField(const double radius = 0.005, const double current = 40,
             const double z = 0.0, const double mu = MU0);
 
+  /// Selects the implementation of the complete elliptic integrals
+  /// \param impl Boost or the in-house AGM kernel (the default)
+  void set_elliptic_impl(EllipticImpl_t impl) { ellipticImpl = impl; }
+
   /// \param vec Position vector of charge
   /// \returns The magnetic field vector at the point
   TVector3 evaluate_field_at_point(const TVector3 vec) override;
 
+  /// Adds the coil field at a batch of points to the output arrays
+  /// \param x Array of x coordinates (in metres)
+  /// \param y Array of y coordinates (in metres)
+  /// \param z Array of z coordinates (in metres)
+  /// \param bx Array of field x components to add to (in Tesla)
+  /// \param by Array of field y components to add to (in Tesla)
+  /// \param bz Array of field z components to add to (in Tesla)
+  /// \param n Number of points
+  void accumulate_field_batch(const double *x, const double *y,
+                              const double *z, double *bx, double *by,
+                              double *bz, size_t n);
+
+  /// Gives the field at a batch of points
+  /// \param x Array of x coordinates (in metres)
+  /// \param y Array of y coordinates (in metres)
+  /// \param z Array of z coordinates (in metres)
+  /// \param bx Output array of field x components (in Tesla)
+  /// \param by Output array of field y components (in Tesla)
+  /// \param bz Output array of field z components (in Tesla)
+  /// \param n Number of points
+  void evaluate_field_batch(const double *x, const double *y, const double *z,
+                            double *bx, double *by, double *bz,
+                            size_t n) override;
+
   /// @brief Calculate electric field at a point
   /// @param v Position at which to calculate field
   /// @return Electric field = 0
   TVector3 evaluate_e_field_at_point(TVector3 v) override {
     return TVector3(0, 0, 0);
   }
+
+  /// @brief Calculate electric field at a batch of points
+  /// @param x Array of x coordinates
+  /// @param y Array of y coordinates
+  /// @param z Array of z coordinates
+  /// @param ex Output x components, all set to 0
+  /// @param ey Output y components, all set to 0
+  /// @param ez Output z components, all set to 0
+  /// @param n Number of points
+  void evaluate_e_field_batch(const double *x, const double *y,
+                              const double *z, double *ex, double *ey,
+                              double *ez, size_t n) override;
 };
 
 /// Class describing the bathtub field
@@ -88,16 +130,47 @@ class BathtubField : public BaseField {
   BathtubField(const double radius, const double current, const double Z1,
                const double Z2, TVector3 background);
 
+  /// Selects the implementation of the complete elliptic integrals
+  /// \param impl Boost or the in-house AGM kernel (the default)
+  void set_elliptic_impl(EllipticImpl_t impl) {
+    coil1.set_elliptic_impl(impl);
+    coil2.set_elliptic_impl(impl);
+  }
+
   /// \param vec Position vector of charge
   /// \returns The magnetic field vector at the point
   TVector3 evaluate_field_at_point(const TVector3 vec) override;
 
+  /// Gives the field at a batch of points
+  /// \param x Array of x coordinates (in metres)
+  /// \param y Array of y coordinates (in metres)
+  /// \param z Array of z coordinates (in metres)
+  /// \param bx Output array of field x components (in Tesla)
+  /// \param by Output array of field y components (in Tesla)
+  /// \param bz Output array of field z components (in Tesla)
+  /// \param n Number of points
+  void evaluate_field_batch(const double *x, const double *y, const double *z,
+                            double *bx, double *by, double *bz,
+                            size_t n) override;
+
   /// @brief Calculate electric field at a point
   /// @param v Position at which to calculate field
   /// @return Electric field = 0
   TVector3 evaluate_e_field_at_point(TVector3 v) override {
     return TVector3(0, 0, 0);
   }
+
+  /// @brief Calculate electric field at a batch of points
+  /// @param x Array of x coordinates
+  /// @param y Array of y coordinates
+  /// @param z Array of z coordinates
+  /// @param ex Output x components, all set to 0
+  /// @param ey Output y components, all set to 0
+  /// @param ez Output z components, all set to 0
+  /// @param n Number of points
+  void evaluate_e_field_batch(const double *x, const double *y,
+                              const double *z, double *ex, double *ey,
+                              double *ez, size_t n) override;
 };
 
 /// Class describing the field of a finite solenoid
@@ -110,6 +183,7 @@ class SolenoidField : public BaseField {
   double n;
   double mu;
   double zOff;
+  EllipticImpl_t ellipticImpl{kAGMElliptic};
 
   /// Gives the on axis field for the solenoid
   /// \param z The position along the z axis
@@ -133,17 +207,46 @@ class SolenoidField : public BaseField {
         mu(perm),
         zOff(zOffset) {}
 
+  /// Selects the implementation of the complete elliptic integrals
+  /// The Heuman lambda function is always evaluated with Boost
+  /// \param impl Boost or the in-house AGM kernel (the default)
+  void set_elliptic_impl(EllipticImpl_t impl) { ellipticImpl = impl; }
+
   /// Gives the field at a positon vector
   /// \param vec Position vector of charge
   /// \Returns The magnetic field vector at the point (in Tesla)
   TVector3 evaluate_field_at_point(const TVector3 vec) override;
 
+  /// Gives the field at a batch of points
+  /// \param x Array of x coordinates (in metres)
+  /// \param y Array of y coordinates (in metres)
+  /// \param z Array of z coordinates (in metres)
+  /// \param bx Output array of field x components (in Tesla)
+  /// \param by Output array of field y components (in Tesla)
+  /// \param bz Output array of field z components (in Tesla)
+  /// \param n Number of points
+  void evaluate_field_batch(const double *x, const double *y, const double *z,
+                            double *bx, double *by, double *bz,
+                            size_t n) override;
+
   /// @brief Calculate electric field at a point
   /// @param v Position at which to calculate field
   /// @return Electric field = 0
   TVector3 evaluate_e_field_at_point(TVector3 v) override {
     return TVector3(0, 0, 0);
   }
+
+  /// @brief Calculate electric field at a batch of points
+  /// @param x Array of x coordinates
+  /// @param y Array of y coordinates
+  /// @param z Array of z coordinates
+  /// @param ex Output x components, all set to 0
+  /// @param ey Output y components, all set to 0
+  /// @param ez Output z components, all set to 0
+  /// @param n Number of points
+  void evaluate_e_field_batch(const double *x, const double *y,
+                              const double *z, double *ex, double *ey,
+                              double *ez, size_t n) override;
 };
 
 /// Class describing something like a non-ideal background field, i.e. from a
@@ -242,16 +345,44 @@ class HarmonicField : public BaseField {
   HarmonicField(const double radius, const double current,
                 const double background);
 
+  /// Selects the implementation of the complete elliptic integrals
+  /// \param impl Boost or the in-house AGM kernel (the default)
+  void set_elliptic_impl(EllipticImpl_t impl) { coil.set_elliptic_impl(impl); }
+
   /// \param vec Position vector of charge
   /// \returns The magnetic field at the point
   TVector3 evaluate_field_at_point(const TVector3 vec) override;
 
+  /// Gives the field at a batch of points
+  /// \param x Array of x coordinates (in metres)
+  /// \param y Array of y coordinates (in metres)
+  /// \param z Array of z coordinates (in metres)
+  /// \param bx Output array of field x components (in Tesla)
+  /// \param by Output array of field y components (in Tesla)
+  /// \param bz Output array of field z components (in Tesla)
+  /// \param n Number of points
+  void evaluate_field_batch(const double *x, const double *y, const double *z,
+                            double *bx, double *by, double *bz,
+                            size_t n) override;
+
   /// @brief Calculate electric field at a point
   /// @param v Position at which to calculate field
   /// @return Electric field = 0
   TVector3 evaluate_e_field_at_point(TVector3 v) override {
     return TVector3(0, 0, 0);
   }
+
+  /// @brief Calculate electric field at a batch of points
+  /// @param x Array of x coordinates
+  /// @param y Array of y coordinates
+  /// @param z Array of z coordinates
+  /// @param ex Output x components, all set to 0
+  /// @param ey Output y components, all set to 0
+  /// @param ez Output z components, all set to 0
+  /// @param n Number of points
+  void evaluate_e_field_batch(const double *x, const double *y,
+                              const double *z, double *ex, double *ey,
+                              double *ez, size_t n) override;
 };
 
 /// Class describing the custom HTS magnet designed for the UCL AMOPP group
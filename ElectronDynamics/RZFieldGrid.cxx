@@ -0,0 +1,167 @@
+/// RZFieldGrid.cxx
+
+#include "ElectronDynamics/RZFieldGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+rad::RZFieldGrid::RZFieldGrid(double rMin, double rMax, unsigned int nR,
+                              double zMin, double zMax, unsigned int nZ,
+                              std::vector<double> values, Interp_t interp)
+    : r0(rMin),
+      nodesR(nR),
+      z0(zMin),
+      nodesZ(nZ),
+      method(interp),
+      ownedValues(std::move(values)) {
+  CheckDimensions();
+  if (ownedValues.size() != size_t(nR) * size_t(nZ)) {
+    std::cout << "Grid value array has " << ownedValues.size()
+              << " entries, expected " << nR * nZ << ". Exiting.\n";
+    exit(1);
+  }
+  dr = (rMax - rMin) / double(nR - 1);
+  dz = (zMax - zMin) / double(nZ - 1);
+  data = ownedValues.data();
+}
+
+rad::RZFieldGrid::RZFieldGrid(double rMin, double rMax, unsigned int nR,
+                              double zMin, double zMax, unsigned int nZ,
+                              const double *values, Interp_t interp)
+    : r0(rMin),
+      nodesR(nR),
+      z0(zMin),
+      nodesZ(nZ),
+      method(interp),
+      data(values) {
+  CheckDimensions();
+  dr = (rMax - rMin) / double(nR - 1);
+  dz = (zMax - zMin) / double(nZ - 1);
+}
+
+rad::RZFieldGrid::RZFieldGrid(const RZFieldGrid &grid)
+    : r0(grid.r0),
+      dr(grid.dr),
+      nodesR(grid.nodesR),
+      z0(grid.z0),
+      dz(grid.dz),
+      nodesZ(grid.nodesZ),
+      method(grid.method),
+      ownedValues(grid.ownedValues) {
+  data = ownedValues.empty() ? grid.data : ownedValues.data();
+}
+
+rad::RZFieldGrid &rad::RZFieldGrid::operator=(const RZFieldGrid &grid) {
+  if (this == &grid) return *this;
+  r0 = grid.r0;
+  dr = grid.dr;
+  nodesR = grid.nodesR;
+  z0 = grid.z0;
+  dz = grid.dz;
+  nodesZ = grid.nodesZ;
+  method = grid.method;
+  ownedValues = grid.ownedValues;
+  data = ownedValues.empty() ? grid.data : ownedValues.data();
+  return *this;
+}
+
+void rad::RZFieldGrid::CheckDimensions() const {
+  if (nodesR < 2 || nodesZ < 2) {
+    std::cout << "Field grid requires at least 2 nodes in each dimension (got "
+              << nodesR << " x " << nodesZ << "). Exiting.\n";
+    exit(1);
+  }
+}
+
+bool rad::RZFieldGrid::IsInside(double r, double z) const {
+  // Allow for a small amount of rounding at the edges
+  const double rTol{1e-9 * dr};
+  const double zTol{1e-9 * dz};
+  return (r >= r0 - rTol && r <= GetRMax() + rTol && z >= z0 - zTol &&
+          z <= GetZMax() + zTol);
+}
+
+unsigned int rad::RZFieldGrid::FindCell(double x, double x0, double dx,
+                                        unsigned int n, double &t) {
+  double u{(x - x0) / dx};
+  // Clamp to the last full cell so points on the upper edge are included
+  double cell{std::floor(u)};
+  if (cell < 0) cell = 0;
+  if (cell > double(n - 2)) cell = double(n - 2);
+  t = u - cell;
+  return (unsigned int)(cell);
+}
+
+double rad::RZFieldGrid::Interpolate(double r, double z) const {
+  if (!IsInside(r, z)) return 0;
+
+  double tr{0};
+  double tz{0};
+  const unsigned int ir{FindCell(r, r0, dr, nodesR, tr)};
+  const unsigned int iz{FindCell(z, z0, dz, nodesZ, tz)};
+
+  if (method == kBicubic) return InterpolateBicubic(ir, iz, tr, tz);
+  return InterpolateBilinear(ir, iz, tr, tz);
+}
+
+double rad::RZFieldGrid::InterpolateBilinear(unsigned int ir, unsigned int iz,
+                                             double tr, double tz) const {
+  const double *row0{data + size_t(iz) * nodesR + ir};
+  const double *row1{row0 + nodesR};
+  const double lower{row0[0] + tr * (row0[1] - row0[0])};
+  const double upper{row1[0] + tr * (row1[1] - row1[0])};
+  return lower + tz * (upper - lower);
+}
+
+namespace {
+// Catmull-Rom cubic through four equally spaced values, evaluated at t in
+// [0, 1] between p1 and p2
+inline double CubicConvolution(double p0, double p1, double p2, double p3,
+                               double t) {
+  return p1 + 0.5 * t *
+                  (p2 - p0 +
+                   t * (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3 +
+                        t * (3.0 * (p1 - p2) + p3 - p0)));
+}
+}  // namespace
+
+double rad::RZFieldGrid::InterpolateBicubic(unsigned int ir, unsigned int iz,
+                                            double tr, double tz) const {
+  // 4 x 4 stencil around the cell, clamped at the grid edges
+  int rInd[4];
+  int zInd[4];
+  for (int k{0}; k < 4; k++) {
+    rInd[k] = std::clamp(int(ir) + k - 1, 0, int(nodesR) - 1);
+    zInd[k] = std::clamp(int(iz) + k - 1, 0, int(nodesZ) - 1);
+  }
+
+  double col[4];
+  for (int k{0}; k < 4; k++) {
+    const double *row{data + size_t(zInd[k]) * nodesR};
+    col[k] = CubicConvolution(row[rInd[0]], row[rInd[1]], row[rInd[2]],
+                              row[rInd[3]], tr);
+  }
+  return CubicConvolution(col[0], col[1], col[2], col[3], tz);
+}
+
+rad::RZFieldGrid::GridError rad::RZFieldGrid::CompareToPoints(
+    unsigned int n, const double *r, const double *z,
+    const double *vals) const {
+  GridError err;
+  double sumSq{0};
+  for (unsigned int i{0}; i < n; i++) {
+    if (!IsInside(r[i], z[i])) continue;
+
+    const double diff{std::abs(Interpolate(r[i], z[i]) - vals[i])};
+    sumSq += diff * diff;
+    err.maxAbsError = std::max(err.maxAbsError, diff);
+    if (vals[i] != 0) {
+      err.maxRelError = std::max(err.maxRelError, diff / std::abs(vals[i]));
+    }
+    err.nPoints++;
+  }
+  if (err.nPoints > 0) err.rmsError = std::sqrt(sumSq / double(err.nPoints));
+  return err;
+}
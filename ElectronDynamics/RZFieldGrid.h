@@ -0,0 +1,129 @@
+/*
+  RZFieldGrid.h
+
+  Field values tabulated on a uniform (r, z) grid with constant time lookups
+  Used to replace the scattered-point interpolation of axisymmetric field maps
+*/
+
+#ifndef RZ_FIELD_GRID_H
+#define RZ_FIELD_GRID_H
+
+#include <vector>
+
+namespace rad {
+class RZFieldGrid {
+ public:
+  enum Interp_t { kBilinear, kBicubic };
+
+  /// Summary of the interpolation error against a set of reference points
+  struct GridError {
+    double maxAbsError{0};   // Largest absolute deviation
+    double rmsError{0};      // Root mean square deviation
+    double maxRelError{0};   // Largest deviation relative to reference value
+    unsigned int nPoints{0}; // Number of reference points inside the grid
+  };
+
+  /// @brief Parametrised constructor. The grid owns a copy of the values
+  /// @param rMin Minimum radial coordinate [m]
+  /// @param rMax Maximum radial coordinate [m]
+  /// @param nR Number of grid nodes in r (at least 2)
+  /// @param zMin Minimum axial coordinate [m]
+  /// @param zMax Maximum axial coordinate [m]
+  /// @param nZ Number of grid nodes in z (at least 2)
+  /// @param values Node values, stored with r varying fastest (iz * nR + ir)
+  /// @param interp Interpolation scheme to use
+  RZFieldGrid(double rMin, double rMax, unsigned int nR, double zMin,
+              double zMax, unsigned int nZ, std::vector<double> values,
+              Interp_t interp = kBilinear);
+
+  /// @brief Parametrised constructor for values stored elsewhere (e.g. a
+  /// memory-mapped file). The caller must keep the values alive.
+  /// @param values Pointer to nR * nZ node values (r varying fastest)
+  RZFieldGrid(double rMin, double rMax, unsigned int nR, double zMin,
+              double zMax, unsigned int nZ, const double *values,
+              Interp_t interp = kBilinear);
+
+  RZFieldGrid(const RZFieldGrid &grid);
+
+  RZFieldGrid &operator=(const RZFieldGrid &grid);
+
+  /// @brief Interpolates the tabulated values
+  /// @param r Radial coordinate [m]
+  /// @param z Axial coordinate [m]
+  /// @return Interpolated value, or zero if the point is outside the grid
+  double Interpolate(double r, double z) const;
+
+  /// @brief Checks if a point lies within the grid bounds
+  /// @param r Radial coordinate [m]
+  /// @param z Axial coordinate [m]
+  bool IsInside(double r, double z) const;
+
+  /// @brief Compares the grid to a set of reference points
+  /// @param n Number of reference points
+  /// @param r Array of radial coordinates [m]
+  /// @param z Array of axial coordinates [m]
+  /// @param vals Array of reference values
+  /// @return Summary of the interpolation error
+  GridError CompareToPoints(unsigned int n, const double *r, const double *z,
+                            const double *vals) const;
+
+  void SetInterpolation(Interp_t interp) { method = interp; }
+
+  Interp_t GetInterpolation() const { return method; }
+
+  unsigned int GetNR() const { return nodesR; }
+
+  unsigned int GetNZ() const { return nodesZ; }
+
+  double GetRSpacing() const { return dr; }
+
+  double GetZSpacing() const { return dz; }
+
+  double GetRMin() const { return r0; }
+
+  double GetRMax() const { return r0 + dr * double(nodesR - 1); }
+
+  double GetZMin() const { return z0; }
+
+  double GetZMax() const { return z0 + dz * double(nodesZ - 1); }
+
+  /// @brief Value at a grid node
+  /// @param ir Radial node index
+  /// @param iz Axial node index
+  double GetNodeValue(unsigned int ir, unsigned int iz) const {
+    return data[iz * nodesR + ir];
+  }
+
+ private:
+  double r0;
+  double dr;
+  unsigned int nodesR;
+  double z0;
+  double dz;
+  unsigned int nodesZ;
+  Interp_t method;
+
+  std::vector<double> ownedValues;  // Empty if values are not owned
+  const double *data = 0;
+
+  /// @brief Locates the cell containing a coordinate
+  /// @param x Coordinate
+  /// @param x0 First node coordinate
+  /// @param dx Node spacing
+  /// @param n Number of nodes
+  /// @param t Set to fractional position within the cell
+  /// @return Index of the lower node of the cell
+  static unsigned int FindCell(double x, double x0, double dx, unsigned int n,
+                               double &t);
+
+  double InterpolateBilinear(unsigned int ir, unsigned int iz, double tr,
+                             double tz) const;
+
+  double InterpolateBicubic(unsigned int ir, unsigned int iz, double tr,
+                            double tz) const;
+
+  void CheckDimensions() const;
+};
+}  // namespace rad
+
+#endif
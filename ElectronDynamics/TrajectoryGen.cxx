@@ -2,21 +2,43 @@
 
 #include "ElectronDynamics/TrajectoryGen.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <tuple>
 
+#include "BasicFunctions/TrajectoryInterpolator.h"
 #include "ElectronDynamics/BaseField.h"
 #include "ElectronDynamics/BorisSolver.h"
 #include "TFile.h"
 #include "TMath.h"
+#include "TParameter.h"
 #include "TString.h"
 #include "TTree.h"
 #include "TVector3.h"
 
+namespace {
+// Smallest step, as a fraction of the orbit limited step, that the adaptive
+// controller will shrink to
+constexpr double kMinStepScale{1e-3};
+// Largest fractional change of step size between accepted steps. Abrupt
+// changes shift the centre of the discrete Boris orbit, whereas slow changes
+// leave it in place.
+constexpr double kMaxStepChange{0.01};
+// Steps are only rejected outright once the error estimate exceeds the
+// tolerance by this factor. The field seen over each orbit oscillates, so a
+// tighter limit rejects many steps and makes the step size jump.
+constexpr double kRejectErr{2};
+// Longest adaptive step, in output steps. This also sets the step where the
+// magnetic field vanishes.
+constexpr double kMaxStepOutputs{10};
+}  // namespace
+
 rad::ElectronTrajectoryGen::ElectronTrajectoryGen(
     TString outputFile, BaseField *field, TVector3 initPos, TVector3 initVel,
-    double simStepSize, double simTime, double initialSimTime, double tau) {
+    double simStepSize, double simTime, double initialSimTime, double tau,
+    bool adaptiveStep, unsigned int stepsPerOrbit, double errorTol,
+    unsigned int outputStride, bool writeInitialState) {
   // Check the file path can be opened in
   auto foutTest = std::make_unique<TFile>(outputFile, "RECREATE");
   if (!foutTest) {
@@ -41,6 +63,17 @@ rad::ElectronTrajectoryGen::ElectronTrajectoryGen(
               << std::endl;
     exit(1);
   }
+  if (outputStride == 0) {
+    std::cout << "Invalid output stride (" << outputStride << "). Exiting..."
+              << std::endl;
+    exit(1);
+  }
+  if (adaptiveStep && (stepsPerOrbit == 0 || errorTol <= 0)) {
+    std::cout << "Invalid adaptive step parameters (" << stepsPerOrbit
+              << " steps per orbit, tolerance " << errorTol << "). Exiting..."
+              << std::endl;
+    exit(1);
+  }
 
   // Open the output file
   auto fout = std::make_unique<TFile>(outputFile, "RECREATE");
@@ -72,40 +105,170 @@ rad::ElectronTrajectoryGen::ElectronTrajectoryGen(
   xAcc = eAcc.X();
   yAcc = eAcc.Y();
   zAcc = eAcc.Z();
-  tree->Fill();
+  if (writeInitialState) tree->Fill();
 
   TVector3 ePos = initPos;
   TVector3 eVel = initVel;
 
   double nTimeSteps{round(simTime / simStepSize)};
+  // Only every outputStride-th step is written, along with the final step so
+  // the file covers the full simulation time
+  auto isOutputStep = [outputStride, nTimeSteps](unsigned long i) {
+    return i % outputStride == 0 || double(i + 1) >= nTimeSteps;
+  };
   // Advance through the time steps
   const double printoutTime{1e-6};  // seconds
-  for (int i = 1; i < nTimeSteps; i++) {
-    time = initialSimTime + double(i) * simStepSize;
-    std::tuple<TVector3, TVector3> outputStep =
-        solver.advance_step(simStepSize, ePos, eVel);
+  if (!adaptiveStep) {
+    for (int i = 1; i < nTimeSteps; i++) {
+      time = initialSimTime + double(i) * simStepSize;
+      std::tuple<TVector3, TVector3, TVector3> outputStep =
+          solver.advance_step_with_acc(simStepSize, ePos, eVel);
+
+      if (std::fmod(time, printoutTime) < simStepSize) {
+        std::cout << time << " seconds of trajectory simulated..."
+                  << std::endl;
+      }
+
+      ePos = std::get<0>(outputStep);
+      eVel = std::get<1>(outputStep);
+      eAcc = std::get<2>(outputStep);
+      if (!isOutputStep(i)) continue;
 
-    if (std::fmod(time, printoutTime) < simStepSize) {
-      std::cout << time << " seconds of trajectory simulated..." << std::endl;
+      xPos = ePos.X();
+      yPos = ePos.Y();
+      zPos = ePos.Z();
+      xVel = eVel.X();
+      yVel = eVel.Y();
+      zVel = eVel.Z();
+      xAcc = eAcc.X();
+      yAcc = eAcc.Y();
+      zAcc = eAcc.Z();
+
+      tree->Fill();
     }
+  } else {
+    // Each step is limited to a fraction of the local cyclotron orbit and
+    // further shrunk if the estimated phase or energy error is too large.
+    // The states are then interpolated onto the uniform output grid.
+    const double c2{TMath::C() * TMath::C()};
+    auto gammaOf = [c2](TVector3 v) { return 1 / sqrt(1 - v.Mag2() / c2); };
+    // Cyclotron angular frequency
+    auto omegaOf = [](TVector3 B, double gamma) {
+      return TMath::Qe() * B.Mag() / (gamma * ME);
+    };
+
+    double t0{initialSimTime};
+    TVector3 B0{field->evaluate_field_at_point(ePos)};
+    TVector3 E0{field->evaluate_e_field_at_point(ePos)};
+    double gamma0{gammaOf(eVel)};
+    double omega0{omegaOf(B0, gamma0)};
+    // Previous accepted step, for the phase error estimate
+    double omegaPrev{omega0};
+    double hPrev{0};
+
+    const double maxStep{kMaxStepOutputs * simStepSize};
+    double stepScale{1};
+    unsigned long nSteps{0};
+    unsigned long iOut{1};
+    while (double(iOut) < nTimeSteps) {
+      if (!std::isfinite(omega0)) {
+        std::cout << "Non-finite field at (" << ePos.X() << ", " << ePos.Y()
+                  << ", " << ePos.Z() << ") m. Exiting..." << std::endl;
+        exit(1);
+      }
+      const double orbitStep{
+          omega0 > 0 ? TMath::TwoPi() / (omega0 * stepsPerOrbit) : maxStep};
+      const double h{std::min(orbitStep, maxStep) * stepScale};
+      // The fields at the end of the step give both the acceleration and
+      // the error estimate
+      auto [pos1, vel1] = solver.advance_step(h, ePos, eVel);
+      const TVector3 B1{field->evaluate_field_at_point(pos1)};
+      const TVector3 E1{field->evaluate_e_field_at_point(pos1)};
+      const TVector3 acc1{solver.acc_from_fields(B1, E1, vel1)};
+      const double gamma1{gammaOf(vel1)};
+      const double omega1{omegaOf(B1, gamma1)};
+
+      // The rotation angle is a midpoint estimate of the integrated cyclotron
+      // phase, with error h^3 omega'' / 24
+      double phaseErr{0};
+      if (hPrev > 0) {
+        const double omegaDD{2 *
+                             ((omega1 - omega0) / h -
+                              (omega0 - omegaPrev) / hPrev) /
+                             (h + hPrev)};
+        phaseErr = h * h * h * std::abs(omegaDD) / 24;
+      }
+      // Kinetic energy change not accounted for by the work done by E
+      const double work{-TMath::Qe() * 0.5 * (E0 + E1).Dot(pos1 - ePos) /
+                        (ME * c2)};
+      const double energyErr{std::abs(gamma1 - gamma0 - work) / (gamma0 - 1)};
+      const double err{std::max(phaseErr, energyErr) / errorTol};
 
-    ePos = std::get<0>(outputStep);
-    eVel = std::get<1>(outputStep);
-    eAcc = solver.acc(ePos, eVel);
-
-    xPos = ePos.X();
-    yPos = ePos.Y();
-    zPos = ePos.Z();
-    xVel = eVel.X();
-    yVel = eVel.Y();
-    zVel = eVel.Z();
-    xAcc = eAcc.X();
-    yAcc = eAcc.Y();
-    zAcc = eAcc.Z();
-
-    tree->Fill();
+      // Controller for a third order local error. Failed steps are retried
+      // with a smaller step
+      const double factor{err > 0 ? 0.9 * std::cbrt(1 / err) : 2.0};
+      if (err > kRejectErr && stepScale > kMinStepScale) {
+        stepScale = std::max(kMinStepScale, stepScale * std::max(0.5, factor));
+        continue;
+      }
+      nSteps++;
+
+      // Write out all the output times within this step. The stored
+      // acceleration uses the rest mass, so the time derivative of the
+      // velocity is acc / gamma.
+      const double t1{t0 + h};
+      const TVector3 dv0{eAcc * (1 / gamma0)};
+      const TVector3 dv1{acc1 * (1 / gamma1)};
+      double tOut{initialSimTime + double(iOut) * simStepSize};
+      while (tOut <= t1 && double(iOut) < nTimeSteps) {
+        if (isOutputStep(iOut)) {
+          const double x{(tOut - t0) / h};
+          const TVector3 p{TrajectoryInterpolator::QuinticHermite(
+              ePos, eVel, dv0, pos1, vel1, dv1, h, x)};
+          TVector3 v, dv;
+          TrajectoryInterpolator::CubicHermite(eVel, dv0, vel1, dv1, h, x, v,
+                                               dv);
+          const TVector3 a{dv * gammaOf(v)};
+          time = tOut;
+          xPos = p.X();
+          yPos = p.Y();
+          zPos = p.Z();
+          xVel = v.X();
+          yVel = v.Y();
+          zVel = v.Z();
+          xAcc = a.X();
+          yAcc = a.Y();
+          zAcc = a.Z();
+          tree->Fill();
+        }
+
+        if (std::fmod(tOut, printoutTime) < simStepSize) {
+          std::cout << tOut << " seconds of trajectory simulated..."
+                    << std::endl;
+        }
+        iOut++;
+        tOut = initialSimTime + double(iOut) * simStepSize;
+      }
+
+      t0 = t1;
+      ePos = pos1;
+      eVel = vel1;
+      eAcc = acc1;
+      E0 = E1;
+      gamma0 = gamma1;
+      omegaPrev = omega0;
+      omega0 = omega1;
+      hPrev = h;
+      stepScale *= std::clamp(factor, 1 - kMaxStepChange, 1 + kMaxStepChange);
+      stepScale = std::clamp(stepScale, kMinStepScale, 1.0);
+    }
+    std::cout << "Adaptive integration used " << nSteps << " steps for "
+              << nTimeSteps << " output points" << std::endl;
   }
   fout->cd();
   tree->Write("", TObject::kOverwrite);
+  // Record the simulation step so readers can reconstruct the skipped steps
+  TParameter<double> stepParam("simStepSize", simStepSize);
+  stepParam.Write();
   fout->Close();
 }
\ No newline at end of file
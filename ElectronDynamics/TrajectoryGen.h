@@ -29,9 +29,27 @@ class ElectronTrajectoryGen {
   /// \param simStepSize The time to simulate in seconds
   /// \param initialSimTime The initial time in the simulation. Default is 0
   /// \param tau Energy loss. Default is 0
+  /// \param adaptiveStep Choose the integration step from the local field.
+  /// The output is still written every simStepSize. Default is false
+  /// \param stepsPerOrbit Steps per local cyclotron orbit in adaptive mode.
+  /// The error control may shorten steps further
+  /// \param errorTol Allowed phase [rad] and relative energy error per step
+  /// in adaptive mode
+  /// \param outputStride Write only every outputStride-th step to the file.
+  /// Readers reconstruct the skipped steps by interpolation, which keeps the
+  /// velocity error around 0.1% with eight stored states per cyclotron orbit.
+  /// Default is 1
+  /// \param writeInitialState Write the initial state to the file. Set to
+  /// false when continuing a trajectory whose last state is the initial state,
+  /// so it is not written twice. Default is true
   ElectronTrajectoryGen(TString outputFile, BaseField *field, TVector3 initPos,
                         TVector3 initVel, double simStepSize, double simTime,
-                        double initialSimTime = 0.0, double tau = 0.0);
+                        double initialSimTime = 0.0, double tau = 0.0,
+                        bool adaptiveStep = false,
+                        unsigned int stepsPerOrbit = 40,
+                        double errorTol = 1e-8,
+                        unsigned int outputStride = 1,
+                        bool writeInitialState = true);
 
   /// Generates the trajectory with the specified parameters
   /// void GenerateTraj();
@@ -2,62 +2,30 @@
 
 #include "FieldClasses/FieldClasses.h"
 
-#include <cassert>
+#include <algorithm>
 #include <cmath>
+#include <iostream>
+#include <span>
 #include <vector>
 
 #include "Antennas/IAntenna.h"
 #include "BasicFunctions/BasicFunctions.h"
 #include "BasicFunctions/Constants.h"
+#include "BasicFunctions/TrajectoryInterpolator.h"
+#include "BasicFunctions/TrajectorySource.h"
+#include "FieldClasses/MultiFieldPoint.h"
 #include "Math/Point3D.h"
 #include "Math/Vector3D.h"
 #include "TAxis.h"
 #include "TFile.h"
 #include "TGraph.h"
 #include "TSpline.h"
-#include "TTree.h"
 #include "TVector3.h"
 
-rad::FieldPoint::~FieldPoint() {
-  delete EField[0];
-  delete EField[1];
-  delete EField[2];
-  delete BField[0];
-  delete BField[1];
-  delete BField[2];
-
-  delete pos[0];
-  delete pos[1];
-  delete pos[2];
-
-  delete tPrime;
-}
-
 // Parametrised constructor
 rad::FieldPoint::FieldPoint(TString trajectoryFilePath, IAntenna* myAnt) {
-  EField[0] = new TGraph();
-  EField[1] = new TGraph();
-  EField[2] = new TGraph();
-  BField[0] = new TGraph();
-  BField[1] = new TGraph();
-  BField[2] = new TGraph();
-  pos[0] = new TGraph();
-  pos[1] = new TGraph();
-  pos[2] = new TGraph();
-  tPrime = new TGraph();
-
   // Now check that the input file exists
-  TFile* f = new TFile(trajectoryFilePath, "read");
-  assert(f);
-  TTree* tree = (TTree*)f->Get("tree");
-  assert(tree);
-  double timeTemp;
-  tree->SetBranchAddress("time", &timeTemp);
-  tree->GetEntry(0);
-  fileStartTime = timeTemp;
-  delete tree;
-  f->Close();
-  delete f;
+  fileStartTime = TrajectorySource::Open(trajectoryFilePath)->GetStartTime();
   inputFile = trajectoryFilePath;
 
   myAntenna = myAnt;
@@ -66,92 +34,110 @@ rad::FieldPoint::FieldPoint(TString trajectoryFilePath, IAntenna* myAnt) {
   maxCutTime = 0.0;
 }
 
-// Copy constructor
-rad::FieldPoint::FieldPoint(const FieldPoint& fp) {
-  inputFile = fp.inputFile;
-
-  // Clone the field graphs
+void rad::FieldPoint::ResetFields() {
+  // Keep the allocations for the next time chunk
+  times.clear();
   for (int coord = 0; coord < 3; coord++) {
-    EField[coord] = (TGraph*)fp.EField[coord]->Clone();
-    BField[coord] = (TGraph*)fp.BField[coord]->Clone();
-    pos[coord] = (TGraph*)fp.pos[coord]->Clone();
+    EField[coord].clear();
+    BField[coord].clear();
+    pos[coord].clear();
   }
-  tPrime = (TGraph*)fp.tPrime->Clone();
-  fileStartTime = fp.fileStartTime;
-  myAntenna = fp.myAntenna;
-
-  minCutTime = fp.minCutTime;
-  maxCutTime = fp.maxCutTime;
+  antennaTimes.clear();
 }
 
-void rad::FieldPoint::ResetFields() {
-  EField[0]->Clear();
-  EField[1]->Clear();
-  EField[2]->Clear();
-  BField[0]->Clear();
-  BField[1]->Clear();
-  BField[2]->Clear();
-  pos[0]->Clear();
-  pos[1]->Clear();
-  pos[2]->Clear();
-  tPrime->Clear();
+void rad::FieldPoint::StorePoint(const double time, const double antennaTime,
+                                 const ROOT::Math::XYZVector& E,
+                                 const ROOT::Math::XYZVector& B,
+                                 const ROOT::Math::XYZPoint& ePos) {
+  times.push_back(time);
+  EField[0].push_back(E.X());
+  EField[1].push_back(E.Y());
+  EField[2].push_back(E.Z());
+  BField[0].push_back(B.X());
+  BField[1].push_back(B.Y());
+  BField[2].push_back(B.Z());
+  pos[0].push_back(ePos.X());
+  pos[1].push_back(ePos.Y());
+  pos[2].push_back(ePos.Z());
+  antennaTimes.push_back(antennaTime);
+}
 
-  for (int coord = 0; coord < 3; coord++) {
-    delete EField[coord];
-    delete BField[coord];
-    delete pos[coord];
+void rad::FieldPoint::SelectPoints(const bool kUseRetardedTime,
+                                   int firstPoint, int lastPoint,
+                                   size_t& first, size_t& end) const {
+  // With the retarded time, points before the fields from the first state
+  // reach the antenna cannot be calculated
+  size_t start = 0;
+  if (kUseRetardedTime && !antennaTimes.empty()) {
+    start = std::lower_bound(times.begin(), times.end(), antennaTimes[0]) -
+            times.begin();
   }
-  delete tPrime;
+  first = start + (firstPoint < 0 ? 0 : size_t(firstPoint));
+  end = (lastPoint < 0) ? times.size() : start + size_t(lastPoint) + 1;
+  end = std::min(end, times.size());
+
+  // Trim to the cut times
+  const size_t firstCut =
+      std::lower_bound(times.begin(), times.end(), minCutTime) - times.begin();
+  const size_t endCut =
+      std::lower_bound(times.begin(), times.end(), maxCutTime) - times.begin();
+  first = std::max(first, firstCut);
+  end = std::min(end, endCut);
+  if (end < first) end = first;
+}
 
-  for (int coord = 0; coord < 3; coord++) {
-    EField[coord] = new TGraph();
-    BField[coord] = new TGraph();
-    pos[coord] = new TGraph();
-    tPrime = new TGraph();
+std::vector<double> rad::FieldPoint::GetRetardedTimes(size_t first,
+                                                      size_t end) const {
+  std::vector<double> tRet(end - first);
+  if (tRet.empty()) return tRet;
+  // Relationship between the time at the antenna and the retarded time
+  TSpline3 sptPrime("sptPrime", antennaTimes.data(), times.data(),
+                    int(times.size()));
+  for (size_t i = 0; i < tRet.size(); i++) {
+    tRet[i] = sptPrime.Eval(times[first + i]);
   }
+  return tRet;
 }
 
-/*
-  Takes the inputted TGraph and produces the same variable plotted using the
-  retarded time grOriginal is the inputted TGraph returns a TGraph which takes
-  the retarded time into account
- */
-TGraph* rad::FieldPoint::MakeRetardedTimeGraph(const TGraph* grOriginal) {
-  TSpline3* sptPrime = new TSpline3("sptPrime", tPrime);
-  TSpline3* spgrOriginal = new TSpline3("spgrOriginal", grOriginal);
-
-  // Need to work out the first time that we should take this spline from
-  double timeToStart = tPrime->GetPointX(0);
-
-  TGraph* grOut = new TGraph();
-  for (int i = 0; i < grOriginal->GetN(); i++) {
-    if (grOriginal->GetPointX(i) < timeToStart) continue;
-    double tRet = sptPrime->Eval(grOriginal->GetPointX(i));
-    grOut->SetPoint(grOut->GetN(), grOriginal->GetPointX(i),
-                    spgrOriginal->Eval(tRet));
-  }
-  setGraphAttr(grOut);
-  grOut->GetXaxis()->SetTitle("Time [s]");
-  grOut->GetYaxis()->SetTitle(grOriginal->GetYaxis()->GetTitle());
+std::vector<double> rad::FieldPoint::InterpolateValues(
+    std::span<const double> values, std::span<const double> evalTimes) const {
+  std::vector<double> out(evalTimes.size());
+  if (out.empty()) return out;
+  TSpline3 sp("spValues", times.data(), values.data(), int(times.size()));
+  for (size_t i = 0; i < out.size(); i++) out[i] = sp.Eval(evalTimes[i]);
+  return out;
+}
 
-  delete sptPrime;
-  delete spgrOriginal;
-  return grOut;
+TGraph* rad::FieldPoint::MakeTimeGraph(std::span<const double> values,
+                                       size_t first,
+                                       const char* yTitle) const {
+  // Fill the graph's own arrays rather than adding points one at a time
+  TGraph* gr = new TGraph(int(values.size()));
+  double* x = gr->GetX();
+  double* y = gr->GetY();
+  for (size_t i = 0; i < values.size(); i++) {
+    x[i] = times[first + i];
+    y[i] = values[i];
+  }
+  setGraphAttr(gr);
+  gr->GetXaxis()->SetTitle("Time [s]");
+  gr->GetYaxis()->SetTitle(yTitle);
+  return gr;
 }
 
-TGraph* rad::FieldPoint::TrimGraphToTime(const TGraph* grIn) {
-  TGraph* grOut = new TGraph();
-  setGraphAttr(grOut);
-  grOut->GetXaxis()->SetTitle("Time [s]");
-  grOut->GetYaxis()->SetTitle(grIn->GetYaxis()->GetTitle());
-  for (int i = 0; i < grIn->GetN(); i++) {
-    double thisTime = grIn->GetPointX(i);
-    if (thisTime < minCutTime) continue;
-    if (thisTime >= maxCutTime) break;
-
-    grOut->SetPoint(grOut->GetN(), thisTime, grIn->GetPointY(i));
+TGraph* rad::FieldPoint::MakeTimeDomainGraph(std::span<const double> values,
+                                             const bool kUseRetardedTime,
+                                             const char* yTitle,
+                                             int firstPoint,
+                                             int lastPoint) const {
+  size_t first, end;
+  SelectPoints(kUseRetardedTime, firstPoint, lastPoint, first, end);
+  if (!kUseRetardedTime) {
+    return MakeTimeGraph(values.subspan(first, end - first), first, yTitle);
   }
-  return grOut;
+  const std::vector<double> retValues =
+      InterpolateValues(values, GetRetardedTimes(first, end));
+  return MakeTimeGraph(retValues, first, yTitle);
 }
 
 // From an input TFile generate the E and B fields for a given time
@@ -163,36 +149,10 @@ void rad::FieldPoint::GenerateFields(const double minTime,
   minCutTime = minTime;
   maxCutTime = maxTime;
 
-  TFile* fin = new TFile(inputFile, "READ");
-  assert(fin);
-  TTree* tree = (TTree*)fin->Get("tree");
-
-  // Set variables
-  double time;
-  double xPos, yPos, zPos;
-  double xVel, yVel, zVel;
-  double xAcc, yAcc, zAcc;
-  tree->SetBranchAddress("time", &time);
-  tree->SetBranchAddress("xPos", &xPos);
-  tree->SetBranchAddress("yPos", &yPos);
-  tree->SetBranchAddress("zPos", &zPos);
-  tree->SetBranchAddress("xVel", &xVel);
-  tree->SetBranchAddress("yVel", &yVel);
-  tree->SetBranchAddress("zVel", &zVel);
-  tree->SetBranchAddress("xAcc", &xAcc);
-  tree->SetBranchAddress("yAcc", &yAcc);
-  tree->SetBranchAddress("zAcc", &zAcc);
-
   ROOT::Math::XYZPoint antennaPoint((myAntenna->GetAntennaPosition()).X(),
                                     (myAntenna->GetAntennaPosition()).Y(),
                                     (myAntenna->GetAntennaPosition()).Z());
 
-  tree->GetEntry(0);
-  const double t0 = time;
-  tree->GetEntry(1);
-  const double t1 = time;
-  const double timeStepSize = t1 - t0;
-
   double minGenTime,
       maxGenTime;  // Minimum and maximum time to generate the fields between
   // If we are at the start of the file then work as normal
@@ -207,318 +167,235 @@ void rad::FieldPoint::GenerateFields(const double minTime,
     maxGenTime = maxTime;
   }
 
+  // Decimated files are reconstructed at the simulation step
+  TrajectoryInterpolator traj(inputFile);
+  const double timeStepSize = traj.GetSimStepSize();
+  if (traj.IsDecimated()) {
+    const double t0 = traj.GetStartTime();
+    const unsigned long nSteps = traj.GetNSimSteps();
+    unsigned long firstStep = 0;
+    if (minGenTime > t0)
+      firstStep = (unsigned long)(std::ceil((minGenTime - t0) / timeStepSize));
+    for (unsigned long i = firstStep; i < nSteps; i++) {
+      const double time = t0 + double(i) * timeStepSize;
+      if (time > maxGenTime) break;
+
+      if (std::fmod(time, 1e-6) < timeStepSize) {
+        std::cout << time << " seconds generated..." << std::endl;
+      }
+
+      TVector3 p, v, a;
+      traj.GetState(time, p, v, a);
+      AddFieldPoint(antennaPoint, time,
+                    ROOT::Math::XYZPoint(p.X(), p.Y(), p.Z()),
+                    ROOT::Math::XYZVector(v.X(), v.Y(), v.Z()),
+                    ROOT::Math::XYZVector(a.X(), a.Y(), a.Z()));
+    }
+    return;
+  }
+
+  // Go straight to the first entry needed, so that processing a file in
+  // chunks only reads each entry once
+  TrajectorySource& source = traj.GetSource();
+  size_t firstEntry, endEntry;
+  source.FindRange(minGenTime, maxGenTime, firstEntry, endEntry);
+  source.PrepareRange(firstEntry, endEntry);
+
   // Loop through the entries and get the fields at each point
-  for (int e = 0; e < tree->GetEntries(); e++) {
-    tree->GetEntry(e);
-    if (time < minGenTime) continue;
-    if (time > maxGenTime) break;
+  TrajectoryPoint pt;
+  source.Seek(firstEntry);
+  for (size_t e = firstEntry; e < endEntry && source.Next(pt); e++) {
+    const double time = pt.time;
 
     if (std::fmod(time, 1e-6) < timeStepSize) {
       std::cout << time << " seconds generated..." << std::endl;
     }
 
-    ROOT::Math::XYZPoint ePos(xPos, yPos, zPos);
-    ROOT::Math::XYZVector eVel(xVel, yVel, zVel);
-    ROOT::Math::XYZVector eAcc(xAcc, yAcc, zAcc);
-    ROOT::Math::XYZVector EFieldCalc =
-        CalcEField(antennaPoint, ePos, eVel, eAcc);
-    ROOT::Math::XYZVector BFieldCalc =
-        CalcBField(antennaPoint, ePos, eVel, eAcc);
-
-    EField[0]->SetPoint(EField[0]->GetN(), time, EFieldCalc.X());
-    EField[1]->SetPoint(EField[1]->GetN(), time, EFieldCalc.Y());
-    EField[2]->SetPoint(EField[2]->GetN(), time, EFieldCalc.Z());
-    BField[0]->SetPoint(BField[0]->GetN(), time, BFieldCalc.X());
-    BField[1]->SetPoint(BField[1]->GetN(), time, BFieldCalc.Y());
-    BField[2]->SetPoint(BField[2]->GetN(), time, BFieldCalc.Z());
-
-    pos[0]->SetPoint(pos[0]->GetN(), time, xPos);
-    pos[1]->SetPoint(pos[1]->GetN(), time, yPos);
-    pos[2]->SetPoint(pos[2]->GetN(), time, zPos);
-
-    tPrime->SetPoint(tPrime->GetN(),
-                     CalcTimeFromRetardedTime(antennaPoint, ePos, time), time);
+    AddFieldPoint(antennaPoint, time,
+                  ROOT::Math::XYZPoint(pt.pos.X(), pt.pos.Y(), pt.pos.Z()),
+                  ROOT::Math::XYZVector(pt.vel.X(), pt.vel.Y(), pt.vel.Z()),
+                  ROOT::Math::XYZVector(pt.acc.X(), pt.acc.Y(), pt.acc.Z()));
   }
-
-  delete tree;
-  fin->Close();
-  delete fin;
 }
 
-TGraph* rad::FieldPoint::GetEFieldTimeDomain(Coord_t coord,
-                                             const bool kUseRetardedTime,
-                                             int firstPoint, int lastPoint) {
-  TGraph* gr = 0;
-  TGraph* grOut = new TGraph();
-  if (coord == kX) {
-    gr = (TGraph*)EField[0]->Clone("grEx");
-    grOut->GetYaxis()->SetTitle("E_{x} [V m^{-1}]");
-  } else if (coord == kY) {
-    gr = (TGraph*)EField[1]->Clone("grEy");
-    grOut->GetYaxis()->SetTitle("E_{y} [V m^{-1}]");
-  } else if (coord == kZ) {
-    gr = (TGraph*)EField[2]->Clone("grEz");
-    grOut->GetYaxis()->SetTitle("E_{z} [V m^{-1}]");
+void rad::FieldPoint::SetFields(const MultiFieldPoint& mfp, size_t iAnt,
+                                const double minTime, const double maxTime) {
+  if (mfp.GetAntenna(iAnt) != myAntenna) {
+    std::cout << "Fields were calculated for a different antenna. Exiting."
+              << std::endl;
+    exit(1);
   }
 
-  setGraphAttr(grOut);
-  grOut->GetXaxis()->SetTitle("Time [s]");
-  if (!kUseRetardedTime) {
-    if (firstPoint < 0) firstPoint = 0;
-    if (lastPoint < 0) lastPoint = gr->GetN() - 1;
+  ResetFields();
 
-    for (int i = firstPoint; i <= lastPoint; i++) {
-      grOut->SetPoint(grOut->GetN(), gr->GetPointX(i), gr->GetPointY(i));
-    }
-  } else {
-    TGraph* grRet = MakeRetardedTimeGraph(gr);
-    if (firstPoint < 0) firstPoint = 0;
-    if (lastPoint < 0) lastPoint = grRet->GetN() - 1;
+  minCutTime = minTime;
+  maxCutTime = maxTime;
 
-    for (int i = firstPoint; i <= lastPoint; i++) {
-      grOut->SetPoint(grOut->GetN(), grRet->GetPointX(i), grRet->GetPointY(i));
-    }
-    delete grRet;
+  // Same time range as GenerateFields
+  const double minGenTime =
+      (fileStartTime == minTime) ? minTime : minTime - 4e-9;
+  const double maxGenTime = maxTime;
+
+  // Copy the whole range across at once
+  std::span<const double> mfpTimes = mfp.GetTimes();
+  const size_t first =
+      std::lower_bound(mfpTimes.begin(), mfpTimes.end(), minGenTime) -
+      mfpTimes.begin();
+  const size_t end =
+      std::upper_bound(mfpTimes.begin(), mfpTimes.end(), maxGenTime) -
+      mfpTimes.begin();
+  if (end <= first) return;
+
+  auto CopyRange = [&](std::span<const double> in, std::vector<double>& out) {
+    out.assign(in.begin() + first, in.begin() + end);
+  };
+  CopyRange(mfpTimes, times);
+  for (int coord = 0; coord < 3; coord++) {
+    CopyRange(mfp.GetEField(iAnt, Coord_t(coord)), EField[coord]);
+    CopyRange(mfp.GetBField(iAnt, Coord_t(coord)), BField[coord]);
+    CopyRange(mfp.GetPosition(Coord_t(coord)), pos[coord]);
   }
-  delete gr;
-  TGraph* grTrimmed = TrimGraphToTime(grOut);
-  delete grOut;
-  return grTrimmed;
+  CopyRange(mfp.GetAntennaTimes(iAnt), antennaTimes);
+}
+
+void rad::FieldPoint::AddFieldPoint(const ROOT::Math::XYZPoint& antennaPoint,
+                                    const double time,
+                                    const ROOT::Math::XYZPoint& ePos,
+                                    const ROOT::Math::XYZVector& eVel,
+                                    const ROOT::Math::XYZVector& eAcc) {
+  ROOT::Math::XYZVector EFieldCalc =
+      CalcEField(antennaPoint, ePos, eVel, eAcc);
+  ROOT::Math::XYZVector BFieldCalc =
+      CalcBField(antennaPoint, ePos, eVel, eAcc);
+
+  StorePoint(time, CalcTimeFromRetardedTime(antennaPoint, ePos, time),
+             EFieldCalc, BFieldCalc, ePos);
+}
+
+TGraph* rad::FieldPoint::GetEFieldTimeDomain(Coord_t coord,
+                                             const bool kUseRetardedTime,
+                                             int firstPoint, int lastPoint) {
+  const char* titles[3] = {"E_{x} [V m^{-1}]", "E_{y} [V m^{-1}]",
+                           "E_{z} [V m^{-1}]"};
+  return MakeTimeDomainGraph(EField[coord], kUseRetardedTime, titles[coord],
+                             firstPoint, lastPoint);
 }
 
 TGraph* rad::FieldPoint::GetPositionTimeDomain(Coord_t coord,
                                                const bool kUseRetardedTime,
                                                int firstPoint, int lastPoint) {
-  TGraph* gr = 0;
-  TGraph* grOut = new TGraph();
-  if (coord == kX) {
-    gr = (TGraph*)pos[0]->Clone("grPosx");
-    grOut->GetYaxis()->SetTitle("x [m]");
-  } else if (coord == kY) {
-    gr = (TGraph*)pos[1]->Clone("grPosy");
-    grOut->GetYaxis()->SetTitle("y [m]");
-  } else if (coord == kZ) {
-    gr = (TGraph*)pos[2]->Clone("grPosz");
-    grOut->GetYaxis()->SetTitle("z [m]");
-  }
-
-  setGraphAttr(grOut);
-  grOut->GetXaxis()->SetTitle("Time [s]");
-  if (!kUseRetardedTime) {
-    if (firstPoint < 0) firstPoint = 0;
-    if (lastPoint < 0) lastPoint = gr->GetN() - 1;
-
-    for (int i = firstPoint; i <= lastPoint; i++) {
-      grOut->SetPoint(grOut->GetN(), gr->GetPointX(i), gr->GetPointY(i));
-    }
-  } else {
-    TGraph* grRet = MakeRetardedTimeGraph(gr);
-    if (firstPoint < 0) firstPoint = 0;
-    if (lastPoint < 0) lastPoint = grRet->GetN() - 1;
-
-    for (int i = firstPoint; i <= lastPoint; i++) {
-      grOut->SetPoint(grOut->GetN(), grRet->GetPointX(i), grRet->GetPointY(i));
-    }
-    delete grRet;
-  }
-  delete gr;
-  TGraph* grTrimmed = TrimGraphToTime(grOut);
-  delete grOut;
-  return grTrimmed;
+  const char* titles[3] = {"x [m]", "y [m]", "z [m]"};
+  return MakeTimeDomainGraph(pos[coord], kUseRetardedTime, titles[coord],
+                             firstPoint, lastPoint);
 }
 
 TGraph* rad::FieldPoint::GetEFieldMagTimeDomain(const bool kUseRetardedTime) {
-  TGraph* grMag = new TGraph();
-  assert((EField[0]->GetN() == EField[1]->GetN()) &&
-         (EField[1]->GetN() == EField[2]->GetN()));
-
-  for (int i = 0; i < EField[0]->GetN(); i++) {
-    double mag =
-        sqrt(pow(EField[0]->GetPointY(i), 2) + pow(EField[1]->GetPointY(i), 2) +
-             pow(EField[2]->GetPointY(i), 2));
-    grMag->SetPoint(grMag->GetN(), EField[0]->GetPointX(i), mag);
-  }
-  setGraphAttr(grMag);
-  grMag->GetXaxis()->SetTitle("Time [s]");
-  grMag->GetYaxis()->SetTitle("|E| [V m^{-1}]");
-
-  if (!kUseRetardedTime) {
-    TGraph* grTrimmed = TrimGraphToTime(grMag);
-    delete grMag;
-    return grTrimmed;
-  } else {
-    TGraph* grMagRet = MakeRetardedTimeGraph(grMag);
-    delete grMag;
-    TGraph* grTrimmed = TrimGraphToTime(grMagRet);
-    delete grMagRet;
-    return grTrimmed;
+  std::vector<double> mag(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    mag[i] = sqrt(pow(EField[0][i], 2) + pow(EField[1][i], 2) +
+                  pow(EField[2][i], 2));
   }
+  return MakeTimeDomainGraph(mag, kUseRetardedTime, "|E| [V m^{-1}]");
 }
 
 TGraph* rad::FieldPoint::GetBFieldTimeDomain(Coord_t coord,
                                              const bool kUseRetardedTime) {
-  TGraph* gr = 0;
-  if (coord == kX) {
-    gr = (TGraph*)BField[0]->Clone("grBx");
-    gr->GetYaxis()->SetTitle("B_{x} [T]");
-  } else if (coord == kY) {
-    gr = (TGraph*)BField[1]->Clone("grBy");
-    gr->GetYaxis()->SetTitle("B_{y} [T]");
-  } else if (coord == kZ) {
-    gr = (TGraph*)BField[2]->Clone("grBz");
-    gr->GetYaxis()->SetTitle("B_{z} [T]");
-  }
-  setGraphAttr(gr);
-  gr->GetXaxis()->SetTitle("Time [s]");
-
-  if (!kUseRetardedTime) {
-    TGraph* grTrimmed = TrimGraphToTime(gr);
-    delete gr;
-    return grTrimmed;
-  } else {
-    TGraph* grRet = MakeRetardedTimeGraph(gr);
-    delete gr;
-    TGraph* grTrimmed = TrimGraphToTime(grRet);
-    delete grRet;
-    return grTrimmed;
-  }
+  const char* titles[3] = {"B_{x} [T]", "B_{y} [T]", "B_{z} [T]"};
+  return MakeTimeDomainGraph(BField[coord], kUseRetardedTime, titles[coord]);
 }
 
 TGraph* rad::FieldPoint::GetBFieldMagTimeDomain(const bool kUseRetardedTime) {
-  TGraph* grMag = new TGraph();
-  assert((BField[0]->GetN() == BField[1]->GetN()) &&
-         (BField[1]->GetN() == BField[2]->GetN()));
-
-  for (int i = 0; i < BField[0]->GetN(); i++) {
-    double mag =
-        sqrt(pow(BField[0]->GetPointY(i), 2) + pow(BField[1]->GetPointY(i), 2) +
-             pow(BField[2]->GetPointY(i), 2));
-    grMag->SetPoint(grMag->GetN(), BField[0]->GetPointX(i), mag);
-  }
-  setGraphAttr(grMag);
-  grMag->GetXaxis()->SetTitle("Time [s]");
-  grMag->GetYaxis()->SetTitle("|B| [T]");
-
-  if (!kUseRetardedTime) {
-    TGraph* grTrimmed = TrimGraphToTime(grMag);
-    delete grMag;
-    return grTrimmed;
-  } else {
-    TGraph* grMagRet = MakeRetardedTimeGraph(grMag);
-    delete grMag;
-    TGraph* grTrimmed = TrimGraphToTime(grMagRet);
-    delete grMagRet;
-    return grTrimmed;
+  std::vector<double> mag(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    mag[i] = sqrt(pow(BField[0][i], 2) + pow(BField[1][i], 2) +
+                  pow(BField[2][i], 2));
   }
+  return MakeTimeDomainGraph(mag, kUseRetardedTime, "|B| [T]");
 }
 
 TGraph* rad::FieldPoint::GetPoyntingVecTimeDomain(Coord_t coord,
                                                   const bool kUseRetardedTime) {
-  TGraph* grS = new TGraph();
-  for (int i = 0; i < EField[0]->GetN(); i++) {
-    double comp = 0;
-    if (coord == kX) {
-      grS->GetYaxis()->SetTitle("S_{x} [W m^{-2}]");
-      comp = EField[1]->GetPointY(i) * BField[2]->GetPointY(i) -
-             EField[2]->GetPointY(i) * BField[1]->GetPointY(i);
-    } else if (coord == kY) {
-      comp = EField[2]->GetPointY(i) * BField[0]->GetPointY(i) -
-             EField[0]->GetPointY(i) * BField[2]->GetPointY(i);
-      grS->GetYaxis()->SetTitle("S_{y} [W m^{-2}]");
-    } else if (coord == kZ) {
-      comp = EField[0]->GetPointY(i) * BField[1]->GetPointY(i) -
-             EField[1]->GetPointY(i) * BField[0]->GetPointY(i);
-      grS->GetYaxis()->SetTitle("S_{z} [W m^{-2}]");
-    }
-    comp /= MU0;
-    grS->SetPoint(i, EField[0]->GetPointX(i), comp);
-  }
-  setGraphAttr(grS);
-  grS->GetXaxis()->SetTitle("Time [s]");
-
-  if (!kUseRetardedTime) {
-    TGraph* grTrimmed = TrimGraphToTime(grS);
-    delete grS;
-    return grTrimmed;
-  } else {
-    TGraph* grSRet = MakeRetardedTimeGraph(grS);
-    delete grS;
-    TGraph* grTrimmed = TrimGraphToTime(grSRet);
-    delete grSRet;
-    return grTrimmed;
+  const char* titles[3] = {"S_{x} [W m^{-2}]", "S_{y} [W m^{-2}]",
+                           "S_{z} [W m^{-2}]"};
+  // Components making up this component of the cross product
+  const int c1 = (coord + 1) % 3;
+  const int c2 = (coord + 2) % 3;
+  std::vector<double> comp(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    comp[i] = EField[c1][i] * BField[c2][i] - EField[c2][i] * BField[c1][i];
+    comp[i] /= MU0;
   }
+  return MakeTimeDomainGraph(comp, kUseRetardedTime, titles[coord]);
 }
 
 TGraph* rad::FieldPoint::GetPoyntingMagTimeDomain(const bool kUseRetardedTime) {
-  TGraph* grSMag = new TGraph();
-  TGraph* grEMag = GetEFieldMagTimeDomain();
-  TGraph* grBMag = GetBFieldMagTimeDomain();
-  assert(grEMag->GetN() == grBMag->GetN());
-
-  for (int i = 0; i < grEMag->GetN(); i++) {
-    double smag = grEMag->GetPointY(i) * grBMag->GetPointY(i) / MU0;
-    grSMag->SetPoint(grSMag->GetN(), grEMag->GetPointX(i), smag);
+  std::vector<double> smag(times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    const double emag = sqrt(pow(EField[0][i], 2) + pow(EField[1][i], 2) +
+                             pow(EField[2][i], 2));
+    const double bmag = sqrt(pow(BField[0][i], 2) + pow(BField[1][i], 2) +
+                             pow(BField[2][i], 2));
+    smag[i] = emag * bmag / MU0;
   }
-  delete grEMag;
-  delete grBMag;
+  return MakeTimeDomainGraph(smag, kUseRetardedTime, "|S| [W m^{-2}]");
+}
 
-  setGraphAttr(grSMag);
-  grSMag->GetXaxis()->SetTitle("Time [s]");
-  grSMag->GetYaxis()->SetTitle("|S| [W m^{-2}]");
+std::vector<double> rad::FieldPoint::CalcLoadVoltage(
+    const bool kUseRetardedTime, size_t first, size_t end) const {
+  const size_t n = end - first;
 
-  if (!kUseRetardedTime) {
-    TGraph* grTrimmed = TrimGraphToTime(grSMag);
-    delete grSMag;
-    return grTrimmed;
-  } else {
-    TGraph* grSMagRet = MakeRetardedTimeGraph(grSMag);
-    delete grSMag;
-    TGraph* grTrimmed = TrimGraphToTime(grSMagRet);
-    delete grSMagRet;
-    return grTrimmed;
+  // Use the stored values in place unless they need interpolating
+  std::span<const double> E[3], ePos[3];
+  std::vector<double> retValues[6];
+  std::vector<double> tRet;
+  if (kUseRetardedTime) tRet = GetRetardedTimes(first, end);
+  for (int coord = 0; coord < 3; coord++) {
+    if (kUseRetardedTime) {
+      retValues[coord] = InterpolateValues(EField[coord], tRet);
+      retValues[coord + 3] = InterpolateValues(pos[coord], tRet);
+      E[coord] = retValues[coord];
+      ePos[coord] = retValues[coord + 3];
+    } else {
+      E[coord] = std::span<const double>(EField[coord]).subspan(first, n);
+      ePos[coord] = std::span<const double>(pos[coord]).subspan(first, n);
+    }
   }
+
+  std::vector<double> voltage(n);
+  for (size_t i = 0; i < n; i++) {
+    TVector3 EField(E[0][i], E[1][i], E[2][i]);
+    TVector3 ePosition(ePos[0][i], ePos[1][i], ePos[2][i]);
+    voltage[i] = (EField.Dot(myAntenna->GetETheta(ePosition)) +
+                  EField.Dot(myAntenna->GetEPhi(ePosition))) *
+                 myAntenna->GetHEff();
+    voltage[i] /= 2.0;  // Account for re-radiated power
+  }
+  return voltage;
 }
 
 TGraph* rad::FieldPoint::GetAntennaLoadVoltageTimeDomain(
     const bool kUseRetardedTime, int firstPoint, int lastPoint) {
-  TGraph* grEx =
-      GetEFieldTimeDomain(kX, kUseRetardedTime, firstPoint, lastPoint);
-  TGraph* grEy =
-      GetEFieldTimeDomain(kY, kUseRetardedTime, firstPoint, lastPoint);
-  TGraph* grEz =
-      GetEFieldTimeDomain(kZ, kUseRetardedTime, firstPoint, lastPoint);
-
-  TGraph* grPosx =
-      GetPositionTimeDomain(kX, kUseRetardedTime, firstPoint, lastPoint);
-  TGraph* grPosy =
-      GetPositionTimeDomain(kY, kUseRetardedTime, firstPoint, lastPoint);
-  TGraph* grPosz =
-      GetPositionTimeDomain(kZ, kUseRetardedTime, firstPoint, lastPoint);
-
-  TGraph* gr = new TGraph();
-  gr->GetXaxis()->SetTitle("Time [s]");
-  gr->GetYaxis()->SetTitle("Voltage [V]");
-  setGraphAttr(gr);
+  size_t first, end;
+  SelectPoints(kUseRetardedTime, firstPoint, lastPoint, first, end);
+  return MakeTimeGraph(CalcLoadVoltage(kUseRetardedTime, first, end), first,
+                       "Voltage [V]");
+}
 
-  for (int i = 0; i < grEx->GetN(); i++) {
-    TVector3 EField(grEx->GetPointY(i), grEy->GetPointY(i), grEz->GetPointY(i));
-    TVector3 ePos(grPosx->GetPointY(i), grPosy->GetPointY(i),
-                  grPosz->GetPointY(i));
-    double voltage = (EField.Dot(myAntenna->GetETheta(ePos)) +
-                      EField.Dot(myAntenna->GetEPhi(ePos))) *
-                     myAntenna->GetHEff();
-    voltage /= 2.0;  // Account for re-radiated power
-    gr->SetPoint(gr->GetN(), grEx->GetPointX(i), voltage);
+rad::TimeSeries rad::FieldPoint::GetAntennaLoadVoltage(
+    const double timeStep, const bool kUseRetardedTime) {
+  size_t first, end;
+  SelectPoints(kUseRetardedTime, -1, -1, first, end);
+  if (end == first) return TimeSeries(0, timeStep);
+
+  for (size_t i = first + 1; i < end; i++) {
+    const double gridTime = times[first] + double(i - first) * timeStep;
+    if (std::abs(times[i] - gridTime) > 1e-3 * timeStep) {
+      end = i;
+      break;
+    }
   }
-
-  delete grEx;
-  delete grEy;
-  delete grEz;
-  delete grPosx;
-  delete grPosy;
-  delete grPosz;
-
-  return gr;
+  return TimeSeries(times[first], timeStep,
+                    CalcLoadVoltage(kUseRetardedTime, first, end));
 }
 
 TGraph* rad::FieldPoint::GetAntennaPowerTimeDomain(bool kUseRetardedTime) {
@@ -659,32 +536,11 @@ TGraph* rad::FieldPoint::GetAntennaLoadPowerSpectrumNorm(
 
 // Assorted useful functions
 double rad::FieldPoint::GetFinalTime() {
-  TFile* fin = new TFile(inputFile, "READ");
-  assert(fin);
-  TTree* tree = (TTree*)fin->Get("tree");
-  double lastTime;
-  tree->SetBranchAddress("time", &lastTime);
-  tree->GetEntry(tree->GetEntries() - 1);
-  delete tree;
-  fin->Close();
-  delete fin;
-  return lastTime;
+  return TrajectorySource::Open(inputFile)->GetEndTime();
 }
 
 double rad::FieldPoint::GetSampleRate() {
-  TFile* fin = new TFile(inputFile, "READ");
-  assert(fin);
-  TTree* tree = (TTree*)fin->Get("tree");
-  double time;
-  tree->SetBranchAddress("time", &time);
-  double time0, time1;
-  tree->GetEntry(0);
-  time0 = time;
-  tree->GetEntry(1);
-  time1 = time;
-  double fs = 1.0 / (time1 - time0);
-  delete tree;
-  fin->Close();
-  delete fin;
-  return fs;
+  // For decimated files this is the rate the fields are generated at
+  TrajectoryInterpolator traj(inputFile);
+  return 1.0 / traj.GetSimStepSize();
 }
@@ -2,6 +2,7 @@
 #ifndef FIELD_CLASSES_H
 #define FIELD_CLASSES_H
 
+#include <span>
 #include <vector>
 
 #include "TFile.h"
@@ -13,31 +14,81 @@
 
 #include "BasicFunctions/BasicFunctions.h"
 #include "BasicFunctions/EMFunctions.h"
+#include "BasicFunctions/TimeSeries.h"
 #include "Antennas/IAntenna.h"
 
 namespace rad
 {
+  class MultiFieldPoint;
+
   class FieldPoint
   {
   protected:
     // Input file name
     TString inputFile;
     
-    // Time series for field components
-    TGraph* EField[3];
-    TGraph* BField[3];
+    // Times of the stored electron states, in increasing order
+    std::vector<double> times;
+
+    // Field components at the antenna, one value per stored time
+    std::vector<double> EField[3];
+    std::vector<double> BField[3];
 
-    // Time series of electron position
-    TGraph* pos[3];
+    // Electron position, one value per stored time
+    std::vector<double> pos[3];
 
-    TGraph* tPrime; // Relationship between time and retarded time
+    // Time at which the fields from each stored state reach the antenna
+    std::vector<double> antennaTimes;
 
     void ResetFields();
 
-    /// Produces a TGraph of the same variable on the y axis of the input graph but using the retarded time
-    /// \param grOriginal The input TGraph which should be a time series
-    /// \Returns A time series graph plotted using the retarded time
-    TGraph* MakeRetardedTimeGraph(const TGraph* grOriginal);
+    /// Adds the fields from one electron state to the stored time series
+    /// \param time The time of the electron state
+    /// \param antennaTime The time at which the fields reach the antenna
+    /// \param E The electric field at the antenna
+    /// \param B The magnetic field at the antenna
+    /// \param ePos The electron position
+    void StorePoint(const double time, const double antennaTime, const ROOT::Math::XYZVector& E,
+		    const ROOT::Math::XYZVector& B, const ROOT::Math::XYZPoint& ePos);
+
+    /// Finds the stored points to return, trimmed to the cut times
+    /// \param kUseRetardedTime Boolean to use retarded time. Points before the fields first reach the antenna are skipped
+    /// \param firstPoint First point to return, counting from the first point that can be returned. Negative to start there
+    /// \param lastPoint Last point to return, counted in the same way. Negative to carry on to the last stored point
+    /// \param first Set to the first stored point to return
+    /// \param end Set to one past the last stored point to return
+    void SelectPoints(const bool kUseRetardedTime, int firstPoint, int lastPoint,
+		      size_t& first, size_t& end) const;
+
+    /// Retarded times of a run of stored points
+    /// \param first First stored point
+    /// \param end One past the last stored point
+    /// \Returns The time each point's fields left the electron
+    std::vector<double> GetRetardedTimes(size_t first, size_t end) const;
+
+    /// Spline interpolates a stored time series
+    /// \param values One value per stored time
+    /// \param evalTimes Times at which to evaluate the series
+    /// \Returns One value per evaluation time
+    std::vector<double> InterpolateValues(std::span<const double> values,
+					  std::span<const double> evalTimes) const;
+
+    /// Copies values at a run of stored points into a time series graph
+    /// \param values One value per point, starting at the first point
+    /// \param first First stored point
+    /// \param yTitle Title of the y axis
+    /// \Returns Graph owned by the caller
+    TGraph* MakeTimeGraph(std::span<const double> values, size_t first, const char* yTitle) const;
+
+    /// Produces a graph of a stored time series, trimmed to the cut times
+    /// \param values One value per stored time
+    /// \param kUseRetardedTime Boolean to use retarded time
+    /// \param yTitle Title of the y axis
+    /// \param firstPoint First point to return, as for SelectPoints
+    /// \param lastPoint Last point to return, as for SelectPoints
+    /// \Returns Graph owned by the caller
+    TGraph* MakeTimeDomainGraph(std::span<const double> values, const bool kUseRetardedTime,
+				const char* yTitle, int firstPoint=-1, int lastPoint=-1) const;
 
     IAntenna* myAntenna; // The chosen antenna, contains position and direction info
 
@@ -48,12 +99,22 @@ namespace rad
     double minCutTime;
     double maxCutTime;
 
-    /// Function to cut time series graphs down to a specified time
-    /// \param grIn The input time series graph
-    /// \param minCutTime The minimum time at which the outputted graph should start
-    /// \param maxCutTime The maximum time at which the outputted graph should end
-    /// \returns The trimmed graph
-    TGraph* TrimGraphToTime(const TGraph* grIn);
+    /// Load voltage from the antenna at a run of stored points (assumes impedance matching)
+    /// \param kUseRetardedTime Boolean to use retarded time
+    /// \param first First stored point
+    /// \param end One past the last stored point
+    /// \Returns One voltage per point
+    std::vector<double> CalcLoadVoltage(const bool kUseRetardedTime, size_t first, size_t end) const;
+
+    /// Calculates the fields from one electron state and adds them to the time series
+    /// \param antennaPoint The antenna position
+    /// \param time The time of the electron state
+    /// \param ePos The electron position
+    /// \param eVel The electron velocity
+    /// \param eAcc The electron acceleration
+    void AddFieldPoint(const ROOT::Math::XYZPoint& antennaPoint, const double time,
+		       const ROOT::Math::XYZPoint& ePos, const ROOT::Math::XYZVector& eVel,
+		       const ROOT::Math::XYZVector& eAcc);
     
   public:
     enum Coord_t{
@@ -66,10 +127,10 @@ namespace rad
     FieldPoint(TString trajectoryFilePath, IAntenna* myAntenna);
 
     /// Destructor
-    ~FieldPoint();
+    ~FieldPoint() = default;
 
     /// Copy constructor
-    FieldPoint(const FieldPoint &fp);
+    FieldPoint(const FieldPoint &fp) = default;
 
     /// Returns a pointer to the antenna used for the calculations
     IAntenna* GetAntenna() { return myAntenna; }
@@ -79,6 +140,15 @@ namespace rad
     /// \param maxTime The final time to use in the input file
     void GenerateFields(const double minTime, const double maxTime);
 
+    /// Fills the class members between two given times from fields already
+    /// calculated at several antennas, instead of reading the trajectory
+    /// \param mfp Fields covering the times requested, including this antenna
+    /// \param iAnt Index of this class's antenna in mfp
+    /// \param minTime The initial time in the input file
+    /// \param maxTime The final time to use in the input file
+    void SetFields(const MultiFieldPoint& mfp, size_t iAnt,
+                   const double minTime, const double maxTime);
+
     /// Electron position as a function of time
     /// \param coord The chosen cartesian coordinate
     /// \param kUseRetardedTime Boolean to use retarded time
@@ -136,6 +206,13 @@ namespace rad
     TGraph* GetAntennaLoadVoltageTimeDomain(const bool kUseRetardedTime=false,
 					    int firstPoint=-1, int lastPoint=-1);
 
+    /// Load voltage from the antenna as an evenly sampled time series, without building a graph
+    /// Only the leading evenly spaced run of points is returned, as a file can end with a shorter step
+    /// \param timeStep Time between the stored states
+    /// \param kUseRetardedTime Boolean to use retarded time
+    /// \Returns The load voltage as a function of time
+    TimeSeries GetAntennaLoadVoltage(const double timeStep, const bool kUseRetardedTime=false);
+
     /// Calculate the power collected by the antenna over time
     /// \param kUseRetardedTime Boolean to use retarded time
     /// \param firstPoint The first point of the class members to return
@@ -0,0 +1,118 @@
+// MultiFieldPoint.cxx
+
+#include "FieldClasses/MultiFieldPoint.h"
+
+#include <cmath>
+#include <iostream>
+
+#include "BasicFunctions/BasicFunctions.h"
+#include "BasicFunctions/EMFunctions.h"
+#include "BasicFunctions/TrajectoryInterpolator.h"
+#include "BasicFunctions/TrajectorySource.h"
+
+rad::MultiFieldPoint::MultiFieldPoint(TString trajectoryFilePath,
+                                      std::vector<IAntenna*> antennaVec)
+    : inputFile(trajectoryFilePath), antennas(antennaVec), nPoints(0) {
+  fileStartTime = TrajectorySource::Open(trajectoryFilePath)->GetStartTime();
+
+  for (auto ant : antennas) {
+    TVector3 antPos = ant->GetAntennaPosition();
+    antennaPoints.emplace_back(antPos.X(), antPos.Y(), antPos.Z());
+  }
+}
+
+void rad::MultiFieldPoint::Resize(size_t n) {
+  nPoints = n;
+  const size_t nAnt = antennas.size();
+  times.resize(n);
+  ePos.resize(3 * n);
+  EField.resize(3 * nAnt * n);
+  BField.resize(3 * nAnt * n);
+  antennaTimes.resize(nAnt * n);
+}
+
+void rad::MultiFieldPoint::AddState(size_t i, double time,
+                                    const ROOT::Math::XYZPoint& pos,
+                                    const ROOT::Math::XYZVector& vel,
+                                    const ROOT::Math::XYZVector& acc) {
+  times[i] = time;
+  ePos[i] = pos.X();
+  ePos[nPoints + i] = pos.Y();
+  ePos[2 * nPoints + i] = pos.Z();
+
+  for (size_t iAnt = 0; iAnt < antennas.size(); iAnt++) {
+    const ROOT::Math::XYZPoint& antennaPoint = antennaPoints[iAnt];
+    ROOT::Math::XYZVector EFieldCalc = CalcEField(antennaPoint, pos, vel, acc);
+    ROOT::Math::XYZVector BFieldCalc = CalcBField(antennaPoint, pos, vel, acc);
+
+    EField[Offset(iAnt, FieldPoint::kX) + i] = EFieldCalc.X();
+    EField[Offset(iAnt, FieldPoint::kY) + i] = EFieldCalc.Y();
+    EField[Offset(iAnt, FieldPoint::kZ) + i] = EFieldCalc.Z();
+    BField[Offset(iAnt, FieldPoint::kX) + i] = BFieldCalc.X();
+    BField[Offset(iAnt, FieldPoint::kY) + i] = BFieldCalc.Y();
+    BField[Offset(iAnt, FieldPoint::kZ) + i] = BFieldCalc.Z();
+    antennaTimes[iAnt * nPoints + i] =
+        CalcTimeFromRetardedTime(antennaPoint, pos, time);
+  }
+}
+
+void rad::MultiFieldPoint::GenerateFields(const double minTime,
+                                          const double maxTime) {
+  // Generate fields a small amount of time earlier than asked for, unless
+  // at the start of the file, so retarded time graphs link up across chunks
+  const double minGenTime =
+      (fileStartTime == minTime) ? minTime : minTime - 4e-9;
+  const double maxGenTime = maxTime;
+
+  // Decimated files are reconstructed at the simulation step
+  TrajectoryInterpolator traj(inputFile);
+  const double timeStepSize = traj.GetSimStepSize();
+  if (traj.IsDecimated()) {
+    const double t0 = traj.GetStartTime();
+    const unsigned long nSteps = traj.GetNSimSteps();
+    unsigned long firstStep = 0;
+    if (minGenTime > t0)
+      firstStep = (unsigned long)(std::ceil((minGenTime - t0) / timeStepSize));
+    unsigned long lastStep = firstStep;
+    while (lastStep < nSteps &&
+           t0 + double(lastStep) * timeStepSize <= maxGenTime) {
+      lastStep++;
+    }
+    Resize(lastStep - firstStep);
+
+    for (unsigned long i = firstStep; i < lastStep; i++) {
+      const double time = t0 + double(i) * timeStepSize;
+      if (std::fmod(time, 1e-6) < timeStepSize) {
+        std::cout << time << " seconds generated..." << std::endl;
+      }
+
+      TVector3 p, v, a;
+      traj.GetState(time, p, v, a);
+      AddState(i - firstStep, time, ROOT::Math::XYZPoint(p.X(), p.Y(), p.Z()),
+               ROOT::Math::XYZVector(v.X(), v.Y(), v.Z()),
+               ROOT::Math::XYZVector(a.X(), a.Y(), a.Z()));
+    }
+    return;
+  }
+
+  // Find the range of stored states to read
+  TrajectorySource& source = traj.GetSource();
+  size_t firstEntry, endEntry;
+  source.FindRange(minGenTime, maxGenTime, firstEntry, endEntry);
+  source.PrepareRange(firstEntry, endEntry);
+  Resize(endEntry - firstEntry);
+
+  // Loop through the entries and get the fields at each antenna
+  TrajectoryPoint pt;
+  source.Seek(firstEntry);
+  for (size_t i = 0; i < nPoints && source.Next(pt); i++) {
+    const double time = pt.time;
+    if (std::fmod(time, 1e-6) < timeStepSize) {
+      std::cout << time << " seconds generated..." << std::endl;
+    }
+
+    AddState(i, time, ROOT::Math::XYZPoint(pt.pos.X(), pt.pos.Y(), pt.pos.Z()),
+             ROOT::Math::XYZVector(pt.vel.X(), pt.vel.Y(), pt.vel.Z()),
+             ROOT::Math::XYZVector(pt.acc.X(), pt.acc.Y(), pt.acc.Z()));
+  }
+}
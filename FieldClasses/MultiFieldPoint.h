@@ -0,0 +1,131 @@
+/*
+  MultiFieldPoint.h
+
+  Fields from one electron trajectory at several antennas at once
+  Each trajectory state is read a single time and the fields are evaluated at
+  every antenna position from it, rather than reading the whole trajectory
+  once per antenna. The results are stored in contiguous arrays, with each
+  antenna's series for each field component held in its own block.
+*/
+
+#ifndef MULTI_FIELD_POINT_H
+#define MULTI_FIELD_POINT_H
+
+#include <span>
+#include <vector>
+
+#include "TString.h"
+#include "Math/Point3D.h"
+
+#include "FieldClasses/FieldClasses.h"
+#include "Antennas/IAntenna.h"
+
+namespace rad
+{
+  class MultiFieldPoint
+  {
+  private:
+    // Input file name
+    TString inputFile;
+
+    std::vector<IAntenna*> antennas;
+    std::vector<ROOT::Math::XYZPoint> antennaPoints;
+
+    double fileStartTime; // First time in the file (in seconds)
+
+    // Number of electron states in the current series
+    size_t nPoints;
+
+    // Electron state times and positions, with one block per coordinate
+    std::vector<double> times;
+    std::vector<double> ePos;
+
+    // Field components, with one block per antenna and coordinate
+    std::vector<double> EField;
+    std::vector<double> BField;
+
+    // Time at which the fields from each state reach each antenna
+    std::vector<double> antennaTimes;
+
+    /// Sets the length of every series
+    /// \param n Number of electron states
+    void Resize(size_t n);
+
+    /// Calculates the fields at every antenna from one electron state
+    /// \param i Index of the state in the series
+    /// \param time The time of the electron state
+    /// \param pos The electron position
+    /// \param vel The electron velocity
+    /// \param acc The electron acceleration
+    void AddState(size_t i, double time, const ROOT::Math::XYZPoint& pos,
+                  const ROOT::Math::XYZVector& vel,
+                  const ROOT::Math::XYZVector& acc);
+
+    /// Offset of a series in the per antenna arrays
+    size_t Offset(size_t iAnt, FieldPoint::Coord_t coord) const {
+      return (iAnt * 3 + coord) * nPoints;
+    }
+
+  public:
+    /// Parametrised constructor
+    /// \param trajectoryFilePath TString to the input file containing the
+    /// electron trajectory
+    /// \param antennaVec Vector of antennas to calculate the fields at
+    MultiFieldPoint(TString trajectoryFilePath,
+                    std::vector<IAntenna*> antennaVec);
+
+    /// Fills the series between two given times, reading the trajectory once
+    /// As with FieldPoint, states from slightly before minTime are included
+    /// unless minTime is the start of the file
+    /// \param minTime The initial time in the input file
+    /// \param maxTime The final time to use in the input file
+    void GenerateFields(const double minTime, const double maxTime);
+
+    /// Returns the number of antennas
+    size_t GetNAntennas() const { return antennas.size(); }
+
+    /// Returns a pointer to one of the antennas
+    /// \param iAnt Index of the antenna
+    IAntenna* GetAntenna(size_t iAnt) const { return antennas.at(iAnt); }
+
+    /// Returns the number of electron states in each series
+    size_t GetNPoints() const { return nPoints; }
+
+    /// Returns the first time in the file in seconds
+    double GetFileStartTime() const { return fileStartTime; }
+
+    /// Returns the electron state times in seconds
+    std::span<const double> GetTimes() const { return {times.data(), nPoints}; }
+
+    /// Returns an electron position component in metres
+    /// \param coord The chosen cartesian coordinate
+    std::span<const double> GetPosition(FieldPoint::Coord_t coord) const {
+      return {ePos.data() + coord * nPoints, nPoints};
+    }
+
+    /// Returns an electric field component at an antenna in V/m
+    /// \param iAnt Index of the antenna
+    /// \param coord The chosen cartesian coordinate
+    std::span<const double> GetEField(size_t iAnt,
+                                      FieldPoint::Coord_t coord) const {
+      return {EField.data() + Offset(iAnt, coord), nPoints};
+    }
+
+    /// Returns a magnetic field component at an antenna in T
+    /// \param iAnt Index of the antenna
+    /// \param coord The chosen cartesian coordinate
+    std::span<const double> GetBField(size_t iAnt,
+                                      FieldPoint::Coord_t coord) const {
+      return {BField.data() + Offset(iAnt, coord), nPoints};
+    }
+
+    /// Returns the times at which the fields reach an antenna in seconds
+    /// This relates the time at the antenna to the retarded time
+    /// \param iAnt Index of the antenna
+    std::span<const double> GetAntennaTimes(size_t iAnt) const {
+      return {antennaTimes.data() + iAnt * nPoints, nPoints};
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+  ISignalSink.h
+
+  Abstract base class for anything which consumes the output of a Signal as
+  it is produced
+  Sinks see every output sample exactly once, in order and with noise
+  added, so spectra or other statistics of arbitrarily long acquisitions can
+  be built up without the voltages ever being stored.
+*/
+
+#ifndef ISIGNAL_SINK_H
+#define ISIGNAL_SINK_H
+
+#include "BasicFunctions/TimeSeries.h"
+
+namespace rad {
+/// Output voltage components of a Signal
+enum class SignalComponent { kInPhase, kQuadrature };
+
+class ISignalSink {
+ public:
+  virtual ~ISignalSink() {}
+
+  /// @brief Receives the next block of output samples
+  /// @param vi In phase voltages [V]
+  /// @param vq Quadrature voltages [V], at the same times as vi
+  virtual void AddSamples(TimeSeriesView vi, TimeSeriesView vq) = 0;
+};
+}  // namespace rad
+
+#endif
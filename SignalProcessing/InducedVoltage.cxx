@@ -4,61 +4,32 @@
 #include "Antennas/IAntenna.h"
 #include "FieldClasses/FieldClasses.h"
 #include "BasicFunctions/BasicFunctions.h"
+#include "BasicFunctions/TrajectoryInterpolator.h"
+#include "BasicFunctions/TrajectorySource.h"
 
 #include "TString.h"
 #include "TGraph.h"
 #include "TFile.h"
-#include "TTree.h"
 #include "TAxis.h"
-#include "TSpline.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-
-rad::InducedVoltage::~InducedVoltage() {
-  delete grVoltage;
-  theAntennas.clear();
-}
-
-TGraph* rad::InducedVoltage::DelayVoltage(TGraph* grIn, IAntenna* ant)
-{
-  double delay = ant->GetTimeDelay();
-  TGraph* grOut = new TGraph();
-  setGraphAttr(grOut);
-  TSpline3* sp = new TSpline3("sp", grIn);
-  for (int iPnt = 0; iPnt < grIn->GetN(); iPnt++) {
-    if (grIn->GetPointX(iPnt) - delay < grIn->GetPointX(0)) continue;
-    double theTime = grIn->GetPointX(iPnt);
-    grOut->SetPoint(grOut->GetN(), theTime, sp->Eval(theTime - delay));
-  }
-  
-  delete sp;
-  return grOut;
-}
+#include <span>
 
 rad::InducedVoltage::InducedVoltage(TString trajectoryFilePath, IAntenna* myAntenna,
 				    const bool kUseRetardedTime) {
   theFile = trajectoryFilePath;
   theAntennas.push_back(myAntenna);
   UseRetardedTime = kUseRetardedTime;
-  grVoltage = new TGraph();
-  grVoltage->GetXaxis()->SetTitle("Time [s]");
-  grVoltage->GetYaxis()->SetTitle("Voltage [V]");
   
-  // Get the time spacing in the input file
-  TFile* file1 = new TFile(theFile, "READ");
-  assert(file1);
-  TTree* tree1 = (TTree*)file1->Get("tree");
-  assert(tree1);
-  double time;
-  tree1->SetBranchAddress("time", &time);
-  tree1->GetEntry(0);
-  double time0 = time;
-  tree1->GetEntry(1);
-  double time1 = time;
-  delete tree1;
-  file1->Close();
-  delete file1;
-  const double timeStep = time1 - time0;
+  // Get the time spacing the fields are generated at
+  // For decimated files this is the simulation step rather than the file spacing
+  TrajectoryInterpolator traj(theFile);
+  timeStep = traj.GetSimStepSize();
+  gridStartTime = traj.GetStartTime();
+  voltage = TimeSeries(gridStartTime, timeStep);
+  voltageFirst = 0;
 
   const double chunkRatio = 8333333.0; // Number of points that have been determined to work
   chunkSize = chunkRatio * timeStep; // Adaptive time chunk size
@@ -70,192 +41,139 @@ rad::InducedVoltage::InducedVoltage(TString trajectoryFilePath, std::vector<IAnt
   theFile = trajectoryFilePath;
   theAntennas = antennaVec;
   UseRetardedTime = kUseRetardedTime;
-  grVoltage = new TGraph();
-  grVoltage->GetXaxis()->SetTitle("Time [s]");
-  grVoltage->GetYaxis()->SetTitle("Voltage [V]");
   
-  // Get the time spacing in the input file
-  TFile* file1 = new TFile(theFile, "READ");
-  assert(file1);
-  TTree* tree1 = (TTree*)file1->Get("tree");
-  assert(tree1);
-  double time;
-  tree1->SetBranchAddress("time", &time);
-  tree1->GetEntry(0);
-  double time0 = time;
-  tree1->GetEntry(1);
-  double time1 = time;
-  delete tree1;
-  file1->Close();
-  delete file1;
-  const double timeStep = time1 - time0;
+  // Get the time spacing the fields are generated at
+  // For decimated files this is the simulation step rather than the file spacing
+  TrajectoryInterpolator traj(theFile);
+  timeStep = traj.GetSimStepSize();
+  gridStartTime = traj.GetStartTime();
+  voltage = TimeSeries(gridStartTime, timeStep);
+  voltageFirst = 0;
 
   const double chunkRatio = 8333333.0; // Number of points that have been determined to work
   chunkSize = chunkRatio * timeStep; // Adaptive time chunk size
 }
 
-void rad::InducedVoltage::ProcessTimeChunk(FieldPoint fp, double firstTime, double lastTime, double minTime, double &latestStartTime, bool kFirstAntenna)
+long long rad::InducedVoltage::GetFirstSample(double t) const
 {
-  double timeDelay = fp.GetAntenna()->GetTimeDelay();
-  fp.GenerateFields(firstTime-timeDelay, lastTime);
+  // Allow for rounding in times which are meant to be on the grid
+  return (long long)(std::ceil((t - gridStartTime) / timeStep - 1e-6));
+}
 
-  TGraph* voltageTemp = 0;
-  if (timeDelay != 0.0) {
-    TGraph* voltageUnshifted = fp.GetAntennaLoadVoltageTimeDomain(UseRetardedTime);
-    voltageTemp = DelayVoltage(voltageUnshifted, fp.GetAntenna());
-    delete voltageUnshifted;
-  }
-  else {
-    voltageTemp = fp.GetAntennaLoadVoltageTimeDomain(UseRetardedTime);
+void rad::InducedVoltage::ProcessTimeChunk(FieldPoint &fp, const MultiFieldPoint &mfp, size_t iAnt,
+					   const FractionalDelay &delay, long long firstSample, long long endSample,
+					   long long &validFirst, long long &validEnd)
+{
+  // Only need the fields either side of the delayed chunk that the interpolation reaches
+  const double timeDelay = fp.GetAntenna()->GetTimeDelay();
+  const double margin = (FractionalDelay::kDefaultHalfLength + 1) * timeStep;
+  const double firstTime = gridStartTime + double(firstSample) * timeStep;
+  const double lastTime = gridStartTime + double(endSample) * timeStep;
+  fp.SetFields(mfp, iAnt, firstTime - timeDelay - margin, lastTime - timeDelay + margin);
+  const TimeSeries v = fp.GetAntennaLoadVoltage(timeStep, UseRetardedTime);
+
+  // Output samples which can be calculated from this voltage, on the grid
+  const long long inFirst = std::llround((v.GetStartTime() - gridStartTime) / timeStep);
+  delay.GetOutputRange(v.Size(), validFirst, validEnd);
+  validFirst = std::max(validFirst + inFirst, firstSample);
+  validEnd = std::min(validEnd + inFirst, endSample);
+  if (validEnd < validFirst) validEnd = validFirst;
+
+  std::span<const double> in = v.GetValues();
+  for (long long k = validFirst; k < validEnd; k++) {
+    voltage[size_t(k - voltageFirst)] += delay.Eval(in, k - inFirst);
   }
+}
 
-  // Now write this to the main voltage graph
-  std::cout<<"Writing to main voltage graph"<<std::endl;
-  if (kFirstAntenna) {
-    // This is the first antenna so write to the main graph normally
-    for (int i = 0; i < voltageTemp->GetN(); i++) {
-      grVoltage->SetPoint(grVoltage->GetN(), voltageTemp->GetPointX(i), voltageTemp->GetPointY(i));
-    }
-    latestStartTime = grVoltage->GetPointX(0);
+void rad::InducedVoltage::GenerateVoltage(double minTime, double maxTime) {
+  if (minTime == -1) minTime = 0.0;
+  if (maxTime == -1) maxTime = GetFinalTime();
+
+  // Fields are calculated at every antenna in a single read of each chunk of
+  // the trajectory
+  MultiFieldPoint mfp(theFile, theAntennas);
+  double maxTimeDelay = 0.0;
+  double minTimeDelay = 0.0;
+  std::vector<FractionalDelay> delays;
+  for (auto ant : theAntennas) {
+    if (ant->GetTimeDelay() > maxTimeDelay) maxTimeDelay = ant->GetTimeDelay();
+    if (ant->GetTimeDelay() < minTimeDelay) minTimeDelay = ant->GetTimeDelay();
+    delays.emplace_back(ant->GetTimeDelay() / timeStep);
   }
-  else {
-    // We have already written to this graph once
-    // Need to find where to start writing this graph to
-    // Is this the first time chunk in the sequence?
-    if (firstTime == minTime) {
-      // This is the first time chunk
-      // Check if this voltage has a later start time than current limit
-      if (voltageTemp->GetPointX(0) > latestStartTime)  latestStartTime = voltageTemp->GetPointX(0);
-
-      // Now figure out where to start adding these points to the existing graph
-      int startPntTmp = -1;
-      double startTimeTmp = 0.0;
-      // Loop through points of temporary graph to determine the start time / point
-      for (int iTemp = 0; iTemp < voltageTemp->GetN(); iTemp++) {
-	if (voltageTemp->GetPointX(iTemp) < latestStartTime) {
-	  continue;
-	}
-	else {
-	  startPntTmp = iTemp;
-	  startTimeTmp = voltageTemp->GetPointX(iTemp);
-	  break;
-	}	  
-      }
-
-      // Now find the corresponding point on the main graph that corresponds to this time
-      int startPntMain = -1;
-      for (int iMain = 0; iMain < grVoltage->GetN(); iMain++) {
-	if (grVoltage->GetPointX(iMain) == startTimeTmp) {
-	  startPntMain = iMain;
-	  break;
-	}
-	    
-	if (iMain == grVoltage->GetN()-1) {
-	  std::cout<<"We seem to have not found a matching time point. Exiting..."<<std::endl;
-	  exit(1);
-	}
-      }
-
-      // Now we have these two points, can add voltages to existing graph
-      for (int i = 0; i < voltageTemp->GetN() - startPntTmp; i++) {
-	double existingVoltage = grVoltage->GetPointY(startPntMain+i);
-	grVoltage->SetPointY(startPntMain+i, existingVoltage + voltageTemp->GetPointY(i+startPntTmp));
-      } 
+  const double margin = (FractionalDelay::kDefaultHalfLength + 1) * timeStep;
+
+  // To avoid running out of memory, generate the fields in more manageable chunks
+  // Avoids having massive versions of unnecessary graphs
+  // The fields at every antenna are held at once, so share the memory between them
+  const double thisChunkSize = chunkSize / theAntennas.size();
+  double thisChunk = minTime + thisChunkSize;
+  if (thisChunk > maxTime) thisChunk = maxTime;
+  double lastChunk = minTime;
+
+  voltageFirst = GetFirstSample(minTime);
+  voltage = TimeSeries(gridStartTime + double(voltageFirst) * timeStep, timeStep);
+  // Samples which every antenna has contributed to
+  long long coveredFirst = voltageFirst;
+  long long coveredEnd = voltageFirst;
+
+  std::cout<<"Generating voltages"<<std::endl;
+  while (thisChunk <= maxTime && thisChunk != lastChunk) {
+    // Cover the earliest and latest times needed by any of the antennas
+    mfp.GenerateFields(lastChunk - maxTimeDelay - margin, thisChunk - minTimeDelay + margin);
+
+    const long long firstSample = GetFirstSample(lastChunk);
+    const long long endSample = GetFirstSample(thisChunk);
+    voltage.Resize(size_t(endSample - voltageFirst));
+
+    // Loop over the inputted antennas
+    long long chunkFirst = firstSample;
+    long long chunkEnd = endSample;
+    for (size_t iAnt = 0; iAnt < theAntennas.size(); iAnt++) {
+      FieldPoint fp(theFile, theAntennas[iAnt]);
+      long long validFirst, validEnd;
+      ProcessTimeChunk(fp, mfp, iAnt, delays[iAnt], firstSample, endSample, validFirst, validEnd);
+      chunkFirst = std::max(chunkFirst, validFirst);
+      chunkEnd = std::min(chunkEnd, validEnd);
+    } // Loop over antenna points
+
+    // Antennas can only start late at the start of the file and finish early at the end
+    const bool isFirstChunk = (lastChunk == minTime);
+    const bool isLastChunk = (thisChunk == maxTime);
+    if ((!isFirstChunk && chunkFirst > firstSample) || (!isLastChunk && chunkEnd < endSample)) {
+      std::cout<<"Antenna voltages do not cover the whole time chunk. Exiting..."<<std::endl;
+      exit(1);
     }
-    else {
-      // This is NOT the first time chunk
-      // Therefore the first point of the temporary graph should match with a main graph point
-      int startPntMain = -1;
-      for (int iMain = 0; iMain < grVoltage->GetN(); iMain++) {
-	if (grVoltage->GetPointX(iMain) == voltageTemp->GetPointX(0)) {
-	  startPntMain = iMain;
-	  break;
-	}
-
-	if (iMain == grVoltage->GetN()-1) {
-	  std::cout<<"We seem to have not found a matching time point. Exiting..."<<std::endl;
-	  exit(1);
-	}
-      } // Loop over main graph points
-
-      // Now write to the main voltage graph
-      for (int i = 0; i < voltageTemp->GetN(); i++) {
-	double existingVoltage = grVoltage->GetPointY(startPntMain+i);
-	grVoltage->SetPointY(startPntMain+i, existingVoltage + voltageTemp->GetPointY(i));
-      } // Write to main voltage graph
-	  
-    } // This is not the first time chunk
-  } // Already written to the main graph at least once
-  
-  delete voltageTemp;
-}
+    if (isFirstChunk) coveredFirst = chunkFirst;
+    coveredEnd = chunkEnd;
 
-void rad::InducedVoltage::GenerateVoltage(double minTime, double maxTime) {
-  double latestStartTime = -DBL_MAX;
-  
-  // Loop over the inputted antennas
-  for (int iAnt = 0; iAnt < theAntennas.size(); iAnt++) {
-    FieldPoint fp(theFile, theAntennas[iAnt]);
-    if (minTime == -1) minTime = 0.0;
-    if (maxTime == -1) maxTime = fp.GetFinalTime();
-    bool firstAntenna = (iAnt == 0);
-    
-    // To avoid running out of memory, generate the fields in more manageable chunks
-    // Avoids having massive versions of unnecessary graphs
-    double thisChunk = minTime + chunkSize;
+    lastChunk = thisChunk;
+    thisChunk += thisChunkSize;
     if (thisChunk > maxTime) thisChunk = maxTime;
-    double lastChunk = minTime;
-
-    double timeDelay = theAntennas[iAnt]->GetTimeDelay();
-    std::cout<<"Generating voltages"<<std::endl;
-    while (thisChunk <= maxTime && thisChunk != lastChunk) {
-      ProcessTimeChunk(fp, lastChunk, thisChunk, minTime, latestStartTime, firstAntenna);
-      lastChunk = thisChunk;
-      thisChunk += chunkSize;
-      if (thisChunk > maxTime) thisChunk = maxTime;
-    } // Keep processing chunks
-  } // Loop over antenna points
+  } // Keep processing chunks
 
-  std::cout<<"Removing points up to "<<latestStartTime<<std::endl;
-  // Now remove the initial points that are before the first matching start time
-  for (int i = 0; i < grVoltage->GetN(); i++) {
-    if (grVoltage->GetPointX(0) >= latestStartTime)
-      break;
-    else
-      grVoltage->RemovePoint(0);
-  } // Remove unmatched points
-}
-
-rad::InducedVoltage::InducedVoltage(const InducedVoltage &iv) {
-  grVoltage = (TGraph*)iv.grVoltage->Clone();
-  theAntennas = iv.theAntennas;
-  theFile = iv.theFile;
-  UseRetardedTime = iv.UseRetardedTime;
-  chunkSize = iv.chunkSize;
+  // Now remove the samples which some antennas did not contribute to
+  if (coveredEnd < coveredFirst) coveredEnd = coveredFirst;
+  std::cout<<"Removing points up to "<<gridStartTime + double(coveredFirst) * timeStep<<std::endl;
+  voltage = TimeSeries(voltage.Slice(size_t(coveredFirst - voltageFirst), size_t(coveredEnd - coveredFirst)));
+  voltageFirst = coveredFirst;
 }
 
 TGraph* rad::InducedVoltage::GetVoltageGraph() {
-  TGraph* grOut = (TGraph*)grVoltage->Clone();
+  TGraph* grOut = voltage.ToTGraph();
   setGraphAttr(grOut);
+  grOut->GetXaxis()->SetTitle("Time [s]");
+  grOut->GetYaxis()->SetTitle("Voltage [V]");
   return grOut;
 }
 
 void rad::InducedVoltage::ResetVoltage() {
-  delete grVoltage;
-  grVoltage = new TGraph();
+  voltage.Clear();
+  voltage.SetStartTime(gridStartTime);
+  voltageFirst = 0;
 }
 
 double rad::InducedVoltage::GetFinalTime() {
-  TFile *fin = new TFile(theFile, "READ");
-  assert(fin);
-  TTree* tree = (TTree*)fin->Get("tree");
-  double lastTime;
-  tree->SetBranchAddress("time", &lastTime);
-  tree->GetEntry(tree->GetEntries()-1);
-  delete tree;
-  fin->Close();                                                                 
-  delete fin;
-  return lastTime;
+  return TrajectorySource::Open(theFile)->GetEndTime();
 }
 
 double rad::InducedVoltage::GetUpperAntennaBandwidth() {
@@ -267,7 +185,11 @@ double rad::InducedVoltage::GetLowerAntennaBandwidth() {
 }
 
 void rad::InducedVoltage::ApplyAntennaBandwidth() {
-  grVoltage = BandPassFilter(grVoltage, theAntennas[0]->GetBandwidthLowerLimit(), theAntennas[0]->GetBandwidthUpperLimit());
+  TGraph* grV = voltage.ToTGraph();
+  TGraph* grFiltered = BandPassFilter(grV, theAntennas[0]->GetBandwidthLowerLimit(), theAntennas[0]->GetBandwidthUpperLimit());
+  std::copy(grFiltered->GetY(), grFiltered->GetY() + grFiltered->GetN(), voltage.Data());
+  delete grV;
+  delete grFiltered;
 }
 
 TGraph* rad::InducedVoltage::GetPowerPeriodogram(const double loadResistance) {
@@ -9,7 +9,10 @@
 #define INDUCED_VOLTAGE_H
 
 #include "FieldClasses/FieldClasses.h"
+#include "FieldClasses/MultiFieldPoint.h"
 #include "Antennas/IAntenna.h"
+#include "BasicFunctions/FractionalDelay.h"
+#include "BasicFunctions/TimeSeries.h"
 
 #include "TGraph.h"
 #include "TString.h"
@@ -23,25 +26,33 @@ namespace rad
   private:
     // Open circuit voltage with no signal processing performed
     TString theFile;
-    TGraph* grVoltage;
     std::vector<IAntenna*> theAntennas;
     bool UseRetardedTime;
     double chunkSize;
 
-    /// Produce a shifted version of a voltage graph according to the delay of the antenna
-    /// \param grIn The graph to be delayed
-    /// \param ant The antenna which is delayed a certain amount
-    /// \return The time series voltage graph of the delayed signal
-    TGraph* DelayVoltage(TGraph* grIn, IAntenna* ant);
+    // The voltages from every antenna are summed on the grid the fields are generated on
+    double timeStep;          // Spacing of the grid in seconds
+    double gridStartTime;     // Time of sample 0 of the grid, the start of the file
+    TimeSeries voltage;       // Summed voltage
+    long long voltageFirst;   // Grid sample of the first summed voltage sample
 
-    /// Function for processing time chunks of the voltage
+    /// Finds the first sample on the field time grid at or after a time
+    /// \param t The time in seconds
+    /// \return The grid sample number
+    long long GetFirstSample(double t) const;
+
+    /// Adds the delayed voltage from one antenna over a time chunk to the summed voltage
+    /// The delay is applied by indexing into the summed voltage and interpolating by the remaining fraction of a sample
     /// \param fp The FieldPoint for which to generate the voltage
-    /// \param firstTime The first time from which to generate from
-    /// \param lastTime The last time from which to generate from
-    /// \param minTime The first time in the whole file to generate from
-    /// \param latestStartTime Variable keeping track of the points to cut following processing
-    /// \param kFirstAntenna Boolean for keeping track of whether this is the first antenna in a series
-    void ProcessTimeChunk(FieldPoint fp, double firstTime, double lastTime, double minTime, double &latestStartTime, bool kFirstAntenna);
+    /// \param mfp Fields already calculated at every antenna for this chunk
+    /// \param iAnt Index of the FieldPoint's antenna
+    /// \param delay The antenna's time delay in grid samples
+    /// \param firstSample The first grid sample of the chunk
+    /// \param endSample One past the last grid sample of the chunk
+    /// \param validFirst Set to the first grid sample this antenna contributed to
+    /// \param validEnd Set to one past the last grid sample this antenna contributed to
+    void ProcessTimeChunk(FieldPoint &fp, const MultiFieldPoint &mfp, size_t iAnt, const FractionalDelay &delay,
+			  long long firstSample, long long endSample, long long &validFirst, long long &validEnd);
     
   public:
     /// Constructor for a voltage
@@ -65,15 +76,18 @@ namespace rad
     void GenerateVoltage(double minTime=-1, double maxTime=-1);
     
     /// Destructor
-    ~InducedVoltage();
+    ~InducedVoltage() = default;
 
     /// Copy constructor
-    InducedVoltage(const InducedVoltage &iv);
+    InducedVoltage(const InducedVoltage &iv) = default;
 
-    /// Returns the voltage graph
+    /// Returns the voltage graph, owned by the caller
     TGraph* GetVoltageGraph();
 
-    /// Deletes the TGraph pointer to free up memory
+    /// Returns the voltage without copying it
+    const TimeSeries& GetVoltage() const { return voltage; }
+
+    /// Clears the voltage to free up memory
     void ResetVoltage();
 
     // Returns the input file name
@@ -4,25 +4,34 @@
 
 #include "SignalProcessing/Signal.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "BasicFunctions/BasicFunctions.h"
 #include "BasicFunctions/EMFunctions.h"
+#include "BasicFunctions/FFTFilter.h"
+#include "BasicFunctions/ThreadPool.h"
+#include "BasicFunctions/FIRDecimator.h"
+#include "BasicFunctions/TrajectoryInterpolator.h"
 #include "TMath.h"
-#include "TTreeReader.h"
-#include "TTreeReaderValue.h"
 #include "TVector3.h"
 
 rad::Signal::Signal(TString trajectoryFilePath, IAntenna* ant,
                     LocalOscillator lo, double sRate,
-                    std::vector<GaussianNoise> noiseTerms, double tAcq)
-    : localOsc(lo), sampleRate(sRate), noiseVec(noiseTerms) {
+                    std::vector<GaussianNoise> noiseTerms, double tAcq,
+                    std::vector<ISignalSink*> outputSinks)
+    : localOsc(lo),
+      sampleRate(sRate),
+      noiseVec(noiseTerms),
+      viTime(0, 1 / sRate),
+      vqTime(0, 1 / sRate),
+      sinks(outputSinks) {
   antenna.push_back(ant);
-
-  CreateVoltageGraphs();
+  SetUpNoise();
 
   // Check if input file opens properly
-  SetUpTree(trajectoryFilePath);
+  OpenTrajectory(trajectoryFilePath);
 
   // Set file info
   GetFileInfo();
@@ -31,36 +40,29 @@ rad::Signal::Signal(TString trajectoryFilePath, IAntenna* ant,
   // By default, just do the whole electron trajectory file
   if (tAcq < 0) tAcq = fileEndTime;
 
-  double sampleTime{0};    // Second sample time in seconds
   double sample10Time{0};  // First sample time in seconds
   unsigned int sample10Num{0};
-  double sample10StepSize{1 / (10 * sRate)};
-
-  // Create just one deque
-  advancedTimeVec.push_back(std::deque<double>());
-
-  // Create some intermediate level graphs before final sampling
-  auto grVIBigFiltered = new TGraph();
-  auto grVQBigFiltered = new TGraph();
-
-  // Create a deque for filtered and unfiltered info
-  // Need this for time domain filter
-  std::deque<double> unfilteredVi;
-  std::deque<double> filteredVi;
-  // Copies for quadrature components
-  std::deque<double> unfilteredVq;
-  std::deque<double> filteredVq;
-
-  // Define the Butterworth filter
-  // Want to get rid of frequencies above half the sample rate
-  ButterworthFilter filter(6, sRate / 2, 10 * sRate);
+  double sample10StepSize{1 / (kDecimationRatio * sRate)};
+
+  // Create just one buffer
+  advancedTimeVec.emplace_back(kTimeBufferSize);
+  lastBracket.push_back(0);
+
+  // Decimating filters for the in phase and quadrature components
+  // Want to get rid of frequencies above half the sample rate before
+  // downsampling, only calculating the samples that are kept
+  FIRDecimator filterI(kDecimationRatio, kPassbandFraction * sRate,
+                       kStopbandFraction * sRate, kDecimationRatio * sRate);
+  FIRDecimator filterQ(kDecimationRatio, kPassbandFraction * sRate,
+                       kStopbandFraction * sRate, kDecimationRatio * sRate);
+  // The filter delay is a whole number of output samples, so output k is
+  // the filtered voltage at time k / sRate
 
   // Loop through tree entries
-  // Initially we are just doing the the higher frequency sampling
   double printTime{0};  // seconds
   double printInterval{5e-6};
-  for (unsigned int iE{0}; iE < inputTree->GetEntries(); iE++) {
-    inputTree->GetEntry(iE);
+  for (unsigned int iE{0}; iE < nStates; iE++) {
+    LoadState(iE);
     const double entryTime{time};
 
     // Check we are still within the acquisition time, stop otherwise
@@ -77,7 +79,9 @@ rad::Signal::Signal(TString trajectoryFilePath, IAntenna* ant,
     if (entryTime >= sample10Time) {
       // Yes we do
       // First get the retarded time to calculate the fields at
+      UpdateAdvancedTimes(0);
       double tr{GetRetardedTime(sample10Time, 0)};
+      ClearNewTimes();
 
       double vi{CalcVoltage(tr, antenna[0])};
       double vq{vi};
@@ -87,14 +91,12 @@ rad::Signal::Signal(TString trajectoryFilePath, IAntenna* ant,
       sample10Num++;
       sample10Time = double(sample10Num) * sample10StepSize;
 
-      // Now we want to filter this value and add it to the deques
-      double viFiltered{filter.FilterValues(unfilteredVi, filteredVi, vi)};
-      double vqFiltered{filter.FilterValues(unfilteredVq, filteredVq, vq)};
-      // Add to the TGraph
-      grVIBigFiltered->SetPoint(grVIBigFiltered->GetN(), sample10Time,
-                                viFiltered);
-      grVQBigFiltered->SetPoint(grVQBigFiltered->GetN(), sample10Time,
-                                vqFiltered);
+      // Filter and downsample
+      double viFiltered{0};
+      double vqFiltered{0};
+      const bool haveOutput{filterI.Push(vi, viFiltered)};
+      filterQ.Push(vq, vqFiltered);
+      if (haveOutput) AddSample(viFiltered, vqFiltered);
     } else {
       continue;
     }
@@ -103,60 +105,78 @@ rad::Signal::Signal(TString trajectoryFilePath, IAntenna* ant,
   // Can now safely close the input file
   CloseInputFile();
 
-  std::cout << "Second sampling...\n";
-  for (int i{0}; i < grVIBigFiltered->GetN(); i++) {
-    // We need to sample every 10th point
-    if (i % 10 == 0) {
-      grVITime->SetPoint(grVITime->GetN(), grVIBigFiltered->GetPointX(i),
-                         grVIBigFiltered->GetPointY(i));
-      grVQTime->SetPoint(grVQTime->GetN(), grVQBigFiltered->GetPointX(i),
-                         grVQBigFiltered->GetPointY(i));
-    }
+  // Flush out the samples still held in the filters
+  for (unsigned int i{0}; i < filterI.GetDelay(); i++) {
+    double viFiltered{0};
+    double vqFiltered{0};
+    const bool haveOutput{filterI.Push(0, viFiltered)};
+    filterQ.Push(0, vqFiltered);
+    if (haveOutput) AddSample(viFiltered, vqFiltered);
   }
-  delete grVIBigFiltered;
-  delete grVQBigFiltered;
 
-  // Now need to add noise (if noise terms exist)
-  if (!noiseTerms.empty()) {
-    std::cout << "Adding noise...\n";
-    AddNoise();
-  }
+  FlushSamples();
 }
 
 rad::Signal::Signal(TString trajectoryFilePath, std::vector<IAntenna*> ant,
                     LocalOscillator lo, double sRate,
-                    std::vector<GaussianNoise> noiseTerms, double tAcq)
-    : localOsc(lo), sampleRate(sRate), noiseVec(noiseTerms), antenna(ant) {
-  CreateVoltageGraphs();
-
+                    std::vector<GaussianNoise> noiseTerms, double tAcq,
+                    unsigned int nThreads,
+                    std::vector<ISignalSink*> outputSinks)
+    : localOsc(lo),
+      sampleRate(sRate),
+      noiseVec(noiseTerms),
+      viTime(0, 1 / sRate),
+      vqTime(0, 1 / sRate),
+      sinks(outputSinks),
+      antenna(ant) {
+  SetUpNoise();
   // Check if input file opens properly
-  SetUpTree(trajectoryFilePath);
+  OpenTrajectory(trajectoryFilePath);
 
   // Set file info
   GetFileInfo();
 
-  double sampleTime{0};    // Second sample time in seconds
   double sample10Time{0};  // First sample time in seconds
   unsigned int sample10Num{0};
-  double sample10StepSize{1 / (10 * sRate)};
+  double sample10StepSize{1 / (kDecimationRatio * sRate)};
 
-  // Create number of deques equal to number of antennas
+  // Create number of buffers equal to number of antennas
   for (size_t i{0}; i < antenna.size(); i++) {
-    advancedTimeVec.push_back(std::deque<double>());
+    advancedTimeVec.emplace_back(kTimeBufferSize);
+    lastBracket.push_back(0);
   }
-
-  // Create some intermediate level graphs before final sampling
-  auto grVIInter = new TGraph();
-  auto grVQInter = new TGraph();
-  auto grVIBigFiltered = new TGraph();
-  auto grVQBigFiltered = new TGraph();
+  std::vector<double> retardedTimes(antenna.size());
+  std::vector<double> antennaVoltages(antenna.size());
+  // Whether each voltage was found from the window by the threads. Not a
+  // vector<bool> as each thread writes its own elements
+  std::vector<char> inWindow(antenna.size());
+
+  // Antennas are shared out between the threads
+  ThreadPool pool(std::min(nThreads, (unsigned int)(antenna.size())));
+
+  // Streaming FFT filters for the in phase and quadrature components, with
+  // the same response as the single antenna decimating filter
+  const std::vector<double> taps{FIRDecimator::DesignLowPass(
+      kPassbandFraction * sRate, kStopbandFraction * sRate,
+      kDecimationRatio * sRate, 60, kDecimationRatio)};
+  FFTFilter filterI(taps, kDecimationRatio, kFFTBlockSize);
+  FFTFilter filterQ(taps, kDecimationRatio, kFFTBlockSize);
+  // The filter delay is a whole number of output samples, so output k is
+  // the filtered voltage at time k / sRate
+  auto AddSamples = [&]() {
+    const std::vector<double>& viFiltered{filterI.GetOutput()};
+    const std::vector<double>& vqFiltered{filterQ.GetOutput()};
+    for (size_t i{0}; i < viFiltered.size(); i++) {
+      AddSample(viFiltered[i], vqFiltered[i]);
+    }
+  };
 
   // Loop through tree entries
   // Initially we are just doing the the higher frequency sampling
   double printTime{0};  // seconds
   double printInterval{5e-6};
-  for (unsigned int iE{0}; iE < inputTree->GetEntries(); iE++) {
-    inputTree->GetEntry(iE);
+  for (unsigned int iE{0}; iE < nStates; iE++) {
+    LoadState(iE);
     const double entryTime{time};
     if (entryTime >= printTime) {
       std::cout << printTime * 1e6 << " us signal processed...\n";
@@ -168,47 +188,54 @@ rad::Signal::Signal(TString trajectoryFilePath, std::vector<IAntenna*> ant,
     // Do we need to sample now?
     if (entryTime >= sample10Time) {
       // Yes we do
-      // Loop through antennas and calculate a voltage at each
+      // First get the retarded time for each antenna. Each thread only
+      // touches the retarded time state of its own antennas.
+      pool.Run([&](unsigned int iThread) {
+        size_t begin, end;
+        pool.GetRange(antenna.size(), iThread, begin, end);
+        for (size_t iAnt{begin}; iAnt < end; iAnt++) {
+          UpdateAdvancedTimes(iAnt);
+          retardedTimes[iAnt] = GetRetardedTime(sample10Time, iAnt);
+        }
+      });
+      ClearNewTimes();
+
+      // Now calculate the voltage at each antenna. The threads only read
+      // from the window, so the states needed are decoded first. Any
+      // antenna whose states are missing is done here afterwards.
+      std::fill(inWindow.begin(), inWindow.end(), 0);
+      if (PrepareWindow(retardedTimes)) {
+        pool.Run([&](unsigned int iThread) {
+          size_t begin, end;
+          pool.GetRange(antenna.size(), iThread, begin, end);
+          for (size_t iAnt{begin}; iAnt < end; iAnt++) {
+            inWindow[iAnt] = CalcVoltageFromWindow(
+                retardedTimes[iAnt], antenna[iAnt], antennaVoltages[iAnt]);
+          }
+        });
+      }
+      for (size_t iAnt{0}; iAnt < antenna.size(); iAnt++) {
+        if (inWindow[iAnt]) continue;
+        antennaVoltages[iAnt] =
+            CalcVoltage(retardedTimes[iAnt], antenna[iAnt]);
+      }
+
+      // Sum in antenna order, so the result does not depend on the number
+      // of threads
       double vi{0};
       double vq{0};
-      for (size_t iAnt{0}; iAnt < antenna.size(); iAnt++) {
-        // Yes we do
-        // First get the retarded time to calculate the fields at
-        double tr{GetRetardedTime(sample10Time, iAnt)};
-        double v{CalcVoltage(tr, antenna[iAnt])};
+      for (double v : antennaVoltages) {
         vi += v;
         vq += v;
       }
       DownmixVoltages(vi, vq, sample10Time);
 
-      grVIInter->SetPoint(grVIInter->GetN(), sample10Time, vi);
-      grVQInter->SetPoint(grVQInter->GetN(), sample10Time, vq);
-
       sample10Num++;
       sample10Time = double(sample10Num) * sample10StepSize;
 
-      // We want to filter this signal if it's long enough
-      // Pick a good number to do FFTs with (2^n preferably)
-      if (grVIInter->GetN() == 32768) {
-        auto grVISmallFiltered = BandPassFilter(grVIInter, 0, sRate / 2);
-        auto grVQSmallFiltered = BandPassFilter(grVQInter, 0, sRate / 2);
-        // Now add these points to the existing graph
-        for (int iF{0}; iF < grVISmallFiltered->GetN(); iF++) {
-          grVIBigFiltered->SetPoint(grVIBigFiltered->GetN(),
-                                    grVISmallFiltered->GetPointX(iF),
-                                    grVISmallFiltered->GetPointY(iF));
-          grVQBigFiltered->SetPoint(grVQBigFiltered->GetN(),
-                                    grVQSmallFiltered->GetPointX(iF),
-                                    grVQSmallFiltered->GetPointY(iF));
-        }
-        delete grVISmallFiltered;
-        delete grVQSmallFiltered;
-        // Clear the current graphs and start again
-        delete grVIInter;
-        delete grVQInter;
-        grVIInter = new TGraph();
-        grVQInter = new TGraph();
-      }
+      // Both filters process their blocks on the same sample
+      filterQ.Push(vq);
+      if (filterI.Push(vi)) AddSamples();
     } else {
       continue;
     }
@@ -217,271 +244,347 @@ rad::Signal::Signal(TString trajectoryFilePath, std::vector<IAntenna*> ant,
   // Can now safely close the input file
   CloseInputFile();
 
-  // One last filter maybe
-  if (grVIInter->GetN() > 0) {
-    TGraph* grVISmallFiltered = BandPassFilter(grVIInter, 0, sRate / 2);
-    TGraph* grVQSmallFiltered = BandPassFilter(grVQInter, 0, sRate / 2);
-    delete grVIInter;
-    delete grVQInter;
-    // Add these remaining points to the main filtered graph
-    for (int iF{0}; iF < grVISmallFiltered->GetN(); iF++) {
-      grVIBigFiltered->SetPoint(grVIBigFiltered->GetN(),
-                                grVISmallFiltered->GetPointX(iF),
-                                grVISmallFiltered->GetPointY(iF));
-      grVQBigFiltered->SetPoint(grVQBigFiltered->GetN(),
-                                grVQSmallFiltered->GetPointX(iF),
-                                grVQSmallFiltered->GetPointY(iF));
-    }
-    delete grVISmallFiltered;
-    delete grVQSmallFiltered;
-  }
-
-  std::cout << "Second sampling...\n";
-  for (int i{0}; i < grVIBigFiltered->GetN(); i++) {
-    // We need to sample every 10th point
-    if (i % 10 == 0) {
-      grVITime->SetPoint(grVITime->GetN(), grVIBigFiltered->GetPointX(i),
-                         grVIBigFiltered->GetPointY(i));
-      grVQTime->SetPoint(grVQTime->GetN(), grVQBigFiltered->GetPointX(i),
-                         grVQBigFiltered->GetPointY(i));
-    }
-  }
-  delete grVIBigFiltered;
-  delete grVQBigFiltered;
-
-  // Now need to add noise (if noise terms exist)
-  if (!noiseTerms.empty()) {
-    std::cout << "Adding noise...\n";
-    AddNoise();
-  }
+  // Filter whatever is left in the final partial block
+  filterQ.Flush();
+  if (filterI.Flush()) AddSamples();
+  FlushSamples();
 }
 
-rad::Signal::~Signal() {
-  delete grVITime;
-  delete grVQTime;
+void rad::Signal::GetFileInfo() {
+  TrajectoryPoint first, last;
+  ReadState(0, first);
+  ReadState(nStates - 1, last);
+  fileStartTime = first.time;
+  fileEndTime = last.time;
 }
 
-void rad::Signal::GetFileInfo() {
-  inputTree->GetEntry(0);
-  fileStartTime = time;
-  inputTree->GetEntry(inputTree->GetEntries() - 1);
-  fileEndTime = time;
-  filePntsPerTime =
-      double(inputTree->GetEntries()) / (fileEndTime - fileStartTime);
+double rad::Signal::CalcVoltageAtState(const TrajectoryPoint& pt,
+                                       IAntenna* ant) const {
+  ROOT::Math::XYZVector eField{
+      CalcEField(ant->GetAntennaPosition(), pt.pos, pt.vel, pt.acc)};
+  TVector3 eField2(eField.X(), eField.Y(), eField.Z());
+  double voltage{(eField2.Dot(ant->GetETheta(pt.pos)) +
+                  eField2.Dot(ant->GetEPhi(pt.pos))) *
+                 ant->GetHEff()};
+  return voltage / 2.0;
 }
 
 double rad::Signal::CalcVoltage(double tr, IAntenna* ant) {
+  double voltage{0};
+  if (CalcVoltageFromWindow(tr, ant, voltage)) return voltage;
+
+  // Move the window to the states used for the interpolation. They span
+  // far less than the window so they all fit.
+  const unsigned long i{FindStateIndex(tr)};
+  GetWindowState(std::min(nStates - 1, i + 2));
+  GetWindowState(i > 0 ? i - 1 : 0);
+  if (!CalcVoltageFromWindow(tr, ant, voltage)) {
+    std::cout << "Unable to load the states at time " << tr
+              << " s. Exiting.\n";
+    exit(1);
+  }
+  return voltage;
+}
+
+bool rad::Signal::CalcVoltageFromWindow(double tr, IAntenna* ant,
+                                        double& voltage) const {
   if (tr == -1) {
     // The voltage is from before the signal has reached the antenna
-    return 0;
+    voltage = 0;
+    return true;
+  }
+
+  // Find the last state at or before the retarded time
+  unsigned long correctIndex{0};
+  if (!FindWindowIndex(tr, correctIndex)) return false;
+  const TrajectoryPoint& pt{window[correctIndex - windowStart]};
+  if (pt.time == tr) {
+    // Easy, no need for interpolation
+    voltage = CalcVoltageAtState(pt, ant);
+    return true;
+  }
+  // Keep the interpolation points within the file
+  if (nStates >= 3 && correctIndex > nStates - 3) correctIndex = nStates - 3;
+  const unsigned long first{correctIndex > 0 ? correctIndex - 1 : 0};
+  if (first < windowStart || correctIndex + 2 >= windowStart + window.size()) {
+    return false;
+  }
+
+  // We have the relevant index so we can now do some interpolation
+  double timeVals[4];
+  double vVals[4];
+  if (correctIndex == 0) {
+    timeVals[0] = 0;
+    vVals[0] = 0;
   } else {
-    // We actually have to calculate the voltage
-    // Start off with a first guess
-    int firstGuessTInd{int(round(filePntsPerTime * (tr - fileStartTime)))};
-
-    // Find the appropriate time
-    inputTree->GetEntry(firstGuessTInd);
-    double firstGuessTime{time};
-    unsigned int correctIndex{0};
-    if (firstGuessTime == tr) {
-      // Easy, no need for interpolation
-      TVector3 pos(xPos, yPos, zPos);
-      TVector3 vel(xVel, yVel, zVel);
-      TVector3 acc(xAcc, yAcc, zAcc);
-      ROOT::Math::XYZVector eField{
-          CalcEField(ant->GetAntennaPosition(), pos, vel, acc)};
-      TVector3 eField2(eField.X(), eField.Y(), eField.Z());
-      double voltage{(eField2.Dot(antenna[0]->GetETheta(pos)) +
-                      eField2.Dot(antenna[0]->GetEPhi(pos))) *
-                     antenna[0]->GetHEff()};
-      voltage /= 2.0;
-      return voltage;
-    } else if (firstGuessTime < tr) {
-      // We are searching upwards
-      for (int i{firstGuessTInd}; i < inputTree->GetEntries() - 2; i++) {
-        inputTree->GetEntry(i);
-        double lowerPoint{time};
-        inputTree->GetEntry(i + 1);
-        double upperPoint{time};
-        if (tr > lowerPoint && tr < upperPoint) {
-          correctIndex = i;
-          break;
-        }
-      }
-    } else if (firstGuessTime > tr) {
-      // We are searching downwards
-      for (int i{firstGuessTInd}; i >= 0; i--) {
-        inputTree->GetEntry(i);
-        double lowerPoint{time};
-        inputTree->GetEntry(i + 1);
-        double upperPoint{time};
-        if (tr > lowerPoint && tr < upperPoint) {
-          correctIndex = i;
-          break;
-        }
-      }
-    }
+    const TrajectoryPoint& p0{window[correctIndex - 1 - windowStart]};
+    timeVals[0] = p0.time;
+    vVals[0] = CalcVoltageAtState(p0, ant);
+  }
 
-    // We have the relevant index so we can now do some interpolation
-    std::vector<double> timeVals(4);
-    std::vector<double> vVals(4);
-    if (correctIndex == 0) {
-      timeVals.at(0) = 0;
-      vVals.at(0) = 0;
-    } else {
-      inputTree->GetEntry(correctIndex - 1);
-      timeVals.at(0) = time;
-      TVector3 pos(xPos, yPos, zPos);
-      TVector3 vel(xVel, yVel, zVel);
-      TVector3 acc(xAcc, yAcc, zAcc);
-      ROOT::Math::XYZVector eField{
-          CalcEField(antenna[0]->GetAntennaPosition(), pos, vel, acc)};
-      TVector3 eField2(eField.X(), eField.Y(), eField.Z());
-      double voltage{(eField2.Dot(antenna[0]->GetETheta(pos)) +
-                      eField2.Dot(antenna[0]->GetEPhi(pos))) *
-                     antenna[0]->GetHEff()};
-      voltage /= 2.0;
-      vVals.at(0) = voltage;
+  // Add the rest of the elements of the arrays
+  for (unsigned int iEl{1}; iEl <= 3; iEl++) {
+    const TrajectoryPoint& pEl{window[correctIndex + iEl - 1 - windowStart]};
+    timeVals[iEl] = pEl.time;
+    vVals[iEl] = CalcVoltageAtState(pEl, ant);
+  }
+
+  // Now actually do the cubic interpolation
+  voltage = CubicInterpolation(timeVals, vVals, tr);
+  return true;
+}
+
+unsigned long rad::Signal::FindStateIndex(double t) {
+  if (uniformSteps) {
+    // Index computed directly from the time
+    double guess{std::floor((t - fileStartTime) / stateStepSize)};
+    guess = std::clamp(guess, 0.0, double(nStates - 1));
+    unsigned long i{(unsigned long)guess};
+    // Rounding can put the guess one state out
+    if (i > 0 && GetWindowState(i).time > t) {
+      i--;
+    } else if (i + 1 < nStates && GetWindowState(i + 1).time <= t) {
+      i++;
     }
+    return i;
+  }
+
+  // Otherwise bisect, within the window if it covers the time
+  unsigned long i{0};
+  if (FindWindowIndex(t, i)) return i;
+  return trajectory->GetSource().FindEntry(t);
+}
 
-    // Add the rest of the elements of the vectors
-    for (unsigned int iEl{1}; iEl <= 3; iEl++) {
-      inputTree->GetEntry(correctIndex + iEl - 1);
-      timeVals.at(iEl) = time;
-      TVector3 pos(xPos, yPos, zPos);
-      TVector3 vel(xVel, yVel, zVel);
-      TVector3 acc(xAcc, yAcc, zAcc);
-      ROOT::Math::XYZVector eField{
-          CalcEField(antenna[0]->GetAntennaPosition(), pos, vel, acc)};
-      TVector3 eField2(eField.X(), eField.Y(), eField.Z());
-      double voltage{(eField2.Dot(antenna[0]->GetETheta(pos)) +
-                      eField2.Dot(antenna[0]->GetEPhi(pos))) *
-                     antenna[0]->GetHEff()};
-      voltage /= 2.0;
-      vVals.at(iEl) = voltage;
+bool rad::Signal::FindWindowIndex(double t, unsigned long& i) const {
+  if (window.empty()) return false;
+  const unsigned long windowEnd{windowStart + window.size()};
+  auto stateTime = [&](unsigned long k) {
+    return window[k - windowStart].time;
+  };
+
+  if (uniformSteps) {
+    double guess{std::floor((t - fileStartTime) / stateStepSize)};
+    guess = std::clamp(guess, 0.0, double(nStates - 1));
+    i = (unsigned long)guess;
+    if (i < windowStart || i >= windowEnd) return false;
+    // Rounding can put the guess one state out
+    if (i > 0 && stateTime(i) > t) {
+      if (i == windowStart) return false;
+      i--;
+    } else if (i + 1 < nStates) {
+      if (i + 1 == windowEnd) return false;
+      if (stateTime(i + 1) <= t) i++;
     }
+    return true;
+  }
 
-    // Now actually do the cubic interpolation
-    double vInterp{CubicInterpolation(timeVals, vVals, tr)};
-    return vInterp;
+  // The window must bracket the time, unless it holds the first or last
+  // state of the file
+  if (t < window.front().time && windowStart > 0) return false;
+  if (t >= window.back().time && windowEnd < nStates) return false;
+  auto it{std::upper_bound(window.begin(), window.end(), t,
+                           [](double t, const TrajectoryPoint& p) {
+                             return t < p.time;
+                           })};
+  // Times before the first state of the file give the first state
+  i = it == window.begin() ? windowStart
+                           : windowStart + (it - window.begin()) - 1;
+  return true;
+}
+
+const rad::TrajectoryPoint& rad::Signal::GetWindowState(unsigned long i) {
+  if (i < windowStart || i >= windowStart + window.size()) SlideWindow(i);
+  return window[i - windowStart];
+}
+
+void rad::Signal::SlideWindow(unsigned long i) {
+  // States are mostly requested in increasing order, by both the main loop
+  // and the retarded time lookups which lag behind it. Start the window far
+  // enough back to serve both.
+  const unsigned long newStart{i > kWindowLag ? i - kWindowLag : 0};
+  const unsigned long newEnd{std::min(nStates, newStart + kWindowSize)};
+
+  // Keep any states that are already decoded
+  const unsigned long oldEnd{windowStart + window.size()};
+  size_t nKept{0};
+  if (newStart >= windowStart && newStart < oldEnd) {
+    nKept = oldEnd - newStart;
+    std::move(window.begin() + (newStart - windowStart), window.end(),
+              window.begin());
+  }
+  window.resize(newEnd - newStart);
+  for (size_t k{nKept}; k < window.size(); k++) {
+    ReadState(newStart + k, window[k]);
   }
+  windowStart = newStart;
 }
 
 void rad::Signal::AddNewTimes(double time, TVector3 ePos) {
-  timeVec.push_back(time);
+  // Once full, the buffers drop their oldest element
+  timeVec.PushBack(time);
 
-  // Now calculate advanced time for each antenna point
-  for (size_t i{0}; i < antenna.size(); i++) {
-    double ta{time +
-              (ePos - antenna.at(i)->GetAntennaPosition()).Mag() / TMath::C()};
-    advancedTimeVec.at(i).push_back(ta);
-  }
+  // The advanced times for each antenna are calculated when next needed
+  newTimes.push_back(time);
+  newPositions.push_back(ePos);
+}
 
-  // If the deques are getting too long, get rid of the first element
-  if (timeVec.size() > 10000) {
-    timeVec.pop_front();
-    for (size_t i{0}; i < antenna.size(); i++) {
-      advancedTimeVec.at(i).pop_front();
-    }
+void rad::Signal::UpdateAdvancedTimes(unsigned int antInd) {
+  const TVector3 antPos{antenna[antInd]->GetAntennaPosition()};
+  for (size_t i{0}; i < newTimes.size(); i++) {
+    double ta{newTimes[i] + (newPositions[i] - antPos).Mag() / TMath::C()};
+    advancedTimeVec[antInd].PushBack(ta);
   }
 }
 
-double rad::Signal::GetRetardedTime(double ts, unsigned int antInd) {
-  unsigned int chosenInd{0};
+void rad::Signal::ClearNewTimes() {
+  newTimes.clear();
+  newPositions.clear();
+}
+
+bool rad::Signal::PrepareWindow(const std::vector<double>& retardedTimes) {
+  double trMin{-1};
+  double trMax{-1};
+  for (double tr : retardedTimes) {
+    if (tr == -1) continue;
+    if (trMin == -1 || tr < trMin) trMin = tr;
+    if (trMax == -1 || tr > trMax) trMax = tr;
+  }
+  if (trMin == -1) return true;
+
+  // Interpolation uses one state before and two after the one found, which
+  // is kept at least three states from the end
+  const unsigned long iMin{
+      std::min(FindStateIndex(trMin), nStates >= 3 ? nStates - 3 : 0)};
+  const unsigned long first{iMin > 0 ? iMin - 1 : 0};
+  const unsigned long last{std::min(nStates - 1, FindStateIndex(trMax) + 2)};
+  GetWindowState(last);
+  GetWindowState(first);
+  return first >= windowStart && last < windowStart + window.size();
+}
 
-  // Check if the sample time is before the signal has reached the antenna
-  if (ts < advancedTimeVec.at(antInd).at(0)) {
-    return -1;
+uint64_t rad::Signal::FindBracket(const RingBuffer<double>& ta, double ts,
+                                  uint64_t hint) {
+  // Search between the oldest point and the last one with two points after
+  const uint64_t lo{ta.FirstPos()};
+  const uint64_t hi{ta.LastPos() - 2};
+  uint64_t i{std::clamp(hint, lo, hi)};
+
+  // Gallop away from the hint in doubling steps until ts is bracketed, then
+  // bisect. Consecutive samples move the bracket on by a few points, so this
+  // is a handful of comparisons.
+  uint64_t below{i};  // Highest point known to be before ts
+  uint64_t above{i};  // Lowest point known to be at or after ts
+  if (ta.At(i) < ts) {
+    uint64_t step{1};
+    above = i + step;
+    while (above <= hi && ta.At(above) < ts) {
+      below = above;
+      step *= 2;
+      above = below + step;
+    }
+    if (above > hi) above = hi + 1;
   } else {
-    // Find the values which the sample time lives in between
-    // Firstly get a good first guess of where to start looking
-    unsigned int firstGuess{GetFirstGuessPoint(ts, antInd)};
-    // Check which direction to search in
-    if (advancedTimeVec.at(antInd).at(firstGuess) < ts) {
-      // We are searching upwards
-      for (size_t i{firstGuess}; i < advancedTimeVec.at(antInd).size() - 2;
-           i++) {
-        // Aim to find the advanced time values the ssample point lies between
-        if (ts > advancedTimeVec.at(antInd).at(i) &&
-            ts < advancedTimeVec.at(antInd).at(i + 1)) {
-          chosenInd = i;
-          break;
-        }
-      }
-    } else {
-      // We are searching downwards
-      for (size_t i{firstGuess}; i >= 0; i--) {
-        if (ts > advancedTimeVec.at(antInd).at(i) &&
-            ts < advancedTimeVec.at(antInd).at(i + 1)) {
-          chosenInd = i;
-          break;
-        }
-      }
+    uint64_t step{1};
+    below = i;
+    while (below > lo && ta.At(below) >= ts) {
+      above = below;
+      below = below - std::min(step, below - lo);
+      step *= 2;
     }
-
-    // Now we have the relevant index, we need to interpolate
-    // This should be the retarded time
-
-    std::vector<double> timeVals(4);
-    std::vector<double> advancedTimeVals(4);
-    if (chosenInd == 0) {
-      timeVals.at(0) = 0;
-      advancedTimeVals.at(0) = 0;
+    if (ta.At(below) >= ts) return lo;
+  }
+  while (above - below > 1) {
+    const uint64_t mid{below + (above - below) / 2};
+    if (ta.At(mid) < ts) {
+      below = mid;
     } else {
-      timeVals.at(0) = timeVec.at(chosenInd - 1);
-      advancedTimeVals.at(0) = advancedTimeVec.at(antInd).at(chosenInd - 1);
+      above = mid;
     }
-    timeVals.at(1) = timeVec.at(chosenInd);
-    timeVals.at(2) = timeVec.at(chosenInd + 1);
-    timeVals.at(3) = timeVec.at(chosenInd + 2);
-    advancedTimeVals.at(1) = advancedTimeVec.at(antInd).at(chosenInd);
-    advancedTimeVals.at(2) = advancedTimeVec.at(antInd).at(chosenInd + 1);
-    advancedTimeVals.at(3) = advancedTimeVec.at(antInd).at(chosenInd + 2);
-    return CubicInterpolation(advancedTimeVals, timeVals, ts);
   }
+  return below;
 }
 
-void rad::Signal::SetUpTree(TString filePath) {
-  // Open the input file
-  OpenInputFile(filePath);
-
-  inputTree = (TTree*)inputFile->Get("tree");
-  inputTree->SetBranchAddress("time", &time);
-  inputTree->SetBranchAddress("xPos", &xPos);
-  inputTree->SetBranchAddress("yPos", &yPos);
-  inputTree->SetBranchAddress("zPos", &zPos);
-  inputTree->SetBranchAddress("xVel", &xVel);
-  inputTree->SetBranchAddress("yVel", &yVel);
-  inputTree->SetBranchAddress("zVel", &zVel);
-  inputTree->SetBranchAddress("xAcc", &xAcc);
-  inputTree->SetBranchAddress("yAcc", &yAcc);
-  inputTree->SetBranchAddress("zAcc", &zAcc);
+double rad::Signal::GetRetardedTime(double ts, unsigned int antInd) {
+  const RingBuffer<double>& ta{advancedTimeVec[antInd]};
+
+  // Check if the sample time is before the signal has reached the antenna,
+  // or there are not yet enough points to interpolate
+  if (ta.Size() < 4 || ts < ta.Front()) return -1;
+
+  // Find the advanced time values the sample time lies between, starting
+  // from the previous result for this antenna
+  const uint64_t chosenPos{FindBracket(ta, ts, lastBracket[antInd])};
+  lastBracket[antInd] = chosenPos;
+
+  // Now we have the relevant index, we need to interpolate
+  // This should be the retarded time
+  double timeVals[4];
+  double advancedTimeVals[4];
+  if (chosenPos == ta.FirstPos()) {
+    timeVals[0] = 0;
+    advancedTimeVals[0] = 0;
+  } else {
+    timeVals[0] = timeVec.At(chosenPos - 1);
+    advancedTimeVals[0] = ta.At(chosenPos - 1);
+  }
+  for (unsigned int iEl{1}; iEl <= 3; iEl++) {
+    timeVals[iEl] = timeVec.At(chosenPos + iEl - 1);
+    advancedTimeVals[iEl] = ta.At(chosenPos + iEl - 1);
+  }
+  return CubicInterpolation(advancedTimeVals, timeVals, ts);
 }
 
-void rad::Signal::OpenInputFile(TString filePath) {
-  // Check if input file opens properly
-  inputFile = std::make_unique<TFile>(filePath, "READ");
-  if (!inputFile->IsOpen()) {
-    std::cout << "Couldn't open file! Exiting.\n";
-    exit(1);
+void rad::Signal::OpenTrajectory(TString filePath) {
+  trajectory = std::make_unique<TrajectoryInterpolator>(filePath);
+  // Decimated files are read back at the simulation step, reconstructing
+  // the skipped states from the stored ones
+  if (trajectory->IsDecimated()) {
+    std::cout << "Reconstructing every " << trajectory->GetStride()
+              << " steps from the decimated trajectory\n";
+    nStates = trajectory->GetNSimSteps();
+  } else {
+    nStates = trajectory->GetSource().GetNEntries();
   }
+
+  // Check whether state indices can be computed directly from the time
+  TrajectoryPoint first, second, last;
+  ReadState(0, first);
+  ReadState(1, second);
+  ReadState(nStates - 1, last);
+  stateStepSize = second.time - first.time;
+  const double expectedEnd{first.time + double(nStates - 1) * stateStepSize};
+  uniformSteps = std::abs(last.time - expectedEnd) < 1e-6 * stateStepSize;
+  window.reserve(kWindowSize);
 }
 
-unsigned int rad::Signal::GetFirstGuessPoint(double ts, unsigned int antInd) {
-  const size_t taVecSize{advancedTimeVec.at(antInd).size()};
-  const double pntsPerTime{double(taVecSize) /
-                           (advancedTimeVec.at(antInd).at(taVecSize - 1) -
-                            advancedTimeVec.at(antInd).at(0))};
+void rad::Signal::ReadState(unsigned long i, TrajectoryPoint& pt) {
+  if (trajectory->IsDecimated()) {
+    pt.time = trajectory->GetStartTime() +
+              double(i) * trajectory->GetSimStepSize();
+    trajectory->GetState(pt.time, pt.pos, pt.vel, pt.acc);
+  } else {
+    trajectory->GetSource().GetEntry(i, pt);
+  }
+}
 
-  size_t firstGuessPnt{
-      size_t(round(pntsPerTime * (ts - advancedTimeVec.at(antInd).at(0))))};
-  if (firstGuessPnt < 0) firstGuessPnt = 0;
-  return firstGuessPnt;
+void rad::Signal::LoadState(unsigned long i) {
+  const TrajectoryPoint& pt{GetWindowState(i)};
+  time = pt.time;
+  xPos = pt.pos.X();
+  yPos = pt.pos.Y();
+  zPos = pt.pos.Z();
+  xVel = pt.vel.X();
+  yVel = pt.vel.Y();
+  zVel = pt.vel.Z();
+  xAcc = pt.acc.X();
+  yAcc = pt.acc.Y();
+  zAcc = pt.acc.Z();
 }
 
 void rad::Signal::CloseInputFile() {
-  delete inputTree;
-  inputFile->Close();
+  window.clear();
+  window.shrink_to_fit();
+  trajectory.reset();
 }
 
 void rad::Signal::DownmixVoltages(double& vi, double& vq, double t) {
@@ -489,28 +592,57 @@ void rad::Signal::DownmixVoltages(double& vi, double& vq, double t) {
   vq *= localOsc.GetQuadratureComponent(t);
 }
 
-void rad::Signal::AddNoise() {
-  // Set up the noise terms
+void rad::Signal::SetUpNoise() {
   for (auto& n : noiseVec) {
     n.SetSampleFreq(sampleRate);
     n.SetSigma();
   }
+}
+
+void rad::Signal::AddSample(double vi, double vq) {
+  viBlock.push_back(vi);
+  vqBlock.push_back(vq);
+  if (viBlock.size() == kOutputBlockSize) FlushSamples();
+}
 
-  // Now actually add the noise
-  for (int i{0}; i < grVITime->GetN(); i++) {
-    double vi{grVITime->GetPointY(i)};
-    double vq{grVQTime->GetPointY(i)};
+void rad::Signal::FlushSamples() {
+  // Noise is added in sample order, so it does not depend on the blocking
+  for (size_t i{0}; i < viBlock.size(); i++) {
     for (auto& n : noiseVec) {
-      vi += n.GetNoiseVoltage(true);
-      vq += n.GetNoiseVoltage(true);
+      viBlock[i] += n.GetNoiseVoltage(true);
+      vqBlock[i] += n.GetNoiseVoltage(true);
+    }
+  }
+
+  if (sinks.empty()) {
+    for (size_t i{0}; i < viBlock.size(); i++) {
+      viTime.PushBack(viBlock[i]);
+      vqTime.PushBack(vqBlock[i]);
     }
-    grVITime->SetPointY(i, vi);
-    grVQTime->SetPointY(i, vq);
+  } else {
+    const double dt{viTime.GetTimeStep()};
+    const double t0{double(nOutput) * dt};
+    const TimeSeriesView vi(t0, dt, viBlock);
+    const TimeSeriesView vq(t0, dt, vqBlock);
+    for (auto sink : sinks) sink->AddSamples(vi, vq);
   }
+  nOutput += viBlock.size();
+  viBlock.clear();
+  vqBlock.clear();
+}
+
+TGraph* rad::Signal::GetVITimeDomain() const {
+  return MakeVoltageGraph(viTime, "V_{I}");
+}
+
+TGraph* rad::Signal::GetVQTimeDomain() const {
+  return MakeVoltageGraph(vqTime, "V_{Q}");
 }
 
 TGraph* rad::Signal::GetVIPowerPeriodogram(double loadResistance) {
-  TGraph* grOut = MakePowerSpectrumPeriodogram(grVITime);
+  TGraph* grVI = viTime.ToTGraph();
+  TGraph* grOut = MakePowerSpectrumPeriodogram(grVI);
+  delete grVI;
   setGraphAttr(grOut);
   grOut->SetTitle("V_{I}; Frequency [Hz]; Power [W]");
   ScaleGraph(grOut, 1 / loadResistance);
@@ -518,20 +650,20 @@ TGraph* rad::Signal::GetVIPowerPeriodogram(double loadResistance) {
 }
 
 TGraph* rad::Signal::GetVQPowerPeriodogram(double loadResistance) {
-  TGraph* grOut = MakePowerSpectrumPeriodogram(grVQTime);
+  TGraph* grVQ = vqTime.ToTGraph();
+  TGraph* grOut = MakePowerSpectrumPeriodogram(grVQ);
+  delete grVQ;
   setGraphAttr(grOut);
   grOut->SetTitle("V_{Q}; Frequency [Hz]; Power [W]");
   ScaleGraph(grOut, 1 / loadResistance);
   return grOut;
 }
 
-void rad::Signal::CreateVoltageGraphs() {
-  grVITime = new TGraph();
-  grVQTime = new TGraph();
-  setGraphAttr(grVITime);
-  setGraphAttr(grVQTime);
-  grVITime->GetYaxis()->SetTitle("V_{I}");
-  grVQTime->GetYaxis()->SetTitle("V_{Q}");
-  grVITime->GetXaxis()->SetTitle("Time [s]");
-  grVQTime->GetXaxis()->SetTitle("Time [s]");
+TGraph* rad::Signal::MakeVoltageGraph(const TimeSeries& v,
+                                      const char* title) {
+  TGraph* gr = v.ToTGraph();
+  setGraphAttr(gr);
+  gr->GetYaxis()->SetTitle(title);
+  gr->GetXaxis()->SetTitle("Time [s]");
+  return gr;
 }
\ No newline at end of file
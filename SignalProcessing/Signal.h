@@ -7,17 +7,18 @@
 #ifndef SIGNAL_H
 #define SIGNAL_H
 
-#include <deque>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "Antennas/IAntenna.h"
-#include "BasicFunctions/ButterworthFilter.h"
+#include "BasicFunctions/RingBuffer.h"
+#include "BasicFunctions/TimeSeries.h"
+#include "BasicFunctions/TrajectoryInterpolator.h"
+#include "SignalProcessing/ISignalSink.h"
 #include "SignalProcessing/LocalOscillator.h"
 #include "SignalProcessing/NoiseFunc.h"
-#include "TFile.h"
 #include "TGraph.h"
-#include "TTree.h"
 
 namespace rad {
 class Signal {
@@ -29,9 +30,11 @@ class Signal {
   /// @param sRate Sample rate in Hertz
   /// @param noiseTerms Vector of noise terms
   /// @param tAcq Acquisition time for signal in seconds
+  /// @param outputSinks Sinks to pass the output voltages to as they are
+  /// made. If any are given the voltages are not stored.
   Signal(TString trajectoryFilePath, IAntenna* ant, LocalOscillator lo,
          double sRate, std::vector<GaussianNoise> noiseTerms = {},
-         double tAcq = -1);
+         double tAcq = -1, std::vector<ISignalSink*> outputSinks = {});
 
   /// @brief Parametrised constructor for multiple antennas
   /// @param trajectoryFilePath String to electron trajectory file
@@ -40,20 +43,31 @@ class Signal {
   /// @param sRate Sample rate in Hertz
   /// @param noiseTerms Vector of noise terms
   /// @param tAcq Acquisition time for signal in seconds
+  /// @param nThreads Number of threads to share the antennas between. 0 uses
+  /// one per hardware thread
+  /// @param outputSinks Sinks to pass the output voltages to as they are
+  /// made. If any are given the voltages are not stored.
   Signal(TString trajectoryFilePath, std::vector<IAntenna*> ant,
          LocalOscillator lo, double sRate,
-         std::vector<GaussianNoise> noiseTerms = {}, double tAcq = -1);
-
-  /// Destructor
-  ~Signal();
+         std::vector<GaussianNoise> noiseTerms = {}, double tAcq = -1,
+         unsigned int nThreads = 1,
+         std::vector<ISignalSink*> outputSinks = {});
 
   /// @brief Getter function for in-phase voltage component
-  /// @return Time domain voltage graph
-  TGraph* GetVITimeDomain() { return grVITime; }
+  /// @return Time domain voltage graph, owned by the caller
+  TGraph* GetVITimeDomain() const;
 
   /// @brief Getter function for quadrature voltage component
-  /// @return Time domain voltage graph
-  TGraph* GetVQTimeDomain() { return grVQTime; }
+  /// @return Time domain voltage graph, owned by the caller
+  TGraph* GetVQTimeDomain() const;
+
+  /// @brief In-phase voltage component, without copying
+  /// @return Voltages in volts, starting at time zero
+  const TimeSeries& GetVITimeSeries() const { return viTime; }
+
+  /// @brief Quadrature voltage component, without copying
+  /// @return Voltages in volts, starting at time zero
+  const TimeSeries& GetVQTimeSeries() const { return vqTime; }
 
   /// @brief Returns the power spectrum of the in-phase voltage component after
   /// all signal processing Power spectrum in this case is the periodogram
@@ -77,64 +91,156 @@ class Signal {
   // Noise terms
   std::vector<GaussianNoise> noiseVec;
 
-  TGraph* grVITime = 0;  // In phase component
-  TGraph* grVQTime = 0;  // Quadrature component
-
-  std::deque<double> timeVec;
-  std::vector<std::deque<double>> advancedTimeVec;  // One deque per antenna
+  // Voltages are first sampled at a multiple of the sample rate and then
+  // filtered and downsampled
+  static constexpr unsigned int kDecimationRatio{10};
+  // Edges of the decimating filter as fractions of the sample rate
+  static constexpr double kPassbandFraction{0.4};
+  static constexpr double kStopbandFraction{0.5};
+  // New samples filtered with each FFT when filtering in blocks
+  static constexpr unsigned int kFFTBlockSize{8192};
+
+  TimeSeries viTime;  // In phase component
+  TimeSeries vqTime;  // Quadrature component
+
+  // Output is passed on in blocks, with noise added, to the sinks or to the
+  // stored voltages
+  static constexpr size_t kOutputBlockSize{4096};
+  std::vector<ISignalSink*> sinks;
+  std::vector<double> viBlock;
+  std::vector<double> vqBlock;
+  unsigned long nOutput{0};  // Number of samples passed on so far
+
+  // Recent times from the file and the corresponding advanced times
+  static constexpr size_t kTimeBufferSize{16384};
+  RingBuffer<double> timeVec{kTimeBufferSize};
+  std::vector<RingBuffer<double>> advancedTimeVec;  // One buffer per antenna
+  // Position of the last retarded time bracket found for each antenna
+  std::vector<uint64_t> lastBracket;
+  // States added since the advanced times were last updated
+  std::vector<double> newTimes;
+  std::vector<TVector3> newPositions;
 
   // Input file details
   double fileStartTime{};
   double fileEndTime{};
-  double filePntsPerTime{};
 
-  // Pointer to input file
-  std::unique_ptr<TFile> inputFile = 0;
-  // Pointer to input tree from file
-  TTree* inputTree = 0;
-  // Variables for input tree
+  // Input trajectory, which also reconstructs the states of decimated files
+  std::unique_ptr<TrajectoryInterpolator> trajectory;
+  // Number of states to read, on the simulation step grid
+  unsigned long nStates{};
+  // Currently loaded electron state
   double time{};
   double xPos{}, yPos{}, zPos{};
   double xVel{}, yVel{}, zVel{};
   double xAcc{}, yAcc{}, zAcc{};
 
+  // Decoded states held in memory, following the requested times
+  static constexpr unsigned long kWindowSize{16384};
+  // Number of states kept behind the requested one when the window moves
+  static constexpr unsigned long kWindowLag{8192};
+  std::vector<TrajectoryPoint> window;
+  unsigned long windowStart{0};  // Index of the first state in the window
+  // Are the states evenly spaced in time, and if so by how much
+  bool uniformSteps{false};
+  double stateStepSize{};
+
   // Pointer to the antenna
   std::vector<IAntenna*> antenna;
 
   /// @brief Function to add new times to vectors
   /// @param time New time from file in seconds
   /// @param ePos Electron position vector in metres
-  /// @param ant Pointer to chosen antenna
   void AddNewTimes(double time, TVector3 ePos);
 
+  /// @brief Calculates the advanced times of the states added since the last
+  /// call to ClearNewTimes for one antenna
+  /// @param antInd Index of the antenna
+  void UpdateAdvancedTimes(unsigned int antInd);
+
+  /// @brief Clears the new states once every antenna has been updated
+  void ClearNewTimes();
+
+  /// @brief Moves the window to hold all the states needed to calculate the
+  /// voltages at a set of retarded times, so they can be read concurrently
+  /// @param retardedTimes Retarded times in seconds, -1 if not yet reached
+  /// @return False if the states needed do not fit in the window
+  bool PrepareWindow(const std::vector<double>& retardedTimes);
+
   /// @brief Calculate the retarded time
   /// @param ts Sample time in seconds
   /// @param antInd
   /// @return Relevant retarded time in seconds
   double GetRetardedTime(double ts, unsigned int antInd);
 
-  /// @brief Get a guess for the index to start at
+  /// @brief Find the last advanced time before a sample time
+  /// @param ta Advanced times, which increase monotonically
   /// @param ts Sample time in seconds
-  /// @return Index of guess
-  unsigned int GetFirstGuessPoint(double ts, unsigned int antInd);
-
-  /// @brief Sets up the tree to be read in
-  /// @param filePath Path to electron trajectory file
-  void SetUpTree(TString filePath);
+  /// @param hint Position to start searching from
+  /// @return Position in the buffer, leaving two points after it
+  static uint64_t FindBracket(const RingBuffer<double>& ta, double ts,
+                              uint64_t hint);
+
+  /// @brief Opens the trajectory to be read in
+  /// @param filePath Path to electron trajectory file (ROOT or columnar)
+  void OpenTrajectory(TString filePath);
+
+  /// @brief Reads a state from the trajectory, bypassing the window
+  /// @param i Index of the state on the simulation step grid
+  /// @param pt Set to the state
+  void ReadState(unsigned long i, TrajectoryPoint& pt);
+
+  /// @brief Loads a state into the electron state variables
+  /// @param i Index of the state on the simulation step grid
+  void LoadState(unsigned long i);
+
+  /// @brief Returns a state from the in-memory window, moving it if needed
+  /// @param i Index of the state on the simulation step grid
+  /// @return Reference to the state, valid until the window next moves
+  const TrajectoryPoint& GetWindowState(unsigned long i);
+
+  /// @brief Moves the window so that it contains a state
+  /// @param i Index of the state on the simulation step grid
+  void SlideWindow(unsigned long i);
+
+  /// @brief Finds the last state at or before a time. The index is computed
+  /// directly for evenly spaced states, otherwise found by bisection
+  /// @param t Time in seconds
+  /// @return Index of the state
+  unsigned long FindStateIndex(double t);
 
-  /// @brief Safely open the input
-  /// @param filePath Path to electron trajectory file
-  void OpenInputFile(TString filePath);
+  /// @brief Finds the last state at or before a time using only the states
+  /// already in the window, so it can be called concurrently
+  /// @param t Time in seconds
+  /// @param i Set to the index of the state
+  /// @return False if the window does not hold the states needed
+  bool FindWindowIndex(double t, unsigned long& i) const;
 
   /// @brief Safely closes the input file
   void CloseInputFile();
 
-  /// @brief Calculate the voltage at a given time
+  /// @brief Calculate the voltage at a given time, moving the window to the
+  /// states needed
   /// @param tr Retarded time at which to calculate the voltage [seconds]
   /// @param ant Pointer to chosen antenna
   /// @return Voltage in volts
   double CalcVoltage(double tr, IAntenna* ant);
 
+  /// @brief Calculate the voltage at a given time from the states already in
+  /// the window. Neither the window nor the trajectory is modified, so this
+  /// can be called concurrently once PrepareWindow has succeeded
+  /// @param tr Retarded time at which to calculate the voltage [seconds]
+  /// @param ant Pointer to chosen antenna
+  /// @param voltage Set to the voltage in volts
+  /// @return False if a state needed is not in the window
+  bool CalcVoltageFromWindow(double tr, IAntenna* ant, double& voltage) const;
+
+  /// @brief Calculate the voltage from a single electron state
+  /// @param pt Electron state
+  /// @param ant Pointer to chosen antenna
+  /// @return Voltage in volts
+  double CalcVoltageAtState(const TrajectoryPoint& pt, IAntenna* ant) const;
+
   /// @brief Function for downmixing voltages
   /// @param vi In phase voltage component
   /// @param vq Quadrature voltage component
@@ -144,11 +250,22 @@ class Signal {
   /// @brief Sets some key parameters about the input file
   void GetFileInfo();
 
-  /// @brief Adds noise to the signals
-  void AddNoise();
+  /// @brief Sets the noise terms up for the sample rate
+  void SetUpNoise();
+
+  /// @brief Adds an output sample to the current block
+  /// @param vi In phase voltage [V]
+  /// @param vq Quadrature voltage [V]
+  void AddSample(double vi, double vq);
+
+  /// @brief Adds noise to the current block and passes it on
+  void FlushSamples();
 
-  /// @brief Sets up voltage graphs for class
-  void CreateVoltageGraphs();
+  /// @brief Copies a voltage component into a graph
+  /// @param v Voltage component
+  /// @param title Title of the voltage axis
+  /// @return Graph owned by the caller
+  static TGraph* MakeVoltageGraph(const TimeSeries& v, const char* title);
 };
 
 }  // namespace rad
@@ -0,0 +1,120 @@
+/*
+  SingleBinTracker.cxx
+*/
+
+#include "SignalProcessing/SingleBinTracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "BasicFunctions/BasicFunctions.h"
+#include "TAxis.h"
+
+rad::SingleBinTracker::SingleBinTracker(double sampleRate,
+                                        std::vector<double> frequencies,
+                                        size_t blockLength,
+                                        SignalComponent component)
+    : deltaT(1 / sampleRate),
+      blockLength(blockLength),
+      component(component),
+      freqs(frequencies),
+      s1(frequencies.size(), 0.0),
+      s2(frequencies.size(), 0.0),
+      power(frequencies.size()) {
+  if (blockLength == 0 || frequencies.empty()) {
+    std::cout << "Need a block length and at least one frequency to track. "
+                 "Exiting.\n";
+    exit(1);
+  }
+  for (double f : freqs) {
+    if (f < 0 || f > sampleRate / 2) {
+      std::cout << "Tracked frequency " << f
+                << " Hz is outside the Nyquist range. Exiting.\n";
+      exit(1);
+    }
+    coeff.push_back(2 * cos(2 * M_PI * f * deltaT));
+  }
+}
+
+void rad::SingleBinTracker::Push(double x) {
+  for (size_t i{0}; i < freqs.size(); i++) {
+    const double s0{x + coeff[i] * s1[i] - s2[i]};
+    s2[i] = s1[i];
+    s1[i] = s0;
+  }
+  if (++nFill == blockLength) FinishBlock();
+}
+
+void rad::SingleBinTracker::Push(std::span<const double> x) {
+  while (!x.empty()) {
+    const size_t n{std::min(x.size(), blockLength - nFill)};
+    // Run each recursion over the whole run of samples in turn
+    for (size_t i{0}; i < freqs.size(); i++) {
+      const double c{coeff[i]};
+      double a{s1[i]};
+      double b{s2[i]};
+      for (size_t j{0}; j < n; j++) {
+        const double s0{x[j] + c * a - b};
+        b = a;
+        a = s0;
+      }
+      s1[i] = a;
+      s2[i] = b;
+    }
+    nFill += n;
+    x = x.subspan(n);
+    if (nFill == blockLength) FinishBlock();
+  }
+}
+
+void rad::SingleBinTracker::AddSamples(TimeSeriesView vi, TimeSeriesView vq) {
+  if (!haveStartTime) {
+    startTime = vi.GetStartTime();
+    haveStartTime = true;
+  }
+  Push(component == SignalComponent::kInPhase ? vi.GetValues()
+                                              : vq.GetValues());
+}
+
+void rad::SingleBinTracker::FinishBlock() {
+  const double n{double(blockLength)};
+  for (size_t i{0}; i < freqs.size(); i++) {
+    // Squared magnitude of the DFT at this frequency
+    const double mag2{s1[i] * s1[i] + s2[i] * s2[i] -
+                      coeff[i] * s1[i] * s2[i]};
+    // Periodogram normalisation, including the negative frequency
+    const bool folded{freqs[i] > 0 && 2 * freqs[i] * deltaT < 1};
+    power[i].push_back(std::max(mag2, 0.0) * (folded ? 2 : 1) / (n * n));
+    s1[i] = 0;
+    s2[i] = 0;
+  }
+  nFill = 0;
+  nBlocks++;
+}
+
+void rad::SingleBinTracker::Reset() {
+  std::fill(s1.begin(), s1.end(), 0.0);
+  std::fill(s2.begin(), s2.end(), 0.0);
+  nFill = 0;
+  for (auto& p : power) p.clear();
+  nBlocks = 0;
+  haveStartTime = false;
+  startTime = 0;
+}
+
+TGraph* rad::SingleBinTracker::GetPowerGraph(size_t i,
+                                             double loadResistance) const {
+  const double blockTime{double(blockLength) * deltaT};
+  TGraph* gr = new TGraph(int(nBlocks));
+  double* x{gr->GetX()};
+  double* y{gr->GetY()};
+  for (size_t b{0}; b < nBlocks; b++) {
+    x[b] = startTime + (double(b) + 0.5) * blockTime;
+    y[b] = power[i][b] / loadResistance;
+  }
+  setGraphAttr(gr);
+  gr->GetXaxis()->SetTitle("Time [s]");
+  gr->GetYaxis()->SetTitle("Power [W]");
+  return gr;
+}
@@ -0,0 +1,99 @@
+/*
+  SingleBinTracker.h
+
+  Tracks the power at a few chosen frequencies of a stream of samples
+  The stream is cut into consecutive blocks, and the DFT of each block is
+  evaluated at each frequency with the Goertzel recursion, which costs one
+  multiply and two adds per sample per frequency. The frequencies need not
+  lie on the DFT bins of the block. This is much cheaper than a full FFT
+  when only a handful of bins are of interest, and only the power of each
+  finished block is stored.
+*/
+
+#ifndef SINGLE_BIN_TRACKER_H
+#define SINGLE_BIN_TRACKER_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "SignalProcessing/ISignalSink.h"
+#include "TGraph.h"
+
+namespace rad {
+class SingleBinTracker : public ISignalSink {
+ public:
+  /// @brief Parametrised constructor
+  /// @param sampleRate Sample rate of the input in Hertz
+  /// @param frequencies Frequencies to track in Hertz, below half the sample
+  /// rate
+  /// @param blockLength Number of samples in each block. The frequency
+  /// resolution is sampleRate / blockLength
+  /// @param component Voltage component used when attached to a Signal
+  SingleBinTracker(double sampleRate, std::vector<double> frequencies,
+                   size_t blockLength,
+                   SignalComponent component = SignalComponent::kInPhase);
+
+  /// @brief Adds an input sample
+  /// @param x Input sample
+  void Push(double x);
+
+  /// @brief Adds a block of input samples
+  /// @param x Input samples
+  void Push(std::span<const double> x);
+
+  /// @brief Adds the chosen component of a block of Signal output
+  void AddSamples(TimeSeriesView vi, TimeSeriesView vq) override;
+
+  /// @brief Clears the partial block and the stored powers
+  void Reset();
+
+  /// @brief Number of frequencies tracked
+  size_t GetNFrequencies() const { return freqs.size(); }
+
+  /// @param i Frequency number
+  /// @return Tracked frequency in Hertz
+  double GetFrequency(size_t i) const { return freqs[i]; }
+
+  /// @brief Number of blocks finished so far
+  size_t GetNBlocks() const { return nBlocks; }
+
+  /// @brief Power of every finished block at one frequency, normalised like
+  /// a periodogram so that a sinusoid on a bin gives its mean squared
+  /// amplitude
+  /// @param i Frequency number
+  /// @return One power per block
+  const std::vector<double>& GetPower(size_t i) const { return power[i]; }
+
+  /// @brief Graph of the power at one frequency against the time of the
+  /// middle of each block
+  /// @param i Frequency number
+  /// @param loadResistance Resistance to convert squared voltages to power
+  /// @return Graph in W, owned by the caller
+  TGraph* GetPowerGraph(size_t i, double loadResistance = 1) const;
+
+ private:
+  double deltaT;
+  size_t blockLength;
+  SignalComponent component;
+  std::vector<double> freqs;
+
+  std::vector<double> coeff;  // 2 cos(omega) for each frequency
+  // Goertzel state of the current block for each frequency
+  std::vector<double> s1;
+  std::vector<double> s2;
+  size_t nFill{0};  // Samples in the current block
+
+  std::vector<std::vector<double>> power;  // Block powers for each frequency
+  size_t nBlocks{0};
+
+  // Time of the first sample, taken from the first Signal output seen
+  double startTime{0};
+  bool haveStartTime{false};
+
+  /// @brief Stores the power of the finished block and starts a new one
+  void FinishBlock();
+};
+}  // namespace rad
+
+#endif
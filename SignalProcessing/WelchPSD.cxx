@@ -0,0 +1,92 @@
+/*
+  WelchPSD.cxx
+*/
+
+#include "SignalProcessing/WelchPSD.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "BasicFunctions/BasicFunctions.h"
+#include "TAxis.h"
+
+rad::WelchPSD::WelchPSD(double sampleRate, size_t segmentLength, size_t hop,
+                        WindowType windowType, SignalComponent component)
+    : deltaT(1 / sampleRate),
+      segmentLength(segmentLength),
+      hop(hop),
+      component(component),
+      spec(segmentLength),
+      window(MakeWindow(windowType, segmentLength)),
+      segment(segmentLength),
+      spectrum(spec.GetNFrequencies()),
+      sum(spec.GetNFrequencies(), 0.0) {
+  if (hop == 0 || hop > segmentLength) {
+    std::cout << "Welch hop must be between 1 and the segment length. "
+                 "Exiting.\n";
+    exit(1);
+  }
+}
+
+void rad::WelchPSD::Push(double x) {
+  segment[nFill++] = x;
+  if (nFill == segmentLength) ProcessSegment();
+}
+
+void rad::WelchPSD::Push(std::span<const double> x) {
+  while (!x.empty()) {
+    const size_t n{std::min(x.size(), segmentLength - nFill)};
+    std::copy(x.begin(), x.begin() + n, segment.begin() + nFill);
+    nFill += n;
+    x = x.subspan(n);
+    if (nFill == segmentLength) ProcessSegment();
+  }
+}
+
+void rad::WelchPSD::AddSamples(TimeSeriesView vi, TimeSeriesView vq) {
+  Push(component == SignalComponent::kInPhase ? vi.GetValues()
+                                              : vq.GetValues());
+}
+
+void rad::WelchPSD::ProcessSegment() {
+  spec.Compute(segment, window, deltaT, SpectrumNorm::kPSD, spectrum);
+  for (size_t k{0}; k < sum.size(); k++) sum[k] += spectrum[k];
+  nSegments++;
+
+  // The overlap becomes the start of the next segment
+  std::copy(segment.begin() + hop, segment.end(), segment.begin());
+  nFill = segmentLength - hop;
+}
+
+void rad::WelchPSD::Reset() {
+  nFill = 0;
+  nSegments = 0;
+  std::fill(sum.begin(), sum.end(), 0.0);
+}
+
+void rad::WelchPSD::GetFrequencies(std::span<double> freqs) const {
+  spec.GetFrequencies(deltaT, freqs);
+}
+
+void rad::WelchPSD::GetPSD(std::span<double> psd) const {
+  const double scale{nSegments == 0 ? 0 : 1 / double(nSegments)};
+  for (size_t k{0}; k < sum.size(); k++) psd[k] = sum[k] * scale;
+}
+
+std::vector<double> rad::WelchPSD::GetPSD() const {
+  std::vector<double> psd(sum.size());
+  GetPSD(psd);
+  return psd;
+}
+
+TGraph* rad::WelchPSD::GetPSDGraph(double loadResistance) const {
+  const int nFreqs{int(sum.size())};
+  TGraph* gr = new TGraph(nFreqs);
+  GetFrequencies({gr->GetX(), sum.size()});
+  GetPSD({gr->GetY(), sum.size()});
+  ScaleGraph(gr, 1 / loadResistance);
+  setGraphAttr(gr);
+  gr->GetXaxis()->SetTitle("Frequency [Hz]");
+  gr->GetYaxis()->SetTitle("PSD [W Hz^{-1}]");
+  return gr;
+}
@@ -0,0 +1,99 @@
+/*
+  WelchPSD.h
+
+  Streaming Welch estimate of a power spectral density
+  Samples are collected into segments, which may overlap, and the windowed
+  periodograms of the segments are averaged. Only one segment of samples
+  and the running sum of the spectra are kept, so the memory used does not
+  grow with the length of the input. With a rectangular window and no
+  overlap this is Bartlett's method.
+*/
+
+#ifndef WELCH_PSD_H
+#define WELCH_PSD_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "BasicFunctions/SpectrumCalculator.h"
+#include "SignalProcessing/ISignalSink.h"
+#include "TGraph.h"
+
+namespace rad {
+class WelchPSD : public ISignalSink {
+ public:
+  /// @brief Parametrised constructor
+  /// @param sampleRate Sample rate of the input in Hertz
+  /// @param segmentLength Number of samples in each segment
+  /// @param hop Number of samples between the starts of consecutive
+  /// segments. Half the segment length is usual with a Hann window
+  /// @param windowType Window function applied to each segment
+  /// @param component Voltage component used when attached to a Signal
+  WelchPSD(double sampleRate, size_t segmentLength, size_t hop,
+           WindowType windowType = WindowType::kHann,
+           SignalComponent component = SignalComponent::kInPhase);
+
+  /// @brief Adds an input sample
+  /// @param x Input sample
+  void Push(double x);
+
+  /// @brief Adds a block of input samples
+  /// @param x Input samples
+  void Push(std::span<const double> x);
+
+  /// @brief Adds the chosen component of a block of Signal output
+  void AddSamples(TimeSeriesView vi, TimeSeriesView vq) override;
+
+  /// @brief Clears the stored samples and the averaged spectrum
+  void Reset();
+
+  /// @brief Number of segments averaged so far
+  size_t GetNSegments() const { return nSegments; }
+
+  /// @brief Number of frequency bins, segmentLength / 2 + 1
+  size_t GetNFrequencies() const { return spec.GetNFrequencies(); }
+
+  /// @brief Frequencies of the bins
+  /// @param freqs Set to the bin frequencies [Hz]. Must hold
+  /// GetNFrequencies() values
+  void GetFrequencies(std::span<double> freqs) const;
+
+  /// @brief Averaged power spectral density of the segments so far. Zero if
+  /// no segment has been completed.
+  /// @param psd Set to the PSD [x^2 Hz^-1]. Must hold GetNFrequencies()
+  /// values
+  void GetPSD(std::span<double> psd) const;
+
+  /// @brief Averaged power spectral density of the segments so far
+  /// @return Vector of GetNFrequencies() values [x^2 Hz^-1]
+  std::vector<double> GetPSD() const;
+
+  /// @brief Graph of the averaged power spectral density
+  /// @param loadResistance Resistance to convert squared voltages to power
+  /// @return Graph in W Hz^-1, owned by the caller
+  TGraph* GetPSDGraph(double loadResistance = 1) const;
+
+ private:
+  double deltaT;
+  size_t segmentLength;
+  size_t hop;
+  SignalComponent component;
+  SpectrumCalculator spec;
+  std::vector<double> window;
+
+  // Samples of the segment being filled
+  std::vector<double> segment;
+  size_t nFill{0};
+
+  std::vector<double> spectrum;  // PSD of the last segment
+  std::vector<double> sum;       // Sum of the segment PSDs
+  size_t nSegments{0};
+
+  /// @brief Adds the full segment to the average and keeps the samples
+  /// shared with the next one
+  void ProcessSegment();
+};
+}  // namespace rad
+
+#endif
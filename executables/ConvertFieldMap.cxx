@@ -0,0 +1,56 @@
+/*
+  ConvertFieldMap.cxx
+
+  Converts a COMSOL CSV field map export to the binary field map format
+  The binary file can be passed to ComsolField/ComsolHarmonicField in place
+  of the CSV and is memory-mapped rather than parsed.
+*/
+
+#include "ElectronDynamics/FieldMapFile.h"
+
+#include <unistd.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  std::string inputFile = " ";
+  std::string outputFile = " ";
+
+  while((opt = getopt(argc, argv, ":i:o:")) != -1) {
+    switch(opt) {
+    case 'i':
+      inputFile = optarg;
+      std::cout<<"Input file is "<<inputFile<<std::endl;
+      break;
+    case 'o':
+      outputFile = optarg;
+      std::cout<<"Output file is "<<outputFile<<std::endl;
+      break;
+    case ':':
+      std::cout<<"Option needs a value"<<std::endl;
+      break;
+    case '?':
+      std::cout<<"Unknown option: "<<optopt<<std::endl;
+      break;
+    }
+  }
+
+  // Check mandatory parameters
+  if (inputFile == " " || outputFile == " ") {
+    std::cout<<"Usage: ConvertFieldMap -i <input CSV> -o <output file>"<<std::endl;
+    return 1;
+  }
+
+  rad::ConvertComsolCSVToBinary(inputFile, outputFile);
+
+  rad::MappedFieldMap map(outputFile);
+  std::cout<<"Wrote "<<map.GetNPoints()<<" nodes";
+  if (map.IsRegularGrid()) {
+    std::cout<<" on a "<<map.GetHeader().nR<<" x "<<map.GetHeader().nZ<<" regular grid";
+  }
+  std::cout<<std::endl;
+  return 0;
+}
@@ -0,0 +1,54 @@
+/*
+  ConvertTrajectory.cxx
+
+  Converts an electron trajectory ROOT file to the columnar trajectory format
+  The columnar file can be passed to Signal, FieldPoint and InducedVoltage in
+  place of the ROOT file and is memory-mapped rather than deserialised.
+*/
+
+#include "BasicFunctions/TrajectorySource.h"
+
+#include <unistd.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  std::string inputFile = " ";
+  std::string outputFile = " ";
+
+  while((opt = getopt(argc, argv, ":i:o:")) != -1) {
+    switch(opt) {
+    case 'i':
+      inputFile = optarg;
+      std::cout<<"Input file is "<<inputFile<<std::endl;
+      break;
+    case 'o':
+      outputFile = optarg;
+      std::cout<<"Output file is "<<outputFile<<std::endl;
+      break;
+    case ':':
+      std::cout<<"Option needs a value"<<std::endl;
+      break;
+    case '?':
+      std::cout<<"Unknown option: "<<optopt<<std::endl;
+      break;
+    }
+  }
+
+  // Check mandatory parameters
+  if (inputFile == " " || outputFile == " ") {
+    std::cout<<"Usage: ConvertTrajectory -i <input ROOT file> -o <output file>"<<std::endl;
+    return 1;
+  }
+
+  auto source = rad::TrajectorySource::Open(inputFile.c_str());
+  rad::WriteColumnarTrajectory(outputFile, *source);
+
+  rad::MappedTrajectorySource traj(outputFile);
+  std::cout<<"Wrote "<<traj.GetNEntries()<<" states from "<<traj.GetStartTime()
+	   <<" to "<<traj.GetEndTime()<<" s"<<std::endl;
+  return 0;
+}
@@ -4,11 +4,14 @@
   Make some fake tracks with a given SNR
 */
 
+#include <algorithm>
 #include <chrono>
 #include <random>
+#include <span>
 
 #include "BasicFunctions/BasicFunctions.h"
 #include "BasicFunctions/Constants.h"
+#include "BasicFunctions/Spectrogram.h"
 #include "TFile.h"
 #include "TGraph.h"
 #include "TH2.h"
@@ -63,6 +66,26 @@ double GetChirpRate(double Ek, double B, double theta) {
           EPSILON0);
 }
 
+// Fills each time bin of a histogram with the periodogram of the next
+// nSamples points of a graph
+void FillSpectrogram(TGraph *gr, int nSamples, TH2D *h2Spec) {
+  const TimeSeriesView samples(gr->GetPointX(0),
+                               gr->GetPointX(1) - gr->GetPointX(0),
+                               std::span<const double>(gr->GetY(),
+                                                       size_t(gr->GetN())));
+  // Time bins do not overlap
+  Spectrogram spec(nSamples, nSamples);
+  spec.Compute(samples, 0);
+
+  const int nBins{std::min(h2Spec->GetNbinsX(), int(spec.GetNFrames()))};
+  for (int iBin{1}; iBin <= nBins; iBin++) {
+    std::span<const double> frame{spec.GetFrame(iBin - 1)};
+    for (size_t iF{0}; iF < frame.size(); iF++) {
+      h2Spec->SetBinContent(iBin, int(iF) + 1, frame[iF]);
+    }
+  }
+}
+
 TH2D *MakeSpectrogram(double srate, double totTime, double snrMax, double B = 1,
                       double theta = TMath::PiOver2(), double Ek = 18.6e3) {
   // Calculate chirp rate
@@ -104,25 +127,7 @@ TH2D *MakeSpectrogram(double srate, double totTime, double snrMax, double B = 1,
   AddWhiteNoise(gr, noiseTemp);
 
   // Now divide the graph up and add to the spectrogram
-  for (int iBin{1}; iBin <= h2Spec->GetNbinsX(); iBin++) {
-    // Create a graph which is the relevant subset of points
-    const int p1{(iBin - 1) * nSamplesPerTimeBin};
-    const int p2{iBin * nSamplesPerTimeBin};
-
-    auto grSub = new TGraph();
-    for (int n{p1}; n < p2; n++) {
-      grSub->SetPoint(grSub->GetN(), gr->GetPointX(n), gr->GetPointY(n));
-    }
-    // Do the FFT
-    auto grSubPower = MakePowerSpectrumPeriodogram(grSub);
-    delete grSub;
-
-    // Now write to the histogram
-    for (int iF{0}; iF < grSubPower->GetN(); iF++) {
-      h2Spec->SetBinContent(iBin, iF + 1, grSubPower->GetPointY(iF));
-    }
-    delete grSubPower;
-  }
+  FillSpectrogram(gr, nSamplesPerTimeBin, h2Spec);
 
   return h2Spec;
 }
@@ -160,25 +165,7 @@ TH2D *MakeSpectrogram(TGraph *grIn, double totTime, double snrMax, double B = 1,
   std::cout << "Downmixed frequency = " << f0DM / 1e6 << " MHz\n";
 
   // Now divide the graph up and add to the spectrogram
-  for (int iBin{1}; iBin <= h2Spec->GetNbinsX(); iBin++) {
-    // Create a graph which is the relevant subset of points
-    const int p1{(iBin - 1) * nSamplesPerTimeBin};
-    const int p2{iBin * nSamplesPerTimeBin};
-
-    auto grSub = new TGraph();
-    for (int n{p1}; n < p2; n++) {
-      grSub->SetPoint(grSub->GetN(), grIn->GetPointX(n), grIn->GetPointY(n));
-    }
-    // Do the FFT
-    auto grSubPower = MakePowerSpectrumPeriodogram(grSub);
-    delete grSub;
-
-    // Now write to the histogram
-    for (int iF{0}; iF < grSubPower->GetN(); iF++) {
-      h2Spec->SetBinContent(iBin, iF + 1, grSubPower->GetPointY(iF));
-    }
-    delete grSubPower;
-  }
+  FillSpectrogram(grIn, nSamplesPerTimeBin, h2Spec);
 
   return h2Spec;
 }
@@ -7,6 +7,7 @@
 #include <getopt.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
@@ -17,6 +18,7 @@
 #include "BasicFunctions/Constants.h"
 #include "BasicFunctions/TritiumSpectrum.h"
 #include "ElectronDynamics/BorisSolver.h"
+#include "ElectronDynamics/GuidingCentreSolver.h"
 #include "ElectronDynamics/QTNMFields.h"
 #include "Scattering/ElasticScatter.h"
 #include "Scattering/InelasticScatter.h"
@@ -38,8 +40,12 @@ int main(int argc, char *argv[]) {
   int opt{};
   std::string outputStemStr{" "};
   unsigned int nElectrons{2000};
+  // Guiding centre step. Full Boris tracking is used if this is not set
+  double gcStepTime{0};  // seconds
+  // Reconstructed orbit steps per guiding centre output sample
+  unsigned int outputStride{2};
 
-  while ((opt = getopt(argc, argv, ":o:n:")) != -1) {
+  while ((opt = getopt(argc, argv, ":o:n:g:d:")) != -1) {
     switch (opt) {
       case 'o':
         outputStemStr = optarg;
@@ -50,6 +56,18 @@ int main(int argc, char *argv[]) {
         nElectrons = std::stoi(optarg);
         break;
 
+      case 'g':
+        gcStepTime = std::stod(optarg);
+        std::cout << "Using guiding centre steps of " << gcStepTime << " s"
+                  << std::endl;
+        break;
+
+      case 'd':
+        outputStride = std::stoi(optarg);
+        std::cout << "Writing every " << outputStride
+                  << " steps of guiding centre tracks" << std::endl;
+        break;
+
       case ':':
         std::cout << "Option needs a value\n";
         break;
@@ -104,118 +122,151 @@ int main(int argc, char *argv[]) {
                  eSpeed * sin(phiVelGen) * sin(thetaVelGen),
                  eSpeed * cos(thetaVelGen));
 
-    // Generate a file and tree
+    // Randomly scatters the electron, updating its velocity and energy
+    auto scatterElectron = [&](TVector3 &v, double &ke) {
+      double gamma{1 / sqrt(1 - pow(v.Mag() / TMath::C(), 2))};
+      ke = (gamma - 1) * ME_EV;
+
+      // Recalculate the cross sections based on the cross-sections
+      ElasticScatter scatEl2(ke);
+      InelasticScatter scatInel2(ke);
+      double elXSec{scatEl2.GetTotalXSec()};
+      double inelXSec{scatInel2.GetTotalXSec()};
+      double totalXSec{elXSec + inelXSec};
+
+      // Figure out if this an elastic or inelastic scatter
+      double scatAngle{0};
+      if (uni1(gen) < elXSec / totalXSec) {
+        // We have an elastic scatter
+        cout << "Elastic scatter\n";
+        // No energy loss so just get the scattering angle
+        scatAngle = scatEl2.GetRandomScatteringAngle();
+        v = scatEl2.GetScatteredVector(v, ke, scatAngle);
+      } else {
+        // We have an inelastic scatter
+        cout << "Inelastic scatter\n";
+        // Get the energy of the secondary
+        double wSample{scatInel2.GetRandomW()};
+        double theta2Sample{scatInel2.GetRandomTheta(wSample)};
+
+        // Now calculate the energy and the scattering angle of the primary
+        scatAngle = scatInel2.GetPrimaryScatteredAngle(wSample, theta2Sample);
+        ke = scatInel2.GetPrimaryScatteredE(wSample, theta2Sample);
+        v = scatInel2.GetScatteredVector(v, ke, scatAngle);
+      }
+      cout << "Scattering angle = " << scatAngle * 180 / TMath::Pi()
+           << " degrees\t New KE = " << ke / 1e3 << " keV\n";
+    };
+
+    // Samples the time until the next scatter
+    auto nextScatterInterval = [&](TVector3 v, double ke) {
+      ElasticScatter scatElNext(ke);
+      double elXSecNext{scatElNext.GetTotalXSec()};
+      InelasticScatter scatInelNext(ke);
+      double inelXSecNext{scatInelNext.GetTotalXSec()};
+      double totalXSecNext{elXSecNext + inelXSecNext};
+      double lambdaStepNext{1 / (tritiumDensity * totalXSecNext)};
+      std::exponential_distribution<double> pathDistStepNext(1 /
+                                                             lambdaStepNext);
+      const double pathLenStepNext{pathDistStepNext(gen)};
+      return pathLenStepNext / v.Mag();
+    };
+
     TString outputFile{outputStem + Form("/track%d.root", i)};
-    TFile fout(outputFile, "recreate");
-    auto tree = new TTree("tree", "tree");
     double time{};
-    double xPos{}, yPos{}, zPos{};
-    double xVel{}, yVel{}, zVel{};
-    double xAcc{}, yAcc{}, zAcc{};
-    tree->Branch("time", &time);
-    tree->Branch("xPos", &xPos);
-    tree->Branch("yPos", &yPos);
-    tree->Branch("zPos", &zPos);
-    tree->Branch("xVel", &xVel);
-    tree->Branch("yVel", &yVel);
-    tree->Branch("zVel", &zVel);
-    tree->Branch("xAcc", &xAcc);
-    tree->Branch("yAcc", &yAcc);
-    tree->Branch("zAcc", &zAcc);
-
-    time = 0;
-    xPos = pos.X();
-    yPos = pos.Y();
-    zPos = pos.Z();
-    xVel = vel.X();
-    yVel = vel.Y();
-    zVel = vel.Z();
-
-    BorisSolver solver(field, -TMath::Qe(), ME, tau);
-    TVector3 acc{solver.acc(pos, vel)};
-    xAcc = acc.X();
-    yAcc = acc.Y();
-    zAcc = acc.Z();
-    tree->Fill();
 
     // Calculate next scattering time
-    ElasticScatter scatEl(eKE);
-    double elXSec{scatEl.GetTotalXSec()};
-    InelasticScatter scatInel(eKE);
-    double inelXSec{scatInel.GetTotalXSec()};
-    double totalXSec{elXSec + inelXSec};
-    // Calculate the mean free path
-    const double lambdaStep{1 / (tritiumDensity * totalXSec)};
-    std::exponential_distribution<double> pathDistStep(1 / lambdaStep);
-    const double pathLenStep{pathDistStep(gen)};
-    const double pathTimeStep{pathLenStep / vel.Mag()};
-    double nextScatterTime{pathTimeStep};
-    std::cout << "Scattering after " << pathTimeStep * 1e6 << " us\n";
-
-    // Now propagate the electron
-    unsigned long nSteps{1};
-    while (abs(pos.Z()) < zLimit / 2) {
-      // Step forward
-      time = double(nSteps) * simStepTime;
-      if (std::fmod(time, 5e-6) < simStepTime) {
-        cout << "Simulated " << time * 1e6 << " us\n";
+    double nextScatterTime{nextScatterInterval(vel, eKE)};
+    std::cout << "Scattering after " << nextScatterTime * 1e6 << " us\n";
+
+    if (gcStepTime > 0) {
+      // Propagate the guiding centre and write out the reconstructed orbit
+      GuidingCentreSolver gcSolver(field, -TMath::Qe(), ME, tau);
+      gcSolver.SetParticleState(pos, vel, 0);
+      gcSolver.OpenTrajectory(outputFile, simStepTime, outputStride);
+      while (abs(gcSolver.GetCentre().Z()) < zLimit / 2) {
+        // Land exactly on the next scatter
+        const double step{
+            std::min(gcStepTime, nextScatterTime - gcSolver.GetTime())};
+        gcSolver.AdvanceStep(step);
+        time = gcSolver.GetTime();
+        if (std::fmod(time, 5e-6) < step) {
+          cout << "Simulated " << time * 1e6 << " us\n";
+        }
+
+        if (time >= nextScatterTime) {
+          auto [scatPos, scatVel, scatAcc] = gcSolver.GetParticleState(time);
+          vel = scatVel;
+          scatterElectron(vel, eKE);
+          gcSolver.SetParticleState(scatPos, vel, time);
+
+          nextScatterTime += nextScatterInterval(vel, eKE);
+          std::cout << "Next scatter at " << nextScatterTime * 1e6
+                    << " us\n";
+        }
       }
 
-      auto outputStep = solver.advance_step(simStepTime, pos, vel);
-      pos = std::get<0>(outputStep);
+      cout << "Escaped after " << time * 1e6 << " us\n";
+      gcSolver.CloseTrajectory();
+    } else {
+      // Generate a file and tree
+      TFile fout(outputFile, "recreate");
+      auto tree = new TTree("tree", "tree");
+      double xPos{}, yPos{}, zPos{};
+      double xVel{}, yVel{}, zVel{};
+      double xAcc{}, yAcc{}, zAcc{};
+      tree->Branch("time", &time);
+      tree->Branch("xPos", &xPos);
+      tree->Branch("yPos", &yPos);
+      tree->Branch("zPos", &zPos);
+      tree->Branch("xVel", &xVel);
+      tree->Branch("yVel", &yVel);
+      tree->Branch("zVel", &zVel);
+      tree->Branch("xAcc", &xAcc);
+      tree->Branch("yAcc", &yAcc);
+      tree->Branch("zAcc", &zAcc);
+
+      time = 0;
+      xPos = pos.X();
+      yPos = pos.Y();
+      zPos = pos.Z();
+      xVel = vel.X();
+      yVel = vel.Y();
+      zVel = vel.Z();
+
+      BorisSolver solver(field, -TMath::Qe(), ME, tau);
+      TVector3 acc{solver.acc(pos, vel)};
+      xAcc = acc.X();
+      yAcc = acc.Y();
+      zAcc = acc.Z();
+      tree->Fill();
+
+      // Now propagate the electron
+      unsigned long nSteps{1};
+      while (abs(pos.Z()) < zLimit / 2) {
+        // Step forward
+        time = double(nSteps) * simStepTime;
+        if (std::fmod(time, 5e-6) < simStepTime) {
+          cout << "Simulated " << time * 1e6 << " us\n";
+        }
 
-      if (time < nextScatterTime) {
-        vel = std::get<1>(outputStep);
-        acc = solver.acc(pos, vel);
-        // Update position and velocity vectors and write to tree
-        xPos = pos.X();
-        yPos = pos.Y();
-        zPos = pos.Z();
-        xVel = vel.X();
-        yVel = vel.Y();
-        zVel = vel.Z();
-        xAcc = acc.X();
-        yAcc = acc.Y();
-        zAcc = acc.Z();
-        tree->Fill();
-      } else {
-        // Time to do a scattering calculation
-        double gamma{1 / sqrt(1 - pow(vel.Mag() / TMath::C(), 2))};
-        eKE = (gamma - 1) * ME_EV;
-
-        // Recalculate the cross sections based on the cross-sections
-        ElasticScatter scatEl2(eKE);
-        InelasticScatter scatInel2(eKE);
-        elXSec = scatEl2.GetTotalXSec();
-        inelXSec = scatInel2.GetTotalXSec();
-        totalXSec = elXSec + inelXSec;
-
-        // Figure out if this an elastic or inelastic scatter
-        double scatAngle{0};
-        if (uni1(gen) < elXSec / totalXSec) {
-          // We have an elastic scatter
-          cout << "Elastic scatter\n";
-          // No energy loss so just get the scattering angle
-          scatAngle = scatEl2.GetRandomScatteringAngle();
-          vel = scatEl2.GetScatteredVector(vel, eKE, scatAngle);
+        auto outputStep = solver.advance_step(simStepTime, pos, vel);
+        pos = std::get<0>(outputStep);
+
+        if (time < nextScatterTime) {
+          vel = std::get<1>(outputStep);
         } else {
-          // We have an inelastic scatter
-          cout << "Inelastic scatter\n";
-          // Get the energy of the secondary
-          double wSample{scatInel2.GetRandomW()};
-          double theta2Sample{scatInel2.GetRandomTheta(wSample)};
-
-          // Now calculate the energy and the scattering angle of the primary
-          scatAngle = scatInel2.GetPrimaryScatteredAngle(wSample, theta2Sample);
-          eKE = scatInel2.GetPrimaryScatteredE(wSample, theta2Sample);
-          vel = scatInel2.GetScatteredVector(vel, eKE, scatAngle);
+          // Time to do a scattering calculation
+          scatterElectron(vel, eKE);
+
+          // Get the next scatter time
+          nextScatterTime += nextScatterInterval(vel, eKE);
+          std::cout << "Next scatter at " << nextScatterTime * 1e6
+                    << " us\n";
         }
-        cout << "Scattering angle = " << scatAngle * 180 / TMath::Pi()
-             << " degrees\t New KE = " << eKE / 1e3 << " keV\n";
 
-        // Now calculate the new acceleration
+        // Update position and velocity vectors and write to tree
         acc = solver.acc(pos, vel);
-
         xPos = pos.X();
         yPos = pos.Y();
         zPos = pos.Z();
@@ -227,31 +278,17 @@ int main(int argc, char *argv[]) {
         zAcc = acc.Z();
         tree->Fill();
 
-        // Get the next scatter time
-        ElasticScatter scatElNext(eKE);
-        double elXSecNext{scatElNext.GetTotalXSec()};
-        InelasticScatter scatInelNext(eKE);
-        double inelXSecNext{scatInelNext.GetTotalXSec()};
-        double totalXSecNext{elXSecNext + inelXSecNext};
-        double lambdaStepNext{1 / (tritiumDensity * totalXSecNext)};
-        std::exponential_distribution<double> pathDistStepNext(1 /
-                                                               lambdaStepNext);
-        const double pathLenStepNext{pathDistStepNext(gen)};
-        const double pathTimeStepNext{pathLenStepNext / vel.Mag()};
-        nextScatterTime += pathTimeStepNext;
-        std::cout << "Next scatter at " << nextScatterTime * 1e6 << " us\n";
+        nSteps++;
       }
 
-      nSteps++;
-    }
-
-    // We have now completed the motion
-    cout << "Escaped after " << time * 1e6 << " us\n";
+      // We have now completed the motion
+      cout << "Escaped after " << time * 1e6 << " us\n";
 
-    fout.cd();
-    tree->Write("", TObject::kOverwrite);
-    delete tree;
-    fout.Close();
+      fout.cd();
+      tree->Write("", TObject::kOverwrite);
+      delete tree;
+      fout.Close();
+    }
 
     // We actually only want those electrons which have travelled for more than
     // 1ms
@@ -31,9 +31,10 @@ int main(int argc, char *argv[]) {
   int opt;
 
   std::string outputDir{" "};
-  double bField{1.0};  // Tesla
+  double bField{1.0};        // Tesla
+  unsigned int nThreads{1};  // For the signal calculation
 
-  while ((opt = getopt(argc, argv, ":d:b:")) != -1) {
+  while ((opt = getopt(argc, argv, ":d:b:t:")) != -1) {
     switch (opt) {
       case 'd':
         outputDir = optarg;
@@ -41,6 +42,9 @@ int main(int argc, char *argv[]) {
       case 'b':
         bField = atof(optarg);
         break;
+      case 't':
+        nThreads = atoi(optarg);
+        break;
       case ':':
         std::cout << "Option needs a value" << std::endl;
         break;
@@ -170,7 +174,8 @@ int main(int argc, char *argv[]) {
   const double noiseTemp{4.0};  // Kelvin
   GaussianNoise noiseFunc(noiseTemp, loadResistance);
 
-  Signal sig(trackFile, antennaArray, lo, sampleRate, {noiseFunc});
+  Signal sig(trackFile, antennaArray, lo, sampleRate, {noiseFunc}, -1,
+             nThreads);
   std::cout << "Created the signal with noise" << std::endl;
   TGraph *grVSig = sig.GetVITimeDomain();
   TGraph *grVSigPgram = sig.GetVIPowerPeriodogram(loadResistance);
@@ -180,7 +185,8 @@ int main(int argc, char *argv[]) {
   delete grVSig;
   delete grVSigPgram;
 
-  Signal sigNoNoise(trackFile, antennaArray, lo, sampleRate, {});
+  Signal sigNoNoise(trackFile, antennaArray, lo, sampleRate, {}, -1,
+                    nThreads);
   std::cout << "Created the signal with no noise" << std::endl;
   TGraph *grVSigNoNoise = sigNoNoise.GetVITimeDomain();
   TGraph *grVSigNoNoisePgram = sigNoNoise.GetVIPowerPeriodogram(loadResistance);
@@ -9,6 +9,7 @@
 #include <math.h>
 
 #include <iostream>
+#include <vector>
 
 #include "BasicFunctions/BasicFunctions.h"
 #include "BasicFunctions/Constants.h"
@@ -64,10 +65,18 @@ int main(int argc, char *argv[]) {
     setGraphAttr(grB);
     grB->GetXaxis()->SetTitle("z [m]");
     grB->GetYaxis()->SetTitle("|B| [T]");
-    for (int n{0}; n < 402; n++) {
-      double z{-0.55 + 1.1 * double(n) / double(401)};
-      double bMag{field1m->evaluate_field_magnitude(TVector3(0, 0, z))};
-      grB->SetPoint(n, z, bMag);
+    const size_t nFieldPnts{402};
+    std::vector<double> xAxis(nFieldPnts, 0.0);
+    std::vector<double> zAxis(nFieldPnts);
+    std::vector<double> bx(nFieldPnts), by(nFieldPnts), bz(nFieldPnts);
+    for (size_t n{0}; n < nFieldPnts; n++) {
+      zAxis[n] = -0.55 + 1.1 * double(n) / double(nFieldPnts - 1);
+    }
+    field1m->evaluate_field_batch(xAxis.data(), xAxis.data(), zAxis.data(),
+                                  bx.data(), by.data(), bz.data(), nFieldPnts);
+    for (size_t n{0}; n < nFieldPnts; n++) {
+      double bMag{sqrt(bx[n] * bx[n] + by[n] * by[n] + bz[n] * bz[n])};
+      grB->SetPoint(n, zAxis[n], bMag);
     }
     fout->cd();
     grB->Write("grB");
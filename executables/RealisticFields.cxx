@@ -108,6 +108,9 @@ int main(int argc, char *argv[]) {
   double scaleFactor{desiredField / 0.94};
   ComsolHarmonicField *harm =
       new ComsolHarmonicField(coilRadius, coilCurrent, filePath, scaleFactor);
+  // Use a grid at the native 1 mm map spacing to avoid Delaunay lookups. A
+  // binary map already on that grid is used without resampling
+  harm->UseRegularGrid(1e-3, 1e-3);
 
   const clock_t begin_time = clock();
 
@@ -66,7 +66,7 @@ int main() {
     const double simTime{1e-6};
     TString trackFile{outputDir + Form("/track%d.root", iZ)};
     ElectronTrajectoryGen traj(trackFile, trap, initPos, initVel, stepSize,
-                               simTime);
+                               simTime, 0, 0, true);
 
     // Now get the radial position as a function of time
     auto fin = std::make_unique<TFile>(trackFile, "read");
@@ -165,7 +165,7 @@ int main() {
 
   TString trackFile88{outputDir + "/trackFile88.root"};
   ElectronTrajectoryGen traj88(trackFile88, trap2, startPos88, startVel88,
-                               1e-12, 1e-6);
+                               1e-12, 1e-6, 0, 0, true);
   // Open the input file and make various graphs
   auto fin88 = std::make_unique<TFile>(trackFile88, "read");
   auto tr88 = (TTree*)fin88->Get("tree");
@@ -222,7 +222,7 @@ int main() {
 
   TString trackFile90{outputDir + "/trackFile90.root"};
   ElectronTrajectoryGen traj90(trackFile90, trap2, startPos90, startVel90,
-                               1e-12, 1e-6);
+                               1e-12, 1e-6, 0, 0, true);
   // Open the input file and make various graphs
   auto fin90 = std::make_unique<TFile>(trackFile90, "read");
   auto tr90 = (TTree*)fin90->Get("tree");
@@ -331,11 +331,11 @@ int main(int argc, char* argv[]) {
     tree->Fill();
 
     for (int iStep = 0; iStep < nTimeSteps; iStep++) {
-      std::tuple<TVector3, TVector3> outputStep =
-          solver.advance_step(timeStepSize, posVec, velVec);
+      std::tuple<TVector3, TVector3, TVector3> outputStep =
+          solver.advance_step_with_acc(timeStepSize, posVec, velVec);
       posVec = std::get<0>(outputStep);
       velVec = std::get<1>(outputStep);
-      eAcc = solver.acc(posVec, velVec);
+      eAcc = std::get<2>(outputStep);
 
       time = double(iStep + 1) * timeStepSize;
       if (std::fmod(time, 5e-6) < timeStepSize)
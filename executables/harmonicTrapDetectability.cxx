@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "Antennas/HalfWaveDipole.h"
 #include "Antennas/IAntenna.h"
@@ -33,8 +34,9 @@ int main(int argc, char* argv[]) {
   double pitchAngle = 90.0;
   double radialOffset = 0.0;
   int nDipoles = 33;
+  unsigned int nThreads = 1;
 
-  while ((opt = getopt(argc, argv, ":d:p:r:n:")) != -1) {
+  while ((opt = getopt(argc, argv, ":d:p:r:n:t:")) != -1) {
     switch (opt) {
       case 'd':
         outputDir = optarg;
@@ -48,6 +50,9 @@ int main(int argc, char* argv[]) {
       case 'n':
         nDipoles = atoi(optarg);
         break;
+      case 't':
+        nThreads = atoi(optarg);
+        break;
       case ':':
         std::cout << "Option needs a value" << std::endl;
         break;
@@ -90,10 +95,18 @@ int main(int argc, char* argv[]) {
   TGraph* grBMag = new TGraph();
   setGraphAttr(grBMag);
   grBMag->SetTitle("Harmonic trap; z [m]; |B| [T]");
-  for (int i = 0; i < 321; i++) {
-    double thisZ = -0.1 + 0.2 * double(i) / double(321);
-    TVector3 BField = field->evaluate_field_at_point(TVector3(0, 0, thisZ));
-    grBMag->SetPoint(grBMag->GetN(), thisZ, BField.Mag());
+  const size_t nFieldPnts = 321;
+  std::vector<double> xAxis(nFieldPnts, 0.0);
+  std::vector<double> zAxis(nFieldPnts);
+  std::vector<double> bx(nFieldPnts), by(nFieldPnts), bz(nFieldPnts);
+  for (size_t i = 0; i < nFieldPnts; i++) {
+    zAxis[i] = -0.1 + 0.2 * double(i) / double(nFieldPnts);
+  }
+  field->evaluate_field_batch(xAxis.data(), xAxis.data(), zAxis.data(),
+                              bx.data(), by.data(), bz.data(), nFieldPnts);
+  for (size_t i = 0; i < nFieldPnts; i++) {
+    TVector3 BField(bx[i], by[i], bz[i]);
+    grBMag->SetPoint(grBMag->GetN(), zAxis[i], BField.Mag());
   }
   fout->cd();
   grBMag->Write("grBMag");
@@ -171,8 +184,10 @@ int main(int argc, char* argv[]) {
   GaussianNoise noise1(noiseTemp, loadResistance);
 
   InducedVoltage iv(trackFilePath, antennaArray, true);
-  Signal sig(trackFilePath, antennaArray, lo, sampleRate, {noise1});
-  Signal sigNoNoise(trackFilePath, antennaArray, lo, sampleRate, {});
+  Signal sig(trackFilePath, antennaArray, lo, sampleRate, {noise1}, -1,
+             nThreads);
+  Signal sigNoNoise(trackFilePath, antennaArray, lo, sampleRate, {}, -1,
+                    nThreads);
 
   TGraph* grVSig = sig.GetVITimeDomain();
   TGraph* grVSigPgram = sig.GetVIPowerPeriodogram(loadResistance);
@@ -1,5 +1,7 @@
 // singleBinPower.cxx
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "Antennas/HalfWaveDipole.h"
@@ -8,6 +10,7 @@
 #include "SignalProcessing/LocalOscillator.h"
 #include "SignalProcessing/NoiseFunc.h"
 #include "SignalProcessing/Signal.h"
+#include "SignalProcessing/SingleBinTracker.h"
 #include "TAxis.h"
 #include "TFile.h"
 #include "TGraph.h"
@@ -37,7 +40,8 @@ int main(int argc, char** argv) {
       new HalfWaveDipole(antennaPoint1, antennaDirX1, antennaDirZ1, 27.01e9);
   antenna1->SetBandwidth(antennaLowerBandwidth, antennaUpperBandwidth);
 
-  LocalOscillator myLO(26.75e9 * 2 * TMath::Pi());
+  const double loFreq{26.75e9};
+  LocalOscillator myLO(loFreq * 2 * TMath::Pi());
   const double loadResistance = 70.0;
   const double sampleRate = 750e6;  // Hz
   const double noiseTemp = 4.0;
@@ -45,20 +49,48 @@ int main(int argc, char** argv) {
   std::vector<GaussianNoise> noiseTerms;
   noiseTerms.push_back(noise1);
 
-  Signal signal(trackFile, antenna1, myLO, sampleRate, noiseTerms);
-  Signal signalNoNoise(trackFile, antenna1, myLO, sampleRate, {});
+  // Track the periodogram bins of each acquisition either side of the
+  // downmixed antenna centre frequency
+  const size_t blockLength = size_t(std::round(acquisitionTime * sampleRate));
+  const double binWidth = sampleRate / double(blockLength);
+  const double centreBin = std::round((27.01e9 - loFreq) / binWidth);
+  const int nSideBins = 10;
+  std::vector<double> trackedFreqs;
+  for (int i = -nSideBins; i <= nSideBins; i++) {
+    trackedFreqs.push_back((centreBin + double(i)) * binWidth);
+  }
+
+  // The voltages are only passed to the trackers, not stored
+  SingleBinTracker tracker(sampleRate, trackedFreqs, blockLength);
+  SingleBinTracker trackerNoNoise(sampleRate, trackedFreqs, blockLength);
+  Signal signal(trackFile, antenna1, myLO, sampleRate, noiseTerms, -1,
+                {&tracker});
+  Signal signalNoNoise(trackFile, antenna1, myLO, sampleRate, {}, -1,
+                       {&trackerNoNoise});
 
   TFile* fout = new TFile(outputFile, "RECREATE");
   fout->cd();
 
-  TGraph* grVIPeriodogram = signal.GetVIPowerPeriodogram(loadResistance);
-  TGraph* grVIPeriodogramNoNoise =
-      signalNoNoise.GetVIPowerPeriodogram(loadResistance);
-  std::cout << "Power integral " << SumPower(grVIPeriodogram) << std::endl;
-  std::cout << "Power integral no noise " << SumPower(grVIPeriodogramNoNoise)
+  double powerSum = 0;
+  double powerSumNoNoise = 0;
+  for (size_t i = 0; i < tracker.GetNFrequencies(); i++) {
+    for (double p : tracker.GetPower(i)) powerSum += p / loadResistance;
+    for (double p : trackerNoNoise.GetPower(i)) {
+      powerSumNoNoise += p / loadResistance;
+    }
+
+    TGraph* grPower = tracker.GetPowerGraph(i, loadResistance);
+    TGraph* grPowerNoNoise = trackerNoNoise.GetPowerGraph(i, loadResistance);
+    grPower->Write(Form("grPower%zu", i));
+    grPowerNoNoise->Write(Form("grPowerNoNoise%zu", i));
+    delete grPower;
+    delete grPowerNoNoise;
+  }
+  const double nBlocks = double(std::max<size_t>(tracker.GetNBlocks(), 1));
+  std::cout << "Mean power in tracked bins " << powerSum / nBlocks
             << std::endl;
-  grVIPeriodogram->Write("grVIPeriodogram");
-  grVIPeriodogramNoNoise->Write("grVIPeriodogramNoNoise");
+  std::cout << "Mean power in tracked bins no noise "
+            << powerSumNoNoise / nBlocks << std::endl;
 
   fout->Close();
   delete fout;
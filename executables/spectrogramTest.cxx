@@ -4,7 +4,7 @@
 #include "TGraph.h"
 
 #include "FieldClasses/FieldClasses.h"
-#include "SignalProcessing/Spectrogram.h"
+#include "BasicFunctions/Spectrogram.h"
 #include "SignalProcessing/NoiseFunc.h"
 #include "Antennas/HertzianDipole.h"
 
@@ -27,9 +27,12 @@ int main() {
 
   std::vector<GaussianNoise*> noiseTerms;
   noiseTerms.push_back(noise1);
-  Spectrogram spec(fp);
+  TGraph* grVoltage = fp->GetAntennaLoadVoltageTimeDomain();
+  Spectrogram spec(259072, 259072);
   std::cout<<"Created spectrogram class"<<std::endl;
-  TH2D* h2spec = spec.MakeSpectrogram(259072, false);
+  spec.Compute(TimeSeries::FromTGraph(grVoltage));
+  TH2D* h2spec = spec.ToTH2D();
+  delete grVoltage;
   std::cout<<"Created spectrogram"<<std::endl;
 
   fout->cd();
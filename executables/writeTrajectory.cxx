@@ -6,6 +6,7 @@
 
 #include "ElectronDynamics/BorisSolver.h"
 #include "ElectronDynamics/QTNMFields.h"
+#include "ElectronDynamics/TrajectoryGen.h"
 #include "BasicFunctions/Constants.h"
 
 #include <unistd.h>
@@ -16,6 +17,7 @@
 #include <ctime>
 
 #include "TFile.h"
+#include "TParameter.h"
 #include "TTree.h"
 #include "TMath.h"
 
@@ -34,8 +36,10 @@ int main(int argc, char *argv[])
   bool hasInputFile = false;
   double trapLength = 0.3;
   double Rcoil = 0.03;
+  unsigned int stepsPerOrbit = 0; // Fixed steps unless set
+  unsigned int outputStride = 1; // Write every step unless set
   
-  while((opt = getopt(argc, argv, ":o:t:s:i:p:l:r:e")) != -1) {
+  while((opt = getopt(argc, argv, ":o:t:s:i:p:l:r:a:d:e")) != -1) {
     switch(opt) {
     case 'o':
       outputFile = optarg;
@@ -68,6 +72,14 @@ int main(int argc, char *argv[])
     case 'r':
       Rcoil = atof(optarg);
       break;
+    case 'a':
+      stepsPerOrbit = atoi(optarg);
+      std::cout<<"Adaptive steps with "<<stepsPerOrbit<<" steps per orbit"<<std::endl;
+      break;
+    case 'd':
+      outputStride = atoi(optarg);
+      std::cout<<"Writing every "<<outputStride<<" steps"<<std::endl;
+      break;
     case ':':
       std::cout<<"Option needs a value"<<std::endl;
       break;
@@ -128,11 +140,20 @@ int main(int argc, char *argv[])
     intree->SetBranchAddress("yVel", &startYVel);
     intree->SetBranchAddress("zVel", &startZVel);
 
-    intree->GetEntry(0);
-    double time0 = simStartTime;
-    intree->GetEntry(1);
-    double time1 = simStartTime;
-    simStepSize = time1 - time0;
+    // Decimated files record the step they were simulated with. Otherwise
+    // every step was written
+    TParameter<double>* stepParam = fin->Get<TParameter<double>>("simStepSize");
+    if (stepParam && stepParam->GetVal() > 0) {
+      simStepSize = stepParam->GetVal();
+    }
+    else {
+      intree->GetEntry(0);
+      double time0 = simStartTime;
+      intree->GetEntry(1);
+      double time1 = simStartTime;
+      simStepSize = time1 - time0;
+    }
+    std::cout<<"Continuing with a step size of "<<simStepSize<<std::endl;
 
     intree->GetEntry(intree->GetEntries()-1);
     X0.SetX(startX);
@@ -154,6 +175,19 @@ int main(int argc, char *argv[])
   TVector3 maxVec(0, 0, zc1);
   std::cout<<"Max field perturbation = "<<(bathtub->evaluate_field_at_point(maxVec) - B0).Mag()<<std::endl;
 
+  // Adaptive steps, with the output written every simStepSize, or decimated
+  // output. Both are handled by the trajectory generator
+  if (stepsPerOrbit > 0 || outputStride > 1) {
+    const bool adaptive = stepsPerOrbit > 0;
+    ElectronTrajectoryGen traj(outputFile, bathtub, X0, vInitial, simStepSize,
+                               simTime, simStartTime, tau, adaptive,
+                               adaptive ? stepsPerOrbit : 40, 1e-8,
+                               outputStride, !hasInputFile);
+    const clock_t end_time = clock();
+    std::cout<<"Execution time is "<<float(end_time - begin_time)/CLOCKS_PER_SEC<<" seconds"<<std::endl;
+    return 0;
+  }
+
   // Set up the Boris solver
   BorisSolver solver(bathtub, -TMath::Qe(), ME, tau);
 
@@ -200,10 +234,10 @@ int main(int argc, char *argv[])
   // Loop through the remaining steps and advance the dynamics
   for (int i = 1; i < nTimeSteps; i++) {
     time = simStartTime + double(i) * simStepSize;
-    std::tuple<TVector3, TVector3> outputStep = solver.advance_step(simStepSize, posVec, velVec);
+    std::tuple<TVector3, TVector3, TVector3> outputStep = solver.advance_step_with_acc(simStepSize, posVec, velVec);
     posVec = std::get<0>(outputStep);
     velVec = std::get<1>(outputStep);
-    eAcc = solver.acc(posVec, velVec);
+    eAcc = std::get<2>(outputStep);
     
     xPos = posVec.X();
     yPos = posVec.Y();